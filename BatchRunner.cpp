@@ -0,0 +1,407 @@
+#include "BatchRunner.hpp"
+#include "Deck.hpp"
+#include "InterleavedGames.hpp"
+#include "MyGameMapper.hpp"
+#include "ProgressJournal.hpp"
+#include "ResultStats.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace sevens {
+
+BatchRunner::BatchRunner(std::vector<StrategyFactory> factories,
+                         std::vector<std::string> names,
+                         BatchConfig config)
+    : factories(std::move(factories)), names(std::move(names)), config(config)
+{
+    if (this->factories.empty()) {
+        throw std::invalid_argument("BatchRunner needs at least one strategy");
+    }
+    if (this->names.size() != this->factories.size()) {
+        throw std::invalid_argument("BatchRunner needs exactly one name per strategy");
+    }
+}
+
+void BatchRunner::setDealCallback(DealCallback callback) {
+    onDeal = std::move(callback);
+}
+
+uint64_t BatchRunner::dealSeed(uint64_t seed, uint64_t deal) {
+    // splitmix64, so that neighbouring deal indices get unrelated decks
+    uint64_t z = seed + (deal + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+DealTally::DealTally(uint64_t deal, size_t numStrategies, bool duplicate, StatsShard* stats)
+    : seats(numStrategies), duplicate(duplicate), stats(stats)
+{
+    result.deal = deal;
+    result.meanRank.assign(numStrategies, 0.0);
+    result.relativeScore.assign(numStrategies, 0.0);
+    std::iota(seats.begin(), seats.end(), 0);
+    if (!duplicate && numStrategies > 0) {
+        std::rotate(seats.begin(), seats.begin() + deal % numStrategies, seats.end());
+    }
+}
+
+bool DealTally::addGame(const GameRecord& game) {
+    const size_t n = seats.size();
+    std::vector<uint64_t> rankOf(n, 0);
+    for (size_t seat = 0; seat < n; ++seat) {
+        rankOf[seats[seat]] = game.rank[seat];
+        result.meanRank[seats[seat]] += static_cast<double>(game.rank[seat]);
+    }
+    if (n > 1) {
+        headToHead += rankOf[0] < rankOf[1] ? 1.0 : (rankOf[0] == rankOf[1] ? 0.5 : 0.0);
+    }
+    if (stats) {
+        GameRecord record = game;
+        std::copy(seats.begin(), seats.end(), record.strategy.begin());
+        stats->recordGame(record);
+    }
+    ++result.games;
+    return duplicate && std::next_permutation(seats.begin(), seats.end());
+}
+
+DealResult DealTally::finish() {
+    const size_t n = seats.size();
+    double dealAverage = 0.0;
+    for (double& rank : result.meanRank) {
+        rank /= static_cast<double>(result.games);
+        dealAverage += rank;
+    }
+    dealAverage /= static_cast<double>(n);
+
+    for (size_t s = 0; s < n; ++s) {
+        result.relativeScore[s] = result.meanRank[s] - dealAverage;
+    }
+    if (n > 1) {
+        result.headToHead = headToHead / static_cast<double>(result.games);
+    }
+    if (stats) {
+        stats->recordDeal(result);
+    }
+    return std::move(result);
+}
+
+DealResult BatchRunner::playDeal(uint64_t deal, uint64_t seed, bool duplicate,
+                                 const std::vector<std::shared_ptr<PlayerStrategy>>& players,
+                                 StatsShard* stats)
+{
+    TraceSpan span("deal", "deal", "deal", deal);
+    const size_t n = players.size();
+    DealTally tally(deal, n, duplicate, stats);
+    const Deck deck = Deck::shuffled(dealSeed(seed, deal));
+    for (const auto& player : players) {
+        if (auto* listener = dynamic_cast<DealListener*>(player.get())) listener->beginDeal(deal);
+    }
+
+    bool another = true;
+    while (another) {
+        MyGameMapper game;
+        game.set_deck(deck);
+        game.read_cards("");
+        game.read_game("");
+        for (size_t seat = 0; seat < n; ++seat) {
+            game.registerStrategy(seat, players[tally.seating()[seat]]);
+        }
+        game.compute_game_progress(n);
+        another = tally.addGame(game.last_game());
+    }
+
+    return tally.finish();
+}
+
+BatchSummary BatchRunner::run() {
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config.numDeals < numThreads) {
+        numThreads = static_cast<unsigned>(std::max<uint64_t>(1, config.numDeals));
+    }
+    if (!config.journalPath.empty()) {
+        return runJournaled(numThreads);
+    }
+    if (config.gamesInFlight > 1) {
+        return runInterleaved(numThreads);
+    }
+
+    // Every deal owns its slot, so workers never write to the same element
+    std::vector<DealResult> results(config.numDeals);
+    std::atomic<uint64_t> nextDeal{0};
+    std::atomic<bool> stopRequested{false};
+    std::mutex callbackMutex;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            std::vector<std::shared_ptr<PlayerStrategy>> players;
+            for (const auto& factory : factories) {
+                players.push_back(factory());
+            }
+            StatsShard* shard = config.stats ? &config.stats->claimShard() : nullptr;
+
+            while (!stopRequested.load(std::memory_order_relaxed)) {
+                uint64_t deal = nextDeal.fetch_add(1);
+                if (deal >= config.numDeals) break;
+                results[deal] = playDeal(config.firstDeal + deal, config.seed, config.duplicate, players, shard);
+
+                if (onDeal) {
+                    TraceSpan merge("onDeal", "merge", "deal", config.firstDeal + deal);
+                    std::lock_guard<std::mutex> lock(callbackMutex);
+                    if (!stopRequested.load() && !onDeal(results[deal])) {
+                        stopRequested.store(true);
+                    }
+                }
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            stopRequested.store(true);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return summarize(results, names);
+}
+
+BatchSummary BatchRunner::runJournaled(unsigned numThreads) {
+    const uint64_t chunkDeals = std::max<uint64_t>(1, config.chunkDeals);
+    const uint64_t numChunks = (config.numDeals + chunkDeals - 1) / chunkDeals;
+    ProgressJournal journal(config.journalPath,
+                            ProgressJournal::batchIdentity(names, config.seed, config.numDeals, chunkDeals, config.duplicate),
+                            names.size());
+
+    // Chunks an earlier run finished count towards the summary and the statistics
+    std::vector<uint64_t> pending;
+    for (uint64_t chunk = 0; chunk < numChunks; ++chunk) {
+        const uint64_t first = config.firstDeal + chunk * chunkDeals;
+        const uint64_t end = config.firstDeal + std::min(config.numDeals, (chunk + 1) * chunkDeals);
+        if (!journal.isComplete(first, end)) pending.push_back(chunk);
+    }
+    DealTotals totals = journal.completedDeals();
+    if (config.stats) {
+        config.stats->absorb(journal.completedStatistics());
+    }
+    if (pending.size() < numThreads) {
+        numThreads = static_cast<unsigned>(std::max<size_t>(1, pending.size()));
+    }
+
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<bool> stopRequested{false};
+    std::mutex callbackMutex;
+    std::mutex journalMutex;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            std::vector<std::shared_ptr<PlayerStrategy>> players;
+            for (const auto& factory : factories) {
+                players.push_back(factory());
+            }
+
+            while (!stopRequested.load(std::memory_order_relaxed)) {
+                const size_t next = nextChunk.fetch_add(1);
+                if (next >= pending.size()) break;
+                const uint64_t first = config.firstDeal + pending[next] * chunkDeals;
+                const uint64_t end = config.firstDeal + std::min(config.numDeals, (pending[next] + 1) * chunkDeals);
+
+                // Chunk-local statistics go into the journal record, then into config.stats
+                StatsShard chunkStats(names.size());
+                DealTotals chunkTotals(names.size());
+                bool finished = true;
+                for (uint64_t deal = first; deal < end; ++deal) {
+                    if (stopRequested.load(std::memory_order_relaxed)) {
+                        finished = false;
+                        break;
+                    }
+                    DealResult result = playDeal(deal, config.seed, config.duplicate, players, &chunkStats);
+                    chunkTotals.add(result);
+
+                    if (onDeal) {
+                        TraceSpan merge("onDeal", "merge", "deal", deal);
+                        std::lock_guard<std::mutex> lock(callbackMutex);
+                        if (!stopRequested.load() && !onDeal(result)) {
+                            stopRequested.store(true);
+                        }
+                    }
+                }
+
+                // A chunk cut short by a stop is not recorded, so a resumed run replays it whole
+                TraceSpan merge("mergeChunk", "merge", "first", first);
+                const ResultTotals chunkStatistics = chunkStats.read();
+                std::lock_guard<std::mutex> lock(journalMutex);
+                if (finished) {
+                    journal.append(first, end, chunkTotals, chunkStatistics);
+                }
+                totals.merge(chunkTotals);
+                if (config.stats) {
+                    config.stats->absorb(chunkStatistics);
+                }
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            stopRequested.store(true);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return summarize(totals, names);
+}
+
+BatchSummary BatchRunner::runInterleaved(unsigned numThreads) {
+    std::vector<DealResult> results(config.numDeals);
+    std::atomic<uint64_t> nextDeal{0};
+    std::atomic<bool> stopRequested{false};
+    std::mutex callbackMutex;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            StatsShard* shard = config.stats ? &config.stats->claimShard() : nullptr;
+            InterleavedGames games(factories, config.gamesInFlight, config.seed, config.duplicate, shard);
+            std::vector<DealResult> finished;
+            bool moreDeals = true;
+            while (true) {
+                // Keep every slot busy while deals remain; a stop lets the running ones finish
+                while (moreDeals && games.hasFreeSlot() && !stopRequested.load(std::memory_order_relaxed)) {
+                    const uint64_t deal = nextDeal.fetch_add(1);
+                    if (deal >= config.numDeals) {
+                        moreDeals = false;
+                        break;
+                    }
+                    games.start(config.firstDeal + deal);
+                }
+                if (games.idle()) break;
+
+                games.step(finished);
+                for (DealResult& result : finished) {
+                    DealResult& slot = results[result.deal - config.firstDeal];
+                    slot = std::move(result);
+                    if (onDeal) {
+                        TraceSpan merge("onDeal", "merge", "deal", slot.deal);
+                        std::lock_guard<std::mutex> lock(callbackMutex);
+                        if (!stopRequested.load() && !onDeal(slot)) {
+                            stopRequested.store(true);
+                        }
+                    }
+                }
+                finished.clear();
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            stopRequested.store(true);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return summarize(results, names);
+}
+
+BatchSummary BatchRunner::summarize(const std::vector<DealResult>& allResults,
+                                    const std::vector<std::string>& names)
+{
+    // A stopped run leaves the slots of unplayed deals empty
+    std::vector<const DealResult*> results;
+    for (const auto& result : allResults) {
+        if (result.games > 0) results.push_back(&result);
+    }
+
+    const size_t n = names.size();
+    BatchSummary summary;
+    summary.names = names;
+    summary.deals = results.size();
+    summary.meanRank.assign(n, 0.0);
+    summary.meanRelativeScore.assign(n, 0.0);
+    summary.stdError.assign(n, 0.0);
+    if (results.empty()) return summary;
+
+    for (const DealResult* result : results) {
+        summary.games += result->games;
+        for (size_t s = 0; s < n; ++s) {
+            summary.meanRank[s] += result->meanRank[s];
+            summary.meanRelativeScore[s] += result->relativeScore[s];
+        }
+    }
+    const double deals = static_cast<double>(results.size());
+    for (size_t s = 0; s < n; ++s) {
+        summary.meanRank[s] /= deals;
+        summary.meanRelativeScore[s] /= deals;
+    }
+
+    if (results.size() > 1) {
+        for (size_t s = 0; s < n; ++s) {
+            double sumSquares = 0.0;
+            for (const DealResult* result : results) {
+                double d = result->relativeScore[s] - summary.meanRelativeScore[s];
+                sumSquares += d * d;
+            }
+            summary.stdError[s] = std::sqrt(sumSquares / (deals - 1.0) / deals);
+        }
+    }
+    return summary;
+}
+
+BatchSummary BatchRunner::summarize(const DealTotals& totals, const std::vector<std::string>& names) {
+    BatchSummary summary;
+    summary.names = names;
+    summary.deals = totals.deals;
+    summary.games = totals.games;
+    for (size_t s = 0; s < names.size() && s < totals.meanRank.size(); ++s) {
+        summary.meanRank.push_back(totals.meanRank[s].mean);
+        summary.meanRelativeScore.push_back(totals.relativeScore[s].mean);
+        summary.stdError.push_back(totals.deals > 1
+            ? std::sqrt(totals.relativeScore[s].variance() / static_cast<double>(totals.deals)) : 0.0);
+    }
+    return summary;
+}
+
+} // namespace sevens
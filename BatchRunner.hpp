@@ -0,0 +1,139 @@
+#pragma once
+
+#include "PlayerStrategy.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+class ResultStats;
+class StatsShard;
+struct DealTotals;
+struct GameRecord;
+
+/**
+ * Settings for a batch of headless games between a fixed set of strategies.
+ * There is one seat per strategy, and deal i always uses the deck seeded by (seed, i).
+ */
+struct BatchConfig {
+    uint64_t numDeals = 100;
+    uint64_t firstDeal = 0;    // plays deals firstDeal .. firstDeal + numDeals - 1
+    uint64_t seed = 1;
+    unsigned numThreads = 0;   // 0 = one worker per hardware thread
+    bool duplicate = true;     // replay every deal with every seat permutation
+    ResultStats* stats = nullptr;   // optional live statistics, one shard per worker
+    std::string journalPath;        // optional: record finished chunks there and skip them on resume
+    uint64_t chunkDeals = 1000;     // deals per journal record (statistics then update per chunk)
+    size_t gamesInFlight = 1;       // deals a worker plays at once; above 1, decisions are batched
+                                    // across them (InterleavedGames); not used with a journal
+    uint64_t timingSample = 64;     // built-in engine: decisions per timed decision (1 = time all)
+};
+
+/**
+ * Outcome of one deal, averaged over every seating it was played with.
+ *   meanRank[s]      average finishing rank of strategy s on this deal
+ *   relativeScore[s] meanRank[s] minus the average of all strategies on the same deal
+ *   headToHead       score of strategy 0 against strategy 1 (1 = ahead, 0.5 = tie)
+ */
+struct DealResult {
+    uint64_t deal = 0;
+    uint64_t games = 0;
+    std::vector<double> meanRank;
+    std::vector<double> relativeScore;
+    double headToHead = 0.5;
+};
+
+/**
+ * Seatings and scoring of one deal, shared by every engine that plays deals
+ * (BatchRunner::playDeal, GameEngine::playDeal, InterleavedGames) so that
+ * they score alike. In duplicate mode the deal is played under every seat
+ * permutation, otherwise once with seats rotated by the deal index.
+ */
+class DealTally {
+public:
+    DealTally(uint64_t deal, size_t numStrategies, bool duplicate, StatsShard* stats = nullptr);
+
+    // seating()[seat] = index of the strategy sitting there in the current game
+    const std::vector<size_t>& seating() const { return seats; }
+
+    // Scores a finished game by its per-seat ranks and records it (with
+    // strategy[] filled in); true if the deal has another seating to play
+    bool addGame(const GameRecord& game);
+
+    // Mean ranks, relative scores and head-to-head over the games; records the deal
+    DealResult finish();
+
+private:
+    DealResult result;
+    std::vector<size_t> seats;
+    bool duplicate;
+    StatsShard* stats;
+    double headToHead = 0.0;
+};
+
+/**
+ * Aggregate over all deals of a batch.
+ * stdError is the standard error of the per-deal relative score, which is
+ * what replaying deals in duplicate keeps small.
+ */
+struct BatchSummary {
+    std::vector<std::string> names;
+    uint64_t deals = 0;
+    uint64_t games = 0;
+    std::vector<double> meanRank;
+    std::vector<double> meanRelativeScore;
+    std::vector<double> stdError;
+};
+
+/**
+ * Plays many deals in parallel. Every worker thread builds its own strategy
+ * instances from the factories, so strategies never need to be thread-safe.
+ *
+ * In duplicate mode each deal is replayed for all seat permutations of the
+ * strategies, so the luck of the deal cancels out of the relative score.
+ * Otherwise each deal is played once, with seats rotated by the deal index.
+ */
+class BatchRunner {
+public:
+    BatchRunner(std::vector<StrategyFactory> factories,
+                std::vector<std::string> names,
+                BatchConfig config);
+
+    BatchSummary run();
+
+    /**
+     * Called once per finished deal, from the worker that played it (calls are
+     * serialized). Returning false stops the run: deals already being played
+     * finish, no new ones start, and the summary covers the finished deals.
+     */
+    using DealCallback = std::function<bool(const DealResult&)>;
+    void setDealCallback(DealCallback callback);
+
+    // Seed of the deck used for a given deal index
+    static uint64_t dealSeed(uint64_t seed, uint64_t deal);
+
+    // Plays one deal with players[s] as strategy s (in duplicate: under every seating);
+    // every game and the deal itself are recorded in stats when given
+    static DealResult playDeal(uint64_t deal, uint64_t seed, bool duplicate,
+                               const std::vector<std::shared_ptr<PlayerStrategy>>& players,
+                               StatsShard* stats = nullptr);
+
+    // Aggregates finished deals (slots of deals never played are skipped)
+    static BatchSummary summarize(const std::vector<DealResult>& results,
+                                  const std::vector<std::string>& names);
+    static BatchSummary summarize(const DealTotals& totals, const std::vector<std::string>& names);
+
+private:
+    // run() with a journal: deals are handed out in chunks, each recorded once finished
+    BatchSummary runJournaled(unsigned numThreads);
+    // run() with several deals per worker, advanced together so decisions can be batched
+    BatchSummary runInterleaved(unsigned numThreads);
+
+    std::vector<StrategyFactory> factories;
+    std::vector<std::string> names;
+    BatchConfig config;
+    DealCallback onDeal;
+};
+
+} // namespace sevens
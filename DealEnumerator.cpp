@@ -0,0 +1,348 @@
+#include "DealEnumerator.hpp"
+#include "GameEngine.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace sevens {
+
+namespace {
+
+constexpr uint64_t kMaxDeals = uint64_t{1} << 62;
+constexpr uint64_t kMaxPlayers = 4;
+
+uint64_t binomial(uint64_t n, uint64_t k) {
+    static const auto table = [] {
+        std::vector<std::vector<uint64_t>> c(65, std::vector<uint64_t>(65, 0));
+        for (size_t i = 0; i <= 64; ++i) {
+            c[i][0] = 1;
+            for (size_t j = 1; j <= i; ++j) {
+                uint64_t sum = c[i - 1][j - 1] + (j < i ? c[i - 1][j] : 0);
+                c[i][j] = sum < c[i - 1][j - 1] ? UINT64_MAX : sum;   // saturate
+            }
+        }
+        return c;
+    }();
+    return k > n ? 0 : table[n][k];
+}
+
+// Ways to deal the remaining cards given how many each seat still takes
+uint64_t multinomial(const std::vector<uint64_t>& remaining) {
+    uint64_t total = 0;
+    uint64_t ways = 1;
+    for (uint64_t count : remaining) {
+        total += count;
+        const uint64_t choose = binomial(total, count);
+        if (choose == UINT64_MAX || ways > kMaxDeals / choose) {
+            throw std::overflow_error("Too many deals to enumerate");
+        }
+        ways *= choose;
+    }
+    return ways;
+}
+
+std::vector<uint64_t> handSizes(const Variant& variant) {
+    const uint64_t cards = variant.cardsDealt();
+    std::vector<uint64_t> sizes(variant.numPlayers);
+    for (uint64_t p = 0; p < variant.numPlayers; ++p) {
+        sizes[p] = cards / variant.numPlayers + (p < cards % variant.numPlayers ? 1 : 0);
+    }
+    return sizes;
+}
+
+// owners[i] = seat receiving card i of the deal with the given lexicographic index
+std::vector<uint8_t> unrank(uint64_t index, std::vector<uint64_t> remaining) {
+    std::vector<uint8_t> owners;
+    uint64_t cards = 0;
+    for (uint64_t count : remaining) cards += count;
+    for (uint64_t i = 0; i < cards; ++i) {
+        for (size_t p = 0; p < remaining.size(); ++p) {
+            if (remaining[p] == 0) continue;
+            --remaining[p];
+            const uint64_t ways = multinomial(remaining);
+            if (index < ways) {
+                owners.push_back(static_cast<uint8_t>(p));
+                break;
+            }
+            index -= ways;
+            ++remaining[p];
+        }
+    }
+    return owners;
+}
+
+/**
+ * Number of deals in the suit-relabelling class of owners if it is the
+ * class's canonical member (suit owner sequences in non-decreasing order), 0 otherwise.
+ */
+uint64_t canonicalWeight(const std::vector<uint8_t>& owners, uint64_t numSuits, uint64_t perSuit) {
+    static const uint64_t factorial[] = {1, 1, 2, 6, 24};
+    uint64_t weight = factorial[numSuits];
+    uint64_t run = 1;
+    for (uint64_t s = 1; s < numSuits; ++s) {
+        auto previous = owners.begin() + (s - 1) * perSuit;
+        auto current = owners.begin() + s * perSuit;
+        if (std::lexicographical_compare(current, current + perSuit, previous, previous + perSuit)) {
+            return 0;
+        }
+        if (std::equal(current, current + perSuit, previous)) {
+            weight /= ++run;
+        } else {
+            run = 1;
+        }
+    }
+    return weight;
+}
+
+// Totals of one chunk; rankSum[s] adds weight * rank of strategy s over every game
+struct ChunkResult {
+    uint64_t covered = 0;
+    uint64_t played = 0;
+    uint64_t games = 0;
+    std::vector<uint64_t> rankSum;
+};
+
+template <size_t, typename T>
+using Repeat = T;
+
+template <size_t... I>
+GameEngine<Repeat<I, DynamicStrategy>...> dynamicEngineFor(std::index_sequence<I...>);
+
+// Engine seating N runtime strategies
+template <size_t N>
+using DynamicEngine = decltype(dynamicEngineFor(std::make_index_sequence<N>{}));
+
+template <size_t... I>
+void seatStrategies(DynamicEngine<sizeof...(I)>& engine,
+                    const std::vector<std::shared_ptr<PlayerStrategy>>& players,
+                    std::index_sequence<I...>)
+{
+    (engine.template strategy<I>().reset(players[I]), ...);
+}
+
+std::string progressHeader(const Variant& variant, uint64_t chunkSize, const std::vector<std::string>& names) {
+    std::ostringstream header;
+    header << "sevens-enumeration players=" << variant.numPlayers << " suits=" << variant.numSuits
+           << " side=" << variant.ranksPerSide << " chunk=" << chunkSize << " strategies=";
+    for (size_t s = 0; s < names.size(); ++s) {
+        header << (s ? "," : "") << names[s];
+    }
+    return header.str();
+}
+
+// Plays the deals of one chunk for every seat permutation
+template <size_t N>
+class ChunkPlayer {
+public:
+    ChunkPlayer(const Variant& variant, const std::vector<std::shared_ptr<PlayerStrategy>>& players)
+        : variant(variant), sizes(handSizes(variant))
+    {
+        seatStrategies(engine, players, std::make_index_sequence<N>{});
+        const int side = static_cast<int>(variant.ranksPerSide);
+        for (int suit = 0; suit < static_cast<int>(variant.numSuits); ++suit) {
+            for (int rank = 7 - side; rank <= 7 + side; ++rank) {
+                if (rank != 7) cards.push_back(Card{suit, rank});
+            }
+        }
+    }
+
+    ChunkResult play(uint64_t first, uint64_t last) {
+        ChunkResult result;
+        result.rankSum.assign(N, 0);
+        const uint64_t perSuit = 2 * variant.ranksPerSide;
+        std::vector<uint8_t> owners = unrank(first, sizes);
+
+        for (uint64_t deal = first; deal < last; ++deal) {
+            if (deal != first) std::next_permutation(owners.begin(), owners.end());
+            const uint64_t weight = canonicalWeight(owners, variant.numSuits, perSuit);
+            if (weight == 0) continue;
+
+            for (auto& hand : hands) hand.clear();
+            for (size_t i = 0; i < owners.size(); ++i) {
+                hands[owners[i]].push_back(cards[i]);
+            }
+
+            typename DynamicEngine<N>::Seating seating;
+            std::iota(seating.begin(), seating.end(), 0);
+            do {
+                auto ranks = engine.playGame(hands, seating);
+                for (size_t s = 0; s < N; ++s) {
+                    result.rankSum[s] += weight * ranks[s];
+                }
+                ++result.games;
+            } while (std::next_permutation(seating.begin(), seating.end()));
+
+            result.covered += weight;
+            ++result.played;
+        }
+        return result;
+    }
+
+private:
+    Variant variant;
+    std::vector<uint64_t> sizes;
+    std::vector<Card> cards;
+    std::array<std::vector<Card>, N> hands;
+    DynamicEngine<N> engine;
+};
+
+} // namespace
+
+DealEnumerator::DealEnumerator(std::vector<StrategyFactory> factories,
+                               std::vector<std::string> names,
+                               EnumerationConfig config)
+    : factories(std::move(factories)), names(std::move(names)), config(config)
+{
+    const Variant& v = config.variant;
+    if (v.numPlayers < 2 || v.numPlayers > kMaxPlayers) {
+        throw std::invalid_argument("Enumeration supports 2 to 4 players");
+    }
+    if (v.numSuits < 1 || v.numSuits > 4 || v.ranksPerSide < 1 || v.ranksPerSide > 6) {
+        throw std::invalid_argument("Variants have 1 to 4 suits and 1 to 6 ranks on each side of the 7");
+    }
+    if (this->factories.size() != v.numPlayers || this->names.size() != v.numPlayers) {
+        throw std::invalid_argument("Enumeration needs exactly one strategy per player");
+    }
+    if (config.chunkSize == 0) {
+        throw std::invalid_argument("Chunks need at least one deal");
+    }
+    countDeals(v);
+}
+
+uint64_t DealEnumerator::countDeals(const Variant& variant) {
+    return multinomial(handSizes(variant));
+}
+
+EnumerationResult DealEnumerator::run() {
+    const Variant& variant = config.variant;
+    const uint64_t totalDeals = countDeals(variant);
+    const uint64_t numChunks = (totalDeals + config.chunkSize - 1) / config.chunkSize;
+    const size_t n = names.size();
+
+    // Chunks finished by an earlier run with the same settings
+    std::map<uint64_t, ChunkResult> done;
+    std::ofstream progress;
+    if (!config.progressPath.empty()) {
+        const std::string header = progressHeader(variant, config.chunkSize, names);
+        std::ifstream in(config.progressPath);
+        std::string line;
+        if (in && std::getline(in, line)) {
+            if (line != header) {
+                throw std::runtime_error(config.progressPath + " belongs to a different enumeration");
+            }
+            while (std::getline(in, line)) {
+                std::istringstream fields(line);
+                std::string tag;
+                uint64_t chunk;
+                ChunkResult result;
+                result.rankSum.assign(n, 0);
+                fields >> tag >> chunk >> result.covered >> result.played >> result.games;
+                for (auto& sum : result.rankSum) fields >> sum;
+                // A line cut short by an interrupted run is simply played again
+                if (fields && tag == "chunk" && chunk < numChunks) done[chunk] = result;
+            }
+            in.close();
+            progress.open(config.progressPath, std::ios::app);
+        } else {
+            progress.open(config.progressPath, std::ios::trunc);
+            progress << header << "\n" << std::flush;
+        }
+        if (!progress) {
+            throw std::runtime_error("Cannot write progress file " + config.progressPath);
+        }
+    }
+
+    std::vector<uint64_t> pending;
+    for (uint64_t chunk = 0; chunk < numChunks; ++chunk) {
+        if (!done.count(chunk)) pending.push_back(chunk);
+    }
+
+    EnumerationResult result;
+    result.names = names;
+    result.totalDeals = totalDeals;
+    result.chunksResumed = done.size();
+    std::vector<uint64_t> rankSum(n, 0);
+    auto accumulate = [&](const ChunkResult& chunk) {
+        result.coveredDeals += chunk.covered;
+        result.playedDeals += chunk.played;
+        result.games += chunk.games;
+        for (size_t s = 0; s < n; ++s) rankSum[s] += chunk.rankSum[s];
+    };
+    for (const auto& [chunk, chunkResult] : done) accumulate(chunkResult);
+
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = static_cast<unsigned>(std::min<uint64_t>(numThreads, std::max<size_t>(1, pending.size())));
+
+    std::atomic<size_t> nextPending{0};
+    std::mutex resultMutex;
+    std::exception_ptr error;
+
+    auto work = [&](auto players) {
+        constexpr size_t N = decltype(players)::value;
+        std::vector<std::shared_ptr<PlayerStrategy>> instances;
+        for (const auto& factory : factories) instances.push_back(factory());
+        ChunkPlayer<N> player(variant, instances);
+
+        for (size_t i = nextPending.fetch_add(1); i < pending.size(); i = nextPending.fetch_add(1)) {
+            const uint64_t chunk = pending[i];
+            const uint64_t first = chunk * config.chunkSize;
+            ChunkResult chunkResult = player.play(first, std::min(totalDeals, first + config.chunkSize));
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            accumulate(chunkResult);
+            if (progress.is_open()) {
+                progress << "chunk " << chunk << " " << chunkResult.covered << " " << chunkResult.played
+                         << " " << chunkResult.games;
+                for (uint64_t sum : chunkResult.rankSum) progress << " " << sum;
+                progress << "\n" << std::flush;
+            }
+        }
+    };
+
+    auto worker = [&]() {
+        try {
+            switch (variant.numPlayers) {
+                case 2: work(std::integral_constant<size_t, 2>{}); break;
+                case 3: work(std::integral_constant<size_t, 3>{}); break;
+                default: work(std::integral_constant<size_t, 4>{}); break;
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (!error) error = std::current_exception();
+            nextPending.store(pending.size());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    uint64_t permutations = 1;
+    for (uint64_t p = 2; p <= n; ++p) permutations *= p;
+    result.expectedRank.assign(n, 0.0);
+    for (size_t s = 0; s < n && result.coveredDeals > 0; ++s) {
+        result.expectedRank[s] = static_cast<double>(rankSum[s]) /
+                                 (static_cast<double>(result.coveredDeals) * static_cast<double>(permutations));
+    }
+    result.complete = result.coveredDeals == totalDeals;
+    return result;
+}
+
+} // namespace sevens
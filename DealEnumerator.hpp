@@ -0,0 +1,72 @@
+#pragma once
+
+#include "PlayerStrategy.hpp"
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * A reduced Sevens game: numSuits suits holding the ranks 7 - ranksPerSide ..
+ * 7 + ranksPerSide. The 7s start on the table, the other cards are dealt
+ * round-robin in card order, so hand sizes differ by at most one.
+ */
+struct Variant {
+    uint64_t numPlayers = 2;
+    uint64_t numSuits = 4;
+    uint64_t ranksPerSide = 2;   // 1..6
+
+    uint64_t cardsDealt() const { return numSuits * 2 * ranksPerSide; }
+};
+
+struct EnumerationConfig {
+    Variant variant;
+    uint64_t chunkSize = 100000;   // deal indices per chunk (the unit of work and of resuming)
+    unsigned numThreads = 0;       // 0 = one worker per hardware thread
+    std::string progressPath;      // finished chunks are recorded here; empty = not resumable
+};
+
+/**
+ * expectedRank[s] is the average rank of strategy s over all deals and all
+ * seat assignments. Deals are weighted by their suit-symmetry class, which is
+ * exact for strategies that don't care about suit labels.
+ */
+struct EnumerationResult {
+    std::vector<std::string> names;
+    uint64_t totalDeals = 0;       // all deals of the variant
+    uint64_t playedDeals = 0;      // canonical deals actually played
+    uint64_t coveredDeals = 0;     // deals they stand for (totalDeals once complete)
+    uint64_t games = 0;
+    uint64_t chunksResumed = 0;
+    std::vector<double> expectedRank;
+    bool complete = false;
+};
+
+/**
+ * Plays every deal of a small variant, once per seat permutation of the
+ * strategies (one strategy per player), on all cores.
+ *
+ * Deal index i is the i-th way, in lexicographic order, to hand the cards to
+ * the seats, so a chunk of indices can be unranked and then walked with
+ * std::next_permutation. Deals that differ only by a relabelling of the suits
+ * are played once: only the deal whose per-suit owner sequences are sorted is
+ * kept, and it counts for its whole class.
+ */
+class DealEnumerator {
+public:
+    DealEnumerator(std::vector<StrategyFactory> factories,
+                   std::vector<std::string> names,
+                   EnumerationConfig config);
+
+    EnumerationResult run();
+
+    // Number of distinct deals of the variant; throws std::overflow_error past 2^62
+    static uint64_t countDeals(const Variant& variant);
+
+private:
+    std::vector<StrategyFactory> factories;
+    std::vector<std::string> names;
+    EnumerationConfig config;
+};
+
+} // namespace sevens
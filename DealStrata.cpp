@@ -0,0 +1,253 @@
+#include "DealStrata.hpp"
+#include "Deck.hpp"
+#include "FeatureEvaluator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace sevens {
+
+namespace {
+
+// Separate stream for the pilot, so the deals classified there are not the ones played
+constexpr uint64_t kPilotSeedMix = 0x5851F42D4C957F2DULL;
+
+bool isEdgeRank(int rank) {
+    return rank <= 2 || rank >= 12;
+}
+
+} // namespace
+
+DealProfile profileDeal(const std::array<uint64_t, GameState::kMaxPlayers>& hands, size_t numPlayers) {
+    uint64_t sevens = 0;
+    for (int suit = 0; suit < 4; ++suit) sevens |= GameState::cardBit(Card{suit, 7});
+
+    DealProfile profile;
+    int strongest = 0;
+    int weakest = 0;
+    for (size_t seat = 0; seat < numPlayers; ++seat) {
+        const FeatureContext context = maskContext(hands[seat], sevens);
+        for (int suit = 0; suit < 4; ++suit) {
+            if (context.inHand[suit][6]) profile.freeCards[seat] += chainLength(context, suit, 6);
+            if (context.inHand[suit][8]) profile.freeCards[seat] += chainLength(context, suit, 8);
+            for (int rank = 1; rank <= 13; ++rank) {
+                if (context.inHand[suit][rank] && isEdgeRank(rank)) ++profile.edgeCards[seat];
+            }
+            if (context.suitCount[suit] >= 5) ++profile.longSuits[seat];
+        }
+        profile.strength[seat] = profile.freeCards[seat] - profile.edgeCards[seat] - profile.longSuits[seat];
+        if (seat == 0 || profile.strength[seat] > strongest) strongest = profile.strength[seat];
+        if (seat == 0 || profile.strength[seat] < weakest) weakest = profile.strength[seat];
+    }
+    profile.spread = strongest - weakest;
+    return profile;
+}
+
+StratifiedBatch::StratifiedBatch(std::vector<StrategyFactory> factories,
+                                 std::vector<std::string> names,
+                                 BatchConfig config,
+                                 StratifiedConfig strataConfig)
+    : factories(std::move(factories)), names(std::move(names)), config(config), strataConfig(strataConfig)
+{
+    if (this->factories.empty() || this->factories.size() > GameState::kMaxPlayers) {
+        throw std::invalid_argument("A stratified match needs 1 to " +
+                                    std::to_string(GameState::kMaxPlayers) + " strategies");
+    }
+    if (this->names.size() != this->factories.size()) {
+        throw std::invalid_argument("StratifiedBatch needs exactly one name per strategy");
+    }
+    if (this->strataConfig.strata == 0 || this->strataConfig.pilotDeals == 0) {
+        throw std::invalid_argument("A stratified match needs at least one stratum and one pilot deal");
+    }
+    if (this->config.numDeals < 2 * this->strataConfig.strata) {
+        throw std::invalid_argument("A stratified match needs at least two deals per stratum (" +
+                                    std::to_string(2 * this->strataConfig.strata) + " deals for " +
+                                    std::to_string(this->strataConfig.strata) + " strata)");
+    }
+}
+
+std::vector<DealResult> StratifiedBatch::playDeals(const std::vector<uint64_t>& deals) const {
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (deals.size() < numThreads) {
+        numThreads = static_cast<unsigned>(std::max<size_t>(1, deals.size()));
+    }
+
+    std::vector<DealResult> results(deals.size());
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            std::vector<std::shared_ptr<PlayerStrategy>> players;
+            for (const auto& factory : factories) {
+                players.push_back(factory());
+            }
+            StatsShard* shard = config.stats ? &config.stats->claimShard() : nullptr;
+            for (size_t i = next.fetch_add(1); i < deals.size(); i = next.fetch_add(1)) {
+                results[i] = BatchRunner::playDeal(deals[i], config.seed, config.duplicate, players, shard);
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            next.store(deals.size());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+StratifiedSummary StratifiedBatch::run() {
+    const size_t n = names.size();
+    StratifiedSummary out;
+
+    // Strata: runs of spread values holding about equal shares of the pilot deals
+    const uint64_t pilotDeals = strataConfig.pilotDeals;
+    std::vector<int> spreads(pilotDeals);
+    {
+        std::vector<uint64_t> seeds(pilotDeals);
+        for (uint64_t i = 0; i < pilotDeals; ++i) {
+            seeds[i] = BatchRunner::dealSeed(config.seed ^ kPilotSeedMix, i);
+        }
+        std::vector<Deck> decks(pilotDeals);
+        Deck::shuffleMany(seeds.data(), decks.data(), decks.size());
+        for (uint64_t i = 0; i < pilotDeals; ++i) {
+            spreads[i] = profileDeal(dealHands(decks[i], n), n).spread;
+        }
+    }
+    std::sort(spreads.begin(), spreads.end());
+    for (size_t i = 0; i < spreads.size();) {
+        const size_t target = (out.strata.size() + 1) * spreads.size() / strataConfig.strata;
+        size_t j = std::max(i + 1, target);
+        while (j < spreads.size() && spreads[j] == spreads[j - 1]) ++j;
+        StratumSummary stratum;
+        stratum.lowSpread = spreads[i];
+        stratum.highSpread = spreads[j - 1];
+        stratum.weight = static_cast<double>(j - i) / static_cast<double>(spreads.size());
+        out.strata.push_back(stratum);
+        i = j;
+    }
+    const size_t numStrata = out.strata.size();
+    auto stratumOf = [&](int spread) {
+        size_t h = 0;
+        while (h + 1 < numStrata && spread > out.strata[h].highSpread) ++h;
+        return h;
+    };
+
+    // Deal indices in order, each kept if its stratum still needs deals
+    uint64_t nextDeal = config.firstDeal;
+    const uint64_t scanLimit = config.firstDeal + 1000 * std::max<uint64_t>(config.numDeals, 1) + pilotDeals;
+    std::vector<size_t> dealStrata;   // stratum of each deal drawn, in draw order
+    auto draw = [&](const std::vector<uint64_t>& wanted) {
+        std::vector<uint64_t> deals;
+        dealStrata.clear();
+        std::vector<uint64_t> have(numStrata, 0);
+        uint64_t missing = std::accumulate(wanted.begin(), wanted.end(), uint64_t{0});
+        while (missing > 0) {
+            if (nextDeal >= scanLimit) {
+                throw std::runtime_error("Could not find enough deals for every stratum");
+            }
+            const uint64_t deal = nextDeal++;
+            const Deck deck = Deck::shuffled(BatchRunner::dealSeed(config.seed, deal));
+            const size_t h = stratumOf(profileDeal(dealHands(deck, n), n).spread);
+            if (have[h] < wanted[h]) {
+                ++have[h];
+                --missing;
+                deals.push_back(deal);
+                dealStrata.push_back(h);
+            }
+        }
+        return deals;
+    };
+
+    std::vector<DealTotals> totals(numStrata, DealTotals(n));
+    auto play = [&](const std::vector<uint64_t>& deals) {
+        const std::vector<DealResult> results = playDeals(deals);
+        for (size_t i = 0; i < results.size(); ++i) {
+            totals[dealStrata[i]].add(results[i]);
+        }
+    };
+
+    // Pilot games measure the spread of results in every stratum, within the budget
+    // (numStrata <= strata and the constructor checked numDeals >= 2 * strata)...
+    const uint64_t pilotPlayed = std::max<uint64_t>(2, std::min(strataConfig.pilotPlayed, config.numDeals / numStrata));
+    play(draw(std::vector<uint64_t>(numStrata, pilotPlayed)));
+
+    // ...and the rest of the budget goes where it varies most (Neyman allocation)
+    std::vector<double> share(numStrata, 0.0);
+    double shareSum = 0.0;
+    for (size_t h = 0; h < numStrata; ++h) {
+        double variance = 0.0;
+        for (size_t s = 0; s < n; ++s) variance += totals[h].relativeScore[s].variance();
+        share[h] = out.strata[h].weight * std::sqrt(variance / static_cast<double>(n));
+        shareSum += share[h];
+    }
+    if (shareSum <= 0.0) {
+        for (size_t h = 0; h < numStrata; ++h) share[h] = out.strata[h].weight;
+        shareSum = 1.0;
+    }
+    const uint64_t played = pilotPlayed * numStrata;
+    const uint64_t remaining = config.numDeals > played ? config.numDeals - played : 0;
+    std::vector<uint64_t> extra(numStrata, 0);
+    uint64_t given = 0;
+    for (size_t h = 0; h < numStrata; ++h) {
+        extra[h] = static_cast<uint64_t>(std::floor(static_cast<double>(remaining) * share[h] / shareSum));
+        given += extra[h];
+    }
+    // Rounding leftovers to the strata with the largest shares
+    std::vector<size_t> byShare(numStrata);
+    std::iota(byShare.begin(), byShare.end(), 0);
+    std::sort(byShare.begin(), byShare.end(), [&](size_t a, size_t b) { return share[a] > share[b]; });
+    for (size_t k = 0; given < remaining; k = (k + 1) % numStrata, ++given) {
+        ++extra[byShare[k]];
+    }
+    play(draw(extra));
+    out.dealsClassified = nextDeal - config.firstDeal;
+
+    // Stratified estimate: stratum means weighted by stratum share
+    BatchSummary& summary = out.summary;
+    summary.names = names;
+    summary.meanRank.assign(n, 0.0);
+    summary.meanRelativeScore.assign(n, 0.0);
+    summary.stdError.assign(n, 0.0);
+    for (size_t h = 0; h < numStrata; ++h) {
+        StratumSummary& stratum = out.strata[h];
+        const DealTotals& t = totals[h];
+        stratum.deals = t.deals;
+        summary.deals += t.deals;
+        summary.games += t.games;
+        for (size_t s = 0; s < n; ++s) {
+            stratum.meanRelativeScore.push_back(t.relativeScore[s].mean);
+            stratum.stdDeviation.push_back(std::sqrt(t.relativeScore[s].variance()));
+            summary.meanRank[s] += stratum.weight * t.meanRank[s].mean;
+            summary.meanRelativeScore[s] += stratum.weight * t.relativeScore[s].mean;
+            if (t.deals > 0) {
+                summary.stdError[s] += stratum.weight * stratum.weight * t.relativeScore[s].variance() /
+                                       static_cast<double>(t.deals);
+            }
+        }
+    }
+    for (double& error : summary.stdError) error = std::sqrt(error);
+    return out;
+}
+
+} // namespace sevens
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "BatchRunner.hpp"
+#include "GameState.hpp"
+#include "ResultStats.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * What a deal looks like before it is played, from the hands alone.
+ *   freeCards  own cards that can be laid from the 7s through own cards only
+ *              (the chains FeatureEvaluator's chainLength measures from the 6 and the 8)
+ *   edgeCards  aces, 2s, queens and kings, the last cards a suit opens up to
+ *   longSuits  suits with 5 or more own cards
+ * strength = freeCards - edgeCards - longSuits per seat, and spread is the
+ * strongest seat's strength minus the weakest one's: a large spread is a deal
+ * mostly decided by who got which cards.
+ */
+struct DealProfile {
+    std::array<int, GameState::kMaxPlayers> freeCards{};
+    std::array<int, GameState::kMaxPlayers> edgeCards{};
+    std::array<int, GameState::kMaxPlayers> longSuits{};
+    std::array<int, GameState::kMaxPlayers> strength{};
+    int spread = 0;
+};
+
+DealProfile profileDeal(const std::array<uint64_t, GameState::kMaxPlayers>& hands, size_t numPlayers);
+
+/**
+ * Settings of a stratified match. Deals are put into strata by spread.
+ * The boundaries and each stratum's share of all deals come from classifying
+ * pilotDeals deals without playing them. Then pilotPlayed deals per stratum
+ * are played to measure how much results vary inside each stratum. The rest
+ * of the budget goes where results vary most (Neyman allocation). The pilot
+ * is cut to fit the budget, but a stratum needs at least two played deals for
+ * a spread, so numDeals must be at least 2 * strata.
+ */
+struct StratifiedConfig {
+    size_t strata = 4;
+    uint64_t pilotDeals = 50000;
+    uint64_t pilotPlayed = 50;
+};
+
+struct StratumSummary {
+    int lowSpread = 0;     // spreads low..high fall in this stratum
+    int highSpread = 0;
+    double weight = 0.0;   // share of all deals
+    uint64_t deals = 0;    // played
+    std::vector<double> meanRelativeScore;
+    std::vector<double> stdDeviation;   // of the per-deal relative score
+};
+
+/**
+ * Result of a stratified match. The summary is the stratified estimate:
+ * stratum means weighted by stratum share, with standard error
+ * sqrt(sum of weight^2 x variance / deals). It is unbiased for the same
+ * quantity as a uniform match, whatever the number of deals per stratum.
+ * summary.deals and games count the deals actually played.
+ */
+struct StratifiedSummary {
+    BatchSummary summary;
+    std::vector<StratumSummary> strata;
+    uint64_t dealsClassified = 0;   // deal indices looked at to fill the strata
+};
+
+/**
+ * A duplicate (or rotated) match whose deals are drawn by stratum instead of
+ * uniformly. Deal indices are scanned from config.firstDeal and classified
+ * (cheap: no game is played). Each one goes to its stratum until that stratum
+ * has its share, so which deals are played depends only on the seed.
+ * config.numDeals is the total budget of deals played.
+ */
+class StratifiedBatch {
+public:
+    StratifiedBatch(std::vector<StrategyFactory> factories,
+                    std::vector<std::string> names,
+                    BatchConfig config,
+                    StratifiedConfig strataConfig);
+
+    StratifiedSummary run();
+
+private:
+    // Plays the given deal indices on all cores
+    std::vector<DealResult> playDeals(const std::vector<uint64_t>& deals) const;
+
+    std::vector<StrategyFactory> factories;
+    std::vector<std::string> names;
+    BatchConfig config;
+    StratifiedConfig strataConfig;
+};
+
+} // namespace sevens
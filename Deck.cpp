@@ -0,0 +1,84 @@
+#include "Deck.hpp"
+#include <utility>
+
+namespace sevens {
+
+namespace {
+
+constexpr uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+// Decks shuffled side by side by shuffleMany
+constexpr size_t kLanes = 8;
+
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, bound) from the high 32 bits of a random word
+uint32_t below(uint64_t random, uint32_t bound) {
+    return static_cast<uint32_t>(((random >> 32) * bound) >> 32);
+}
+
+constexpr std::array<uint8_t, 52> kOrderedDeck = [] {
+    std::array<uint8_t, 52> cards{};
+    for (size_t i = 0; i < cards.size(); ++i) cards[i] = static_cast<uint8_t>(i);
+    return cards;
+}();
+
+} // namespace
+
+Deck Deck::shuffled(uint64_t seed) {
+    Deck deck{kOrderedDeck};
+    uint64_t state = seed;
+    for (uint32_t i = 51; i > 0; --i) {
+        state += kGolden;
+        std::swap(deck.cards[i], deck.cards[below(mix(state), i + 1)]);
+    }
+    return deck;
+}
+
+void Deck::shuffleMany(const uint64_t* seeds, Deck* decks, size_t count) {
+    size_t first = 0;
+    for (; first + kLanes <= count; first += kLanes) {
+        uint64_t state[kLanes];
+        uint32_t pick[kLanes];
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            state[lane] = seeds[first + lane];
+            decks[first + lane].cards = kOrderedDeck;
+        }
+        for (uint32_t i = 51; i > 0; --i) {
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                state[lane] += kGolden;
+                pick[lane] = below(mix(state[lane]), i + 1);
+            }
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                std::swap(decks[first + lane].cards[i], decks[first + lane].cards[pick[lane]]);
+            }
+        }
+    }
+    for (; first < count; ++first) {
+        decks[first] = shuffled(seeds[first]);
+    }
+}
+
+std::array<uint64_t, GameState::kMaxPlayers> dealHands(const Deck& deck, size_t numPlayers) {
+    std::array<uint64_t, GameState::kMaxPlayers> hands{};
+    size_t dealt = 0;
+    for (uint8_t card : deck.cards) {
+        if (card % 13 == 6) continue;
+        hands[dealt++ % numPlayers] |= uint64_t{1} << card;
+    }
+    return hands;
+}
+
+void dealCards(const Deck& deck, size_t numPlayers, std::vector<Card>* hands) {
+    for (size_t seat = 0; seat < numPlayers; ++seat) hands[seat].clear();
+    size_t dealt = 0;
+    for (uint8_t card : deck.cards) {
+        if (card % 13 == 6) continue;
+        hands[dealt++ % numPlayers].push_back(GameState::cardAt(card));
+    }
+}
+
+} // namespace sevens
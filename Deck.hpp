@@ -0,0 +1,45 @@
+#pragma once
+
+#include "GameState.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * A deck as 52 card ids in play order, id = GameState::cardIndex
+ * (suit * 13 + rank - 1). No maps and no allocation: a deck is 52 bytes.
+ *
+ * The shuffle is Fisher-Yates driven by splitmix64, seeded with the deal seed
+ * (BatchRunner::dealSeed), and bounded by a 32-bit multiply instead of a
+ * division. Every engine and the interactive game deal from it, so a deal
+ * seed gives the same hands everywhere.
+ */
+struct Deck {
+    std::array<uint8_t, 52> cards;
+
+    static Deck shuffled(uint64_t seed);
+
+    // Same decks as shuffled(seeds[i]), generated several at a time: the
+    // generators of a group of decks step together in arrays the compiler can
+    // vectorise, and the swaps of different decks do not depend on each other
+    static void shuffleMany(const uint64_t* seeds, Deck* decks, size_t count);
+
+    Card at(size_t position) const { return GameState::cardAt(cards[position]); }
+};
+
+// Deals the deck round the table as every engine does: deck order, skipping
+// the 7s (they start on the table), card i to seat i % numPlayers
+std::array<uint64_t, GameState::kMaxPlayers> dealHands(const Deck& deck, size_t numPlayers);
+
+// Cards dealHands gives a seat: the 48 cards besides the 7s, round-robin from seat 0
+inline size_t handSize(size_t numPlayers, size_t seat) {
+    return 48 / numPlayers + (seat < 48 % numPlayers ? 1 : 0);
+}
+
+// The same deal as card lists in deal order, for strategies: clears hands[0..numPlayers) first
+void dealCards(const Deck& deck, size_t numPlayers, std::vector<Card>* hands);
+
+} // namespace sevens
@@ -0,0 +1,615 @@
+#include "DistributedRunner.hpp"
+#include "ProgressJournal.hpp"
+#include "ResultStats.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace sevens {
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const SocketHandle kNoSocket = INVALID_SOCKET;
+
+void closeSocket(SocketHandle socket) { closesocket(socket); }
+int pollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+int socketError() { return WSAGetLastError(); }
+
+// Winsock must be started once per process before any socket call
+void startSockets() {
+    static const bool started = [] {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            throw std::runtime_error("Cannot start Winsock");
+        }
+        return true;
+    }();
+    (void)started;
+}
+#else
+using SocketHandle = int;
+const SocketHandle kNoSocket = -1;
+
+void closeSocket(SocketHandle socket) { close(socket); }
+int pollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+int socketError() { return errno; }
+void startSockets() {}
+#endif
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;   // a closed peer is an error, not SIGPIPE
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+constexpr uint32_t kMaxMessage = 1 << 24;
+constexpr size_t kShardsInFlight = 2;   // per worker, so it never waits for its next shard
+constexpr int kPollMs = 100;
+
+enum MessageType : uint8_t {
+    kHello = 1,    // worker: threads
+    kJob,          // coordinator: seed, duplicate, strategy specs
+    kShard,        // coordinator: shard, first deal, end deal
+    kResult,       // worker: shard, deal, games, per strategy mean rank and relative score
+    kShardDone,    // worker: shard
+    kStop,         // coordinator: no more work
+};
+
+struct Address {
+    bool local = false;   // Unix-domain socket
+    std::string path;
+    std::string host;
+    std::string port;
+};
+
+Address parseAddress(const std::string& text) {
+    Address address;
+    if (text.rfind("unix:", 0) == 0) {
+#ifdef _WIN32
+        throw std::runtime_error("Unix-domain sockets are not supported here: " + text);
+#else
+        address.local = true;
+        address.path = text.substr(5);
+        if (address.path.empty() || address.path.size() >= sizeof(sockaddr_un{}.sun_path)) {
+            throw std::runtime_error("Invalid socket path: " + text);
+        }
+        return address;
+#endif
+    }
+    const std::string hostPort = text.rfind("tcp:", 0) == 0 ? text.substr(4) : text;
+    const size_t colon = hostPort.rfind(':');
+    if (colon == std::string::npos || colon + 1 == hostPort.size()) {
+        throw std::runtime_error("Expected tcp:host:port or unix:path, got " + text);
+    }
+    address.host = hostPort.substr(0, colon);
+    address.port = hostPort.substr(colon + 1);
+    return address;
+}
+
+// Listening socket, or std::runtime_error
+SocketHandle listenOn(const Address& address) {
+    startSockets();
+#ifndef _WIN32
+    if (address.local) {
+        SocketHandle s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s == kNoSocket) throw std::runtime_error("Cannot create a socket");
+        sockaddr_un local{};
+        local.sun_family = AF_UNIX;
+        std::strncpy(local.sun_path, address.path.c_str(), sizeof(local.sun_path) - 1);
+        unlink(address.path.c_str());   // left over from an earlier run
+        if (bind(s, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || listen(s, 64) != 0) {
+            closeSocket(s);
+            throw std::runtime_error("Cannot listen on " + address.path);
+        }
+        return s;
+    }
+#endif
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    const char* host = address.host.empty() ? nullptr : address.host.c_str();
+    if (getaddrinfo(host, address.port.c_str(), &hints, &found) != 0) {
+        throw std::runtime_error("Cannot resolve " + address.host + ":" + address.port);
+    }
+    SocketHandle s = kNoSocket;
+    for (addrinfo* candidate = found; candidate && s == kNoSocket; candidate = candidate->ai_next) {
+        s = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (s == kNoSocket) continue;
+        const int yes = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&yes), sizeof(yes));
+        if (bind(s, candidate->ai_addr, static_cast<int>(candidate->ai_addrlen)) != 0 || listen(s, 64) != 0) {
+            closeSocket(s);
+            s = kNoSocket;
+        }
+    }
+    freeaddrinfo(found);
+    if (s == kNoSocket) {
+        throw std::runtime_error("Cannot listen on " + address.host + ":" + address.port);
+    }
+    return s;
+}
+
+// Connected socket, or kNoSocket if nobody is listening (yet)
+SocketHandle connectTo(const Address& address) {
+    startSockets();
+#ifndef _WIN32
+    if (address.local) {
+        SocketHandle s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s == kNoSocket) return kNoSocket;
+        sockaddr_un local{};
+        local.sun_family = AF_UNIX;
+        std::strncpy(local.sun_path, address.path.c_str(), sizeof(local.sun_path) - 1);
+        if (connect(s, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            closeSocket(s);
+            return kNoSocket;
+        }
+        return s;
+    }
+#endif
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    const std::string host = address.host.empty() ? "localhost" : address.host;
+    if (getaddrinfo(host.c_str(), address.port.c_str(), &hints, &found) != 0) return kNoSocket;
+    SocketHandle s = kNoSocket;
+    for (addrinfo* candidate = found; candidate && s == kNoSocket; candidate = candidate->ai_next) {
+        s = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (s == kNoSocket) continue;
+        if (connect(s, candidate->ai_addr, static_cast<int>(candidate->ai_addrlen)) != 0) {
+            closeSocket(s);
+            s = kNoSocket;
+        }
+    }
+    freeaddrinfo(found);
+    return s;
+}
+
+// Little-endian fields, framed as [length u32][type u8][fields]
+class MessageWriter {
+public:
+    explicit MessageWriter(MessageType type) : bytes(4, '\0') { u8(type); }
+
+    MessageWriter& u8(uint8_t value) {
+        bytes.push_back(static_cast<char>(value));
+        return *this;
+    }
+    MessageWriter& u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) bytes.push_back(static_cast<char>(value >> (8 * i)));
+        return *this;
+    }
+    MessageWriter& f64(double value) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return u64(bits);
+    }
+    MessageWriter& str(const std::string& value) {
+        u64(value.size());
+        bytes += value;
+        return *this;
+    }
+
+    const std::string& finish() {
+        const uint32_t length = static_cast<uint32_t>(bytes.size() - 4);
+        for (int i = 0; i < 4; ++i) bytes[i] = static_cast<char>(length >> (8 * i));
+        return bytes;
+    }
+
+private:
+    std::string bytes;
+};
+
+class MessageReader {
+public:
+    explicit MessageReader(const std::string& payload) : bytes(payload) {}
+
+    uint8_t u8() {
+        need(1);
+        return static_cast<uint8_t>(bytes[offset++]);
+    }
+    uint64_t u64() {
+        need(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[offset++])) << (8 * i);
+        return value;
+    }
+    double f64() {
+        const uint64_t bits = u64();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    std::string str() {
+        const uint64_t length = u64();
+        need(length);
+        std::string value = bytes.substr(offset, length);
+        offset += length;
+        return value;
+    }
+
+private:
+    void need(uint64_t count) const {
+        if (bytes.size() - offset < count) throw std::runtime_error("Truncated message");
+    }
+
+    const std::string& bytes;
+    size_t offset = 0;
+};
+
+// A stream socket with its unparsed input
+class Connection {
+public:
+    explicit Connection(SocketHandle socket) : socket(socket) {}
+    ~Connection() { closeSocket(socket); }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    SocketHandle handle() const { return socket; }
+
+    void send(const std::string& message) {
+        size_t sent = 0;
+        while (sent < message.size()) {
+            const int n = ::send(socket, message.data() + sent, static_cast<int>(message.size() - sent), kSendFlags);
+            if (n <= 0) throw std::runtime_error("Connection lost (error " + std::to_string(socketError()) + ")");
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    // Reads what has arrived (blocks if nothing has); false once the peer is gone
+    bool receive() {
+        char buffer[65536];
+        const int n = ::recv(socket, buffer, sizeof(buffer), 0);
+        if (n <= 0) return false;
+        inbox.append(buffer, static_cast<size_t>(n));
+        return true;
+    }
+
+    // Next complete message, if one has arrived
+    bool next(uint8_t& type, std::string& payload) {
+        if (inbox.size() < 5) return false;
+        uint32_t length = 0;
+        for (int i = 0; i < 4; ++i) length |= static_cast<uint32_t>(static_cast<uint8_t>(inbox[i])) << (8 * i);
+        if (length == 0 || length > kMaxMessage) throw std::runtime_error("Malformed message");
+        if (inbox.size() < 4 + static_cast<size_t>(length)) return false;
+        type = static_cast<uint8_t>(inbox[4]);
+        payload.assign(inbox, 5, length - 1);
+        inbox.erase(0, 4 + static_cast<size_t>(length));
+        return true;
+    }
+
+private:
+    SocketHandle socket;
+    std::string inbox;
+};
+
+struct Shard {
+    uint64_t first = 0;
+    uint64_t end = 0;
+    bool done = false;
+    unsigned copies = 0;   // workers currently playing it
+    std::chrono::steady_clock::time_point assigned;
+};
+
+struct Peer {
+    std::unique_ptr<Connection> connection;
+    bool ready = false;
+    std::map<uint64_t, DealTotals> inFlight;   // shard -> results received so far
+};
+
+} // namespace
+
+TournamentCoordinator::TournamentCoordinator(std::vector<std::string> specs, std::vector<std::string> names,
+                                             ClusterConfig config)
+    : specs(std::move(specs)), names(std::move(names)), config(std::move(config))
+{
+    if (this->specs.size() != this->names.size() || this->specs.empty()) {
+        throw std::invalid_argument("One name per strategy spec is required");
+    }
+    if (this->config.shardDeals == 0) this->config.shardDeals = 1;
+}
+
+void TournamentCoordinator::setProgressCallback(ProgressCallback callback) {
+    onProgress = std::move(callback);
+}
+
+BatchSummary TournamentCoordinator::run() {
+    using Clock = std::chrono::steady_clock;
+    const Address address = parseAddress(config.address);
+    const size_t n = names.size();
+
+    std::vector<Shard> shards;
+    for (uint64_t first = 0; first < config.numDeals; first += config.shardDeals) {
+        shards.push_back(Shard{first, std::min(config.numDeals, first + config.shardDeals), false, 0, {}});
+    }
+    // Shards a journaled earlier run finished are not handed out again
+    std::unique_ptr<ProgressJournal> journal;
+    if (!config.journalPath.empty()) {
+        journal = std::make_unique<ProgressJournal>(
+            config.journalPath,
+            ProgressJournal::batchIdentity(names, config.seed, config.numDeals, config.shardDeals, config.duplicate), n);
+    }
+    std::deque<uint64_t> pending;
+    uint64_t shardsDone = 0;
+    DealTotals totals = journal ? journal->completedDeals() : DealTotals(n);
+    for (uint64_t i = 0; i < shards.size(); ++i) {
+        if (journal && journal->isComplete(shards[i].first, shards[i].end)) {
+            shards[i].done = true;
+            ++shardsDone;
+        } else {
+            pending.push_back(i);
+        }
+    }
+
+    MessageWriter job(kJob);
+    job.u64(config.seed).u8(config.duplicate ? 1 : 0).u64(specs.size());
+    for (const auto& spec : specs) job.str(spec);
+    const std::string jobMessage = job.finish();
+
+    const auto timeout = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config.shardTimeoutSeconds));
+
+    // Next shard for a worker: a pending one, else the longest-running one past the timeout
+    auto assign = [&](Peer& peer) {
+        while (peer.ready && peer.inFlight.size() < kShardsInFlight) {
+            uint64_t shard = shards.size();
+            while (!pending.empty() && shard == shards.size()) {
+                if (!shards[pending.front()].done) shard = pending.front();
+                pending.pop_front();
+            }
+            if (shard == shards.size()) {
+                const Clock::time_point now = Clock::now();
+                for (uint64_t i = 0; i < shards.size(); ++i) {
+                    const Shard& candidate = shards[i];
+                    if (candidate.done || candidate.copies == 0 || peer.inFlight.count(i)) continue;
+                    if (now - candidate.assigned < timeout) continue;
+                    if (shard == shards.size() || candidate.assigned < shards[shard].assigned) shard = i;
+                }
+                if (shard == shards.size()) return;
+                ++clusterStats.reassigned;
+            }
+            Shard& chosen = shards[shard];
+            peer.connection->send(MessageWriter(kShard).u64(shard).u64(chosen.first).u64(chosen.end).finish());
+            peer.inFlight.emplace(shard, DealTotals(n));
+            ++chosen.copies;
+            chosen.assigned = Clock::now();
+        }
+    };
+
+    // A lost worker's unfinished shards go back to the front of the queue
+    auto drop = [&](Peer& peer) {
+        if (!peer.inFlight.empty()) ++clusterStats.lostWorkers;
+        for (const auto& [shard, partial] : peer.inFlight) {
+            if (--shards[shard].copies == 0 && !shards[shard].done) {
+                pending.push_front(shard);
+                ++clusterStats.reassigned;
+            }
+        }
+        peer.inFlight.clear();
+        peer.connection.reset();
+    };
+
+    auto handle = [&](Peer& peer, uint8_t type, const std::string& payload) {
+        MessageReader in(payload);
+        if (type == kHello) {
+            in.u64();   // worker threads, informational
+            peer.ready = true;
+            ++clusterStats.workers;
+            peer.connection->send(jobMessage);
+            assign(peer);
+        } else if (type == kResult) {
+            const uint64_t shard = in.u64();
+            auto it = peer.inFlight.find(shard);
+            if (it == peer.inFlight.end() || in.u64() >= config.numDeals) throw std::runtime_error("Unexpected result");
+            DealTotals& partial = it->second;
+            partial.games += in.u64();
+            ++partial.deals;
+            if (in.u64() != n) throw std::runtime_error("Result for a different number of strategies");
+            for (size_t s = 0; s < n; ++s) {
+                partial.meanRank[s].add(in.f64());
+                partial.relativeScore[s].add(in.f64());
+            }
+        } else if (type == kShardDone) {
+            const uint64_t shard = in.u64();
+            auto it = peer.inFlight.find(shard);
+            if (it == peer.inFlight.end()) throw std::runtime_error("Unexpected shard completion");
+            Shard& done = shards[shard];
+            --done.copies;
+            // The first complete copy counts; duplicates from slow workers are dropped
+            if (!done.done && it->second.deals == done.end - done.first) {
+                TraceSpan merge("mergeShard", "merge", "first", done.first);
+                done.done = true;
+                ++shardsDone;
+                totals.merge(it->second);
+                if (journal) {
+                    // Workers send per-deal results only, so the record carries no game statistics
+                    journal->append(done.first, done.end, it->second, ResultTotals(n));
+                }
+                if (onProgress) onProgress(totals.deals, config.numDeals);
+            } else if (!done.done && done.copies == 0) {
+                pending.push_front(shard);
+                ++clusterStats.reassigned;
+            }
+            peer.inFlight.erase(it);
+            assign(peer);
+        } else {
+            throw std::runtime_error("Unexpected message");
+        }
+    };
+
+    Connection listener(listenOn(address));
+    std::vector<Peer> peers;
+    std::vector<pollfd> fds;
+    while (shardsDone < shards.size()) {
+        fds.assign(1, pollfd{listener.handle(), POLLIN, 0});
+        for (const Peer& peer : peers) fds.push_back(pollfd{peer.connection->handle(), POLLIN, 0});
+        if (pollSockets(fds.data(), fds.size(), kPollMs) < 0) {
+            throw std::runtime_error("poll failed (error " + std::to_string(socketError()) + ")");
+        }
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            Peer& peer = peers[i - 1];
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            try {
+                if (!peer.connection->receive()) {
+                    drop(peer);
+                    continue;
+                }
+                uint8_t type = 0;
+                std::string payload;
+                while (peer.connection && peer.connection->next(type, payload)) {
+                    handle(peer, type, payload);
+                }
+            }
+            catch (const std::runtime_error&) {
+                drop(peer);   // broken or misbehaving worker; its shards are played elsewhere
+            }
+        }
+        peers.erase(std::remove_if(peers.begin(), peers.end(), [](const Peer& p) { return !p.connection; }),
+                    peers.end());
+
+        if (fds[0].revents & POLLIN) {
+            SocketHandle accepted = accept(listener.handle(), nullptr, nullptr);
+            if (accepted != kNoSocket) {
+                peers.emplace_back();
+                peers.back().connection = std::make_unique<Connection>(accepted);
+            }
+        }
+
+        // Idle workers pick up stragglers once they pass the timeout
+        for (Peer& peer : peers) {
+            try {
+                assign(peer);
+            }
+            catch (const std::runtime_error&) {
+                drop(peer);
+            }
+        }
+        peers.erase(std::remove_if(peers.begin(), peers.end(), [](const Peer& p) { return !p.connection; }),
+                    peers.end());
+    }
+
+    const std::string stop = MessageWriter(kStop).finish();
+    for (Peer& peer : peers) {
+        try {
+            peer.connection->send(stop);
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+#ifndef _WIN32
+    if (address.local) unlink(address.path.c_str());
+#endif
+
+    return BatchRunner::summarize(totals, names);
+}
+
+TournamentWorker::TournamentWorker(std::string address, StrategySpecLoader loader, unsigned numThreads)
+    : address(std::move(address)), loader(std::move(loader)), numThreads(numThreads)
+{
+}
+
+uint64_t TournamentWorker::run(double connectSeconds) {
+    const Address target = parseAddress(address);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                                  std::chrono::duration<double>(connectSeconds));
+    SocketHandle s = connectTo(target);
+    while (s == kNoSocket && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        s = connectTo(target);
+    }
+    if (s == kNoSocket) {
+        throw std::runtime_error("Cannot connect to " + address);
+    }
+    Connection connection(s);
+    connection.send(MessageWriter(kHello).u64(numThreads).finish());
+
+    std::vector<StrategyFactory> factories;
+    std::vector<std::string> names;
+    BatchConfig batch;
+    batch.numThreads = numThreads;
+    bool haveJob = false;
+    uint64_t played = 0;
+
+    uint8_t type = 0;
+    std::string payload;
+    for (;;) {
+        while (!connection.next(type, payload)) {
+            if (!connection.receive()) return played;   // coordinator finished or went away
+        }
+        MessageReader in(payload);
+        if (type == kJob) {
+            batch.seed = in.u64();
+            batch.duplicate = in.u8() != 0;
+            std::vector<std::string> specs(in.u64());
+            for (auto& spec : specs) spec = in.str();
+            factories.clear();
+            names.clear();
+            if (!loader(specs, factories, names)) {
+                throw std::runtime_error("Cannot load the strategies of the job");
+            }
+            haveJob = true;
+        } else if (type == kShard) {
+            if (!haveJob) throw std::runtime_error("Shard before job");
+            const uint64_t shard = in.u64();
+            batch.firstDeal = in.u64();
+            batch.numDeals = in.u64() - batch.firstDeal;
+
+            // Each deal goes out as soon as it is played (callbacks are serialized)
+            bool lost = false;
+            BatchRunner runner(factories, names, batch);
+            runner.setDealCallback([&](const DealResult& result) {
+                MessageWriter out(kResult);
+                out.u64(shard).u64(result.deal).u64(result.games).u64(result.meanRank.size());
+                for (size_t i = 0; i < result.meanRank.size(); ++i) {
+                    out.f64(result.meanRank[i]).f64(result.relativeScore[i]);
+                }
+                try {
+                    connection.send(out.finish());
+                }
+                catch (const std::runtime_error&) {
+                    lost = true;   // the coordinator is done (this was a spare copy) or gone
+                }
+                return !lost;
+            });
+            runner.run();
+            if (lost) return played;
+            connection.send(MessageWriter(kShardDone).u64(shard).finish());
+            played += batch.numDeals;
+        } else if (type == kStop) {
+            return played;
+        } else {
+            throw std::runtime_error("Unexpected message");
+        }
+    }
+}
+
+} // namespace sevens
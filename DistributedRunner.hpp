@@ -0,0 +1,92 @@
+#pragma once
+
+#include "BatchRunner.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * A duplicate match spread over worker processes. The coordinator cuts the
+ * deals into shards of consecutive deal indices and hands them to whichever
+ * workers connect. Workers play their shards with a local BatchRunner and
+ * stream one compact record per deal back. Deal i is the same deck on every
+ * machine, so a shard can be played anywhere, more than once, and the result
+ * doesn't change.
+ *
+ * Addresses are "tcp:host:port" (or just "host:port") and, outside Windows,
+ * "unix:/path/to/socket".
+ */
+struct ClusterConfig {
+    std::string address;
+    uint64_t numDeals = 100;
+    uint64_t seed = 1;
+    bool duplicate = true;
+    uint64_t shardDeals = 1000;      // deals per shard
+    double shardTimeoutSeconds = 60; // then the shard is also given to an idle worker
+    std::string journalPath;         // optional: record finished shards there and skip them on resume
+};
+
+struct ClusterStats {
+    uint64_t workers = 0;        // connections that sent a hello
+    uint64_t lostWorkers = 0;    // disconnected with shards in flight
+    uint64_t reassigned = 0;     // shards handed out again (lost or slow)
+};
+
+class TournamentCoordinator {
+public:
+    /**
+     * specs are what each worker turns into strategies (library paths as the
+     * worker sees them, or "builtin:<name>"); names label the results.
+     */
+    TournamentCoordinator(std::vector<std::string> specs, std::vector<std::string> names, ClusterConfig config);
+
+    /**
+     * Serves shards until every one is done and returns the summary. Results
+     * are folded into running totals when a shard completes (the first copy
+     * to finish counts), so memory doesn't grow with the number of deals.
+     * Throws std::runtime_error on socket errors.
+     */
+    BatchSummary run();
+
+    // Called after every completed shard with the deals done so far
+    using ProgressCallback = std::function<void(uint64_t dealsDone, uint64_t numDeals)>;
+    void setProgressCallback(ProgressCallback callback);
+
+    const ClusterStats& stats() const { return clusterStats; }
+
+private:
+    std::vector<std::string> specs;
+    std::vector<std::string> names;
+    ClusterConfig config;
+    ProgressCallback onProgress;
+    ClusterStats clusterStats;
+};
+
+/**
+ * Turns the coordinator's strategy specs into factories; false rejects the job.
+ */
+using StrategySpecLoader = std::function<bool(const std::vector<std::string>& specs,
+                                              std::vector<StrategyFactory>& factories,
+                                              std::vector<std::string>& names)>;
+
+class TournamentWorker {
+public:
+    TournamentWorker(std::string address, StrategySpecLoader loader, unsigned numThreads = 0);
+
+    /**
+     * Connects (retrying for connectSeconds while the coordinator starts up),
+     * then plays shards until the coordinator says stop or goes away.
+     * Returns the number of deals played; throws std::runtime_error.
+     */
+    uint64_t run(double connectSeconds = 10.0);
+
+private:
+    std::string address;
+    StrategySpecLoader loader;
+    unsigned numThreads;
+};
+
+} // namespace sevens
@@ -0,0 +1,391 @@
+#include "EndgameTablebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace sevens {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'V', 'N', 'T', 'B', 'A', 'S', 'E'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kMaxEntries = uint64_t{1} << 32;
+constexpr uint32_t kMoveMask = 0x3F;
+constexpr int kRankBits = 3;
+
+// File header; the layout slots follow at offset sizeof(TablebaseHeader), then the entries
+struct TablebaseHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numPlayers;
+    uint64_t maxCards;
+    uint64_t numSlots;       // power of two
+    uint64_t numEntries;
+    uint64_t reserved[3];
+};
+
+// One table layout: key + 1 (0 = free slot), cards left, index of its first entry
+struct TablebaseSlot {
+    uint32_t key;
+    uint32_t cards;
+    uint64_t first;
+};
+
+static_assert(sizeof(TablebaseHeader) == 64, "slots start on a cache line");
+static_assert(sizeof(TablebaseSlot) == 16, "slot layout is part of the file format");
+
+using Hands = std::array<uint64_t, GameState::kMaxPlayers>;
+using Interval = std::array<uint8_t, 4>;
+
+// Each suit's interval as one of 7 x 7 (low, high) pairs
+uint32_t layoutKey(const Interval& low, const Interval& high) {
+    uint32_t key = 0;
+    for (int suit = 0; suit < 4; ++suit) {
+        key = key * 49 + (low[suit] - 1) * 7 + (high[suit] - 7);
+    }
+    return key;
+}
+
+uint64_t slotOf(uint32_t key, uint64_t mask) {
+    return ((key + 1) * 0x9E3779B97F4A7C15ULL >> 20) & mask;
+}
+
+uint64_t power(uint64_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    while (exponent--) result *= base;
+    return result;
+}
+
+uint32_t pack(int move, const std::array<uint8_t, GameState::kMaxPlayers>& ranks, uint64_t players) {
+    uint32_t entry = static_cast<uint32_t>(move);
+    for (uint64_t p = 0; p < players; ++p) {
+        entry |= static_cast<uint32_t>(ranks[p]) << (6 + kRankBits * p);
+    }
+    return entry;
+}
+
+void unpack(uint32_t entry, uint64_t players, EndgameTablebase::Probe& out) {
+    out.move = static_cast<int>(entry & kMoveMask);
+    out.relativeRank.fill(0);
+    for (uint64_t p = 0; p < players; ++p) {
+        out.relativeRank[p] = static_cast<uint8_t>((entry >> (6 + kRankBits * p)) & ((1u << kRankBits) - 1));
+    }
+}
+
+// Next seat after seat that still holds cards (seat itself if nobody else does)
+size_t nextHolder(const Hands& hands, size_t seat, uint64_t players) {
+    for (uint64_t step = 1; step <= players; ++step) {
+        const size_t next = (seat + step) % players;
+        if (hands[next]) return next;
+    }
+    return seat;
+}
+
+/**
+ * Read access shared by the generator (vectors being filled) and the reader
+ * (the mapped file). Lower layers are complete before a layer is solved, so
+ * workers only ever read finished entries or their own layout's.
+ */
+struct Tables {
+    const TablebaseSlot* slots;
+    uint64_t slotMask;
+    const uint32_t* entries;
+    uint64_t players;
+    uint64_t maxCards;
+
+    const TablebaseSlot* findLayout(const Interval& low, const Interval& high) const {
+        const uint32_t key = layoutKey(low, high);
+        for (uint64_t i = slotOf(key, slotMask);; i = (i + 1) & slotMask) {
+            if (slots[i].key == 0) return nullptr;
+            if (slots[i].key == key + 1) return &slots[i];
+        }
+    }
+
+    // Entry of a position, or nullptr when it isn't covered or a card has no owner
+    const uint32_t* entry(const Interval& low, const Interval& high, const Hands& hands, size_t toMove) const {
+        if (toMove >= players || !hands[toMove]) return nullptr;
+        const TablebaseSlot* layout = findLayout(low, high);
+        if (!layout) return nullptr;
+
+        uint64_t owners = 0;
+        uint64_t scale = 1;
+        for (int suit = 0; suit < 4; ++suit) {
+            for (int rank = 1; rank <= 13; ++rank) {
+                if (rank >= low[suit] && rank <= high[suit]) continue;
+                const uint64_t bit = uint64_t{1} << (suit * 13 + rank - 1);
+                uint64_t owner = 0;
+                while (owner < players && !(hands[owner] & bit)) ++owner;
+                if (owner == players) return nullptr;
+                owners += owner * scale;
+                scale *= players;
+            }
+        }
+        return &entries[layout->first + owners * players + toMove];
+    }
+
+    // Relative ranks of the players holding cards after mover lays card; false if not covered
+    bool valueAfter(Interval low, Interval high, Hands hands, size_t mover, int card,
+                    std::array<uint8_t, GameState::kMaxPlayers>& ranks) const {
+        hands[mover] &= ~(uint64_t{1} << card);
+        const int suit = card / 13;
+        const int rank = card % 13 + 1;
+        if (rank < low[suit]) low[suit] = static_cast<uint8_t>(rank);
+        else high[suit] = static_cast<uint8_t>(rank);
+
+        ranks.fill(0);
+        bool anyLeft = false;
+        for (uint64_t p = 0; p < players; ++p) anyLeft = anyLeft || hands[p];
+        if (!anyLeft) return true;   // mover laid the last card
+
+        const uint32_t* next = entry(low, high, hands, nextHolder(hands, mover, players));
+        if (!next || (*next & kMoveMask) == EndgameTablebase::kNoMove) return false;
+        EndgameTablebase::Probe probe;
+        unpack(*next, players, probe);
+        ranks = probe.relativeRank;
+        if (!hands[mover]) {
+            // Mover finished first of everyone still playing
+            for (uint64_t p = 0; p < players; ++p) {
+                if (hands[p]) ++ranks[p];
+            }
+        }
+        return true;
+    }
+};
+
+struct Layout {
+    Interval low;
+    Interval high;
+    uint64_t cards;
+    uint64_t first;
+};
+
+// Solves every owner assignment and player to move of one layout
+void solveLayout(const Layout& layout, const Tables& tables, uint32_t* out) {
+    const uint64_t players = tables.players;
+    std::vector<int> cards;
+    for (int suit = 0; suit < 4; ++suit) {
+        for (int rank = 1; rank <= 13; ++rank) {
+            if (rank < layout.low[suit] || rank > layout.high[suit]) cards.push_back(suit * 13 + rank - 1);
+        }
+    }
+    GameState table;
+    table.low = layout.low;
+    table.high = layout.high;
+    const uint64_t playable = table.playableCells();
+
+    const uint64_t assignments = power(players, cards.size());
+    std::array<uint8_t, GameState::kMaxPlayers> ranks{};
+    std::array<uint8_t, GameState::kMaxPlayers> best{};
+    for (uint64_t owners = 0; owners < assignments; ++owners) {
+        Hands hands{};
+        for (uint64_t i = 0, rest = owners; i < cards.size(); ++i, rest /= players) {
+            hands[rest % players] |= uint64_t{1} << cards[i];
+        }
+        uint32_t* entries = out + owners * players;
+
+        // Players with a card to lay only depend on the layer below
+        for (uint64_t p = 0; p < players; ++p) {
+            entries[p] = EndgameTablebase::kNoMove;
+            uint64_t moves = hands[p] & playable;
+            if (!moves) continue;
+            int bestMove = EndgameTablebase::kNoMove;
+            for (; moves; moves &= moves - 1) {
+                const int card = GameState::lowestBit(moves);
+                if (!tables.valueAfter(layout.low, layout.high, hands, p, card, ranks)) {
+                    throw std::logic_error("Tablebase successor missing");
+                }
+                if (bestMove == EndgameTablebase::kNoMove || ranks[p] < best[p]) {
+                    bestMove = card;
+                    best = ranks;
+                }
+            }
+            entries[p] = pack(bestMove, best, players);
+        }
+
+        // Someone holding cards can always lay one, so passes end at a solved entry
+        for (uint64_t p = 0; p < players; ++p) {
+            if (!hands[p] || (hands[p] & playable)) continue;
+            size_t next = nextHolder(hands, p, players);
+            while (!(hands[next] & playable)) next = nextHolder(hands, next, players);
+            entries[p] = (entries[next] & ~kMoveMask) | GameState::kPass;
+        }
+    }
+}
+
+} // namespace
+
+EndgameTablebase::EndgameTablebase(const std::string& path) : file(path) {
+    if (file.size() < sizeof(TablebaseHeader)) {
+        throw std::runtime_error(path + " is not an endgame tablebase");
+    }
+    TablebaseHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.numPlayers < 2 || header.numPlayers > GameState::kMaxPlayers) {
+        throw std::runtime_error(path + " is not an endgame tablebase");
+    }
+    if (file.size() < sizeof(TablebaseHeader) + header.numSlots * sizeof(TablebaseSlot) +
+                          header.numEntries * sizeof(uint32_t)) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    players = header.numPlayers;
+    cards = header.maxCards;
+    slotMask = header.numSlots - 1;
+    slots = file.data() + sizeof(TablebaseHeader);
+    entries = reinterpret_cast<const uint32_t*>(slots + header.numSlots * sizeof(TablebaseSlot));
+}
+
+bool EndgameTablebase::lookup(const std::array<uint8_t, 4>& low, const std::array<uint8_t, 4>& high,
+                              const std::array<uint64_t, GameState::kMaxPlayers>& hands, size_t toMove,
+                              uint32_t& entry) const {
+    const Tables tables{reinterpret_cast<const TablebaseSlot*>(slots), slotMask, entries, players, cards};
+    const uint32_t* found = tables.entry(low, high, hands, toMove);
+    if (!found || (*found & kMoveMask) == kNoMove) return false;
+    entry = *found;
+    return true;
+}
+
+bool EndgameTablebase::probe(const GameState& state, Probe& out) const {
+    if (state.numPlayers != players) return false;
+    uint32_t entry = 0;
+    if (!lookup(state.low, state.high, state.hands, state.toMove, entry)) return false;
+    unpack(entry, players, out);
+    return true;
+}
+
+bool EndgameTablebase::moveValues(const GameState& state, std::array<uint8_t, 53>& rankAfter) const {
+    Probe current;
+    if (!probe(state, current)) return false;
+    const uint64_t moves = state.legalMoves();
+    if (moves == GameState::kPassBit) {
+        rankAfter[GameState::kPass] = current.relativeRank[state.toMove];
+        return true;
+    }
+    const Tables tables{reinterpret_cast<const TablebaseSlot*>(slots), slotMask, entries, players, cards};
+    std::array<uint8_t, GameState::kMaxPlayers> ranks{};
+    for (uint64_t rest = moves; rest; rest &= rest - 1) {
+        const int card = GameState::lowestBit(rest);
+        if (!tables.valueAfter(state.low, state.high, state.hands, state.toMove, card, ranks)) return false;
+        rankAfter[card] = ranks[state.toMove];
+    }
+    return true;
+}
+
+TablebaseStats EndgameTablebase::generate(const std::string& path, const TablebaseConfig& config) {
+    const uint64_t players = config.numPlayers;
+    if (players < 2 || players > GameState::kMaxPlayers) {
+        throw std::invalid_argument("Tablebase player count must be 2 to 8");
+    }
+
+    // Every table layout with 1..maxCards cards left, fewest first
+    std::vector<std::vector<Layout>> layers(config.maxCards + 1);
+    for (uint32_t code = 0; code < 49u * 49u * 49u * 49u; ++code) {
+        Layout layout{};
+        for (int suit = 3, rest = static_cast<int>(code); suit >= 0; --suit, rest /= 49) {
+            layout.low[suit] = static_cast<uint8_t>(rest % 49 / 7 + 1);
+            layout.high[suit] = static_cast<uint8_t>(rest % 7 + 7);
+            layout.cards += (layout.low[suit] - 1) + (13 - layout.high[suit]);
+        }
+        if (layout.cards >= 1 && layout.cards <= config.maxCards) layers[layout.cards].push_back(layout);
+    }
+
+    TablebaseStats stats;
+    for (auto& layer : layers) {
+        for (auto& layout : layer) {
+            layout.first = stats.entries;
+            stats.entries += power(players, layout.cards + 1);
+            if (stats.entries > kMaxEntries) {
+                throw std::overflow_error("Tablebase too large; lower the card count");
+            }
+            ++stats.configurations;
+        }
+    }
+
+    uint64_t numSlots = 1;
+    while (numSlots < stats.configurations * 2) numSlots *= 2;
+    std::vector<TablebaseSlot> slots(numSlots, TablebaseSlot{0, 0, 0});
+    for (const auto& layer : layers) {
+        for (const auto& layout : layer) {
+            const uint32_t key = layoutKey(layout.low, layout.high);
+            uint64_t i = slotOf(key, numSlots - 1);
+            while (slots[i].key != 0) i = (i + 1) & (numSlots - 1);
+            slots[i] = TablebaseSlot{key + 1, static_cast<uint32_t>(layout.cards), layout.first};
+        }
+    }
+    std::vector<uint32_t> entries(stats.entries, kNoMove);
+    const Tables tables{slots.data(), numSlots - 1, entries.data(), players, config.maxCards};
+
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // A layer only reads the layers below it; its layouts are independent
+    for (const auto& layer : layers) {
+        std::atomic<size_t> nextLayout{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto worker = [&]() {
+            try {
+                for (size_t i = nextLayout.fetch_add(1); i < layer.size(); i = nextLayout.fetch_add(1)) {
+                    solveLayout(layer[i], tables, entries.data() + layer[i].first);
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+                nextLayout.store(layer.size());
+            }
+        };
+        std::vector<std::thread> threads;
+        const unsigned layerThreads = static_cast<unsigned>(std::min<size_t>(numThreads, std::max<size_t>(1, layer.size())));
+        for (unsigned t = 0; t < layerThreads; ++t) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    TablebaseHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.numPlayers = static_cast<uint32_t>(players);
+    header.maxCards = config.maxCards;
+    header.numSlots = numSlots;
+    header.numEntries = stats.entries;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(numSlots * sizeof(TablebaseSlot)));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(uint32_t)));
+    if (!out) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    stats.bytes = sizeof(header) + numSlots * sizeof(TablebaseSlot) + entries.size() * sizeof(uint32_t);
+    return stats;
+}
+
+std::shared_ptr<const EndgameTablebase> EndgameTablebase::shared(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const EndgameTablebase>> tablebases;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& tablebase = tablebases[path];
+    if (!tablebase) tablebase = std::make_shared<const EndgameTablebase>(path);
+    return tablebase;
+}
+
+} // namespace sevens
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "MappedFile.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace sevens {
+
+struct TablebaseConfig {
+    uint64_t numPlayers = 4;
+    uint64_t maxCards = 5;      // positions with at most this many cards left in all hands
+    unsigned numThreads = 0;    // 0 = one worker per hardware thread
+};
+
+struct TablebaseStats {
+    uint64_t configurations = 0;   // table layouts
+    uint64_t entries = 0;          // layouts x card owners x player to move
+    uint64_t bytes = 0;
+};
+
+/**
+ * Solved endgames: for every table layout with few cards left, every way the
+ * remaining cards can be spread over the players and every player to move,
+ * the best move and the order in which the players holding cards finish.
+ *
+ * Positions are solved with all hands known, everyone playing a card whenever
+ * they have a playable one (as GameState's legal moves), and each player
+ * choosing the move that finishes them earliest (max^n; ties go to the lowest
+ * card). Under those rules a round without plays can't happen, so the
+ * deadlock rule never matters.
+ *
+ * Layout: a header, an open-addressed table from table layout to the layout's
+ * first entry, and one uint32 per position: the move in the low 6 bits and a
+ * 3-bit relative rank per player above them. A position's entry is found with
+ * one hash probe and an index computation, straight from the mapped file.
+ */
+class EndgameTablebase {
+public:
+    static constexpr int kNoMove = 63;
+
+    struct Probe {
+        int move = kNoMove;                                        // card index or GameState::kPass
+        std::array<uint8_t, GameState::kMaxPlayers> relativeRank{}; // 0 = first of the players holding cards
+    };
+
+    // Maps a tablebase file; throws std::runtime_error
+    explicit EndgameTablebase(const std::string& path);
+
+    uint64_t numPlayers() const { return players; }
+    uint64_t maxCards() const { return cards; }
+
+    // Value of the position; false when it isn't covered (more cards left, other table size)
+    bool probe(const GameState& state, Probe& out) const;
+
+    /**
+     * Relative rank (among the players holding cards now) the player to move
+     * ends up with after each of their legal moves, indexed by card or kPass.
+     * False when the position isn't covered.
+     */
+    bool moveValues(const GameState& state, std::array<uint8_t, 53>& rankAfter) const;
+
+    // Solves every position of the configuration on all cores and writes the file
+    static TablebaseStats generate(const std::string& path, const TablebaseConfig& config);
+
+    // One tablebase per path for the whole process
+    static std::shared_ptr<const EndgameTablebase> shared(const std::string& path);
+
+private:
+    bool lookup(const std::array<uint8_t, 4>& low, const std::array<uint8_t, 4>& high,
+                const std::array<uint64_t, GameState::kMaxPlayers>& hands, size_t toMove,
+                uint32_t& entry) const;
+
+    MappedFile file;
+    uint64_t players = 0;
+    uint64_t cards = 0;
+    uint64_t slotMask = 0;
+    const uint8_t* slots = nullptr;
+    const uint32_t* entries = nullptr;
+};
+
+} // namespace sevens
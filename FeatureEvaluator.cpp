@@ -0,0 +1,295 @@
+#include "FeatureEvaluator.hpp"
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace sevens {
+
+namespace {
+
+const char* const kFeatureNames[kNumFeatures] = {
+    "seven",
+    "early_seven",
+    "early_chain",
+    "early_neighbor",
+    "early_edge",
+    "mid_chain",
+    "mid_long_suit",
+    "mid_edge",
+    "late_suit_count",
+    "late_suit_left",
+    "suit_playability",
+    "opens_both_ends",
+    "opponents_blocked",
+    "edge_combo",
+    "own_unlocks",
+    "opponent_unlocks",
+};
+
+} // namespace
+
+const char* featureName(size_t feature) {
+    return feature < kNumFeatures ? kFeatureNames[feature] : "unknown";
+}
+
+int chainLength(const FeatureContext& context, int suit, int rank) {
+    int length = 1;
+    for (int r = rank - 1; r >= 1 && context.inHand[suit][r]; --r) ++length;
+    for (int r = rank + 1; r <= 13 && context.inHand[suit][r]; ++r) ++length;
+    return length;
+}
+
+namespace {
+
+// Suit playability and game phase, once hand and table are filled in
+void completeContext(FeatureContext& context) {
+    int played = 0;
+    for (int suit = 0; suit < 4; ++suit) {
+        int covered = 0;
+        int openEnds = 0;
+        for (int r = 1; r <= 13; ++r) {
+            if (!context.onTable[suit][r]) continue;
+            ++covered;
+            if ((r > 1 && !context.onTable[suit][r - 1]) || (r < 13 && !context.onTable[suit][r + 1])) {
+                ++openEnds;
+            }
+        }
+        context.playedInSuit[suit] = covered > 0 && context.onTable[suit][7] ? covered - 1 : covered;
+        played += context.playedInSuit[suit];
+        context.suitPlayability[suit] = covered >= 10 || openEnds >= 3 ? 2 : (openEnds >= 1 ? 1 : 0);
+    }
+    context.phase = played < 10 ? 0 : (played < 30 ? 1 : 2);
+}
+
+} // namespace
+
+FeatureContext tableContext(const std::vector<Card>& hand,
+                            const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout)
+{
+    FeatureContext context;
+    for (const auto& c : hand) {
+        context.inHand[c.suit][c.rank] = true;
+        context.suitCount[c.suit]++;
+    }
+    for (const auto& [suit, ranks] : tableLayout) {
+        if (suit > 3) continue;
+        for (const auto& [rank, present] : ranks) {
+            if (present && rank >= 1 && rank <= 13) context.onTable[suit][rank] = true;
+        }
+    }
+    completeContext(context);
+    return context;
+}
+
+FeatureContext maskContext(uint64_t hand, uint64_t table) {
+    FeatureContext context;
+    for (int suit = 0; suit < 4; ++suit) {
+        for (int rank = 1; rank <= 13; ++rank) {
+            const int bit = suit * 13 + rank - 1;
+            context.inHand[suit][rank] = (hand >> bit) & 1;
+            context.onTable[suit][rank] = (table >> bit) & 1;
+            context.suitCount[suit] += context.inHand[suit][rank];
+        }
+    }
+    completeContext(context);
+    return context;
+}
+
+FeatureWeights FeatureWeights::defaults() {
+    FeatureWeights w;
+    w.weights[FeatSeven] = 200;
+    w.weights[FeatEarlySeven] = 100;
+    w.weights[FeatEarlyChain] = 30;
+    w.weights[FeatEarlyNeighbor] = 70;
+    w.weights[FeatEarlyEdge] = 20;
+    w.weights[FeatMidChain] = 50;
+    w.weights[FeatMidLongSuit] = 60;
+    w.weights[FeatMidEdge] = 40;
+    w.weights[FeatLateSuitCount] = 50;
+    w.weights[FeatLateSuitLeft] = 10;
+    w.weights[FeatSuitPlayability] = 40;
+    w.weights[FeatOpensBothEnds] = -80;
+    w.weights[FeatOpponentsBlocked] = 30;
+    w.weights[FeatEdgeCombo] = 80;
+    w.weights[FeatOwnUnlocks] = 0;
+    w.weights[FeatOpponentUnlocks] = 0;
+    return w;
+}
+
+std::shared_ptr<const FeatureWeights> FeatureWeights::load(const std::string& path) {
+    static std::mutex cacheMutex;
+    static std::unordered_map<std::string, std::shared_ptr<const FeatureWeights>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(path);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot read weight file: " + path);
+    }
+
+    auto loaded = std::make_shared<FeatureWeights>(defaults());
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string name;
+        float value;
+        if (!(fields >> name)) continue;
+        if (!(fields >> value)) {
+            throw std::runtime_error("Missing weight for " + name + " in " + path);
+        }
+
+        size_t feature = 0;
+        while (feature < kNumFeatures && name != kFeatureNames[feature]) ++feature;
+        if (feature == kNumFeatures) {
+            throw std::runtime_error("Unknown feature " + name + " in " + path);
+        }
+        loaded->weights[feature] = value;
+    }
+
+    cache[path] = loaded;
+    return loaded;
+}
+
+void FeatureWeights::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write weight file: " + path);
+    }
+    out << "# Sevens card evaluation weights: <feature> <weight>\n";
+    for (size_t f = 0; f < kNumFeatures; ++f) {
+        out << kFeatureNames[f] << " " << weights[f] << "\n";
+    }
+}
+
+size_t CandidateBatch::add(const FeatureContext& context, const Card& card) {
+    if (count == kMaxCandidates) {
+        throw std::length_error("Too many candidates for one decision");
+    }
+    const size_t c = count++;
+    const int suit = card.suit;
+    const int rank = card.rank;
+    const bool early = context.phase == 0;
+    const bool mid = context.phase == 1;
+    const bool late = context.phase == 2;
+
+    const bool seven = rank == 7;
+    const bool edge = rank == 1 || rank == 13;
+    const bool lowerInHand = rank > 1 && context.inHand[suit][rank - 1];
+    const bool upperInHand = rank < 13 && context.inHand[suit][rank + 1];
+    const int chain = chainLength(context, suit, rank);
+
+    // Cells that become playable once this card is on the table
+    int ownUnlocks = 0;
+    int opponentUnlocks = 0;
+    for (int next : {rank - 1, rank + 1}) {
+        if (next < 1 || next > 13 || context.onTable[suit][next]) continue;
+        if (context.inHand[suit][next]) ++ownUnlocks;
+        else ++opponentUnlocks;
+    }
+
+    rows[FeatSeven][c] = seven;
+    rows[FeatEarlySeven][c] = early && seven;
+    rows[FeatEarlyChain][c] = early ? static_cast<float>(chain) : 0.0f;
+    rows[FeatEarlyNeighbor][c] = early && (lowerInHand || upperInHand);
+    rows[FeatEarlyEdge][c] = early && edge;
+    rows[FeatMidChain][c] = mid ? static_cast<float>(chain) : 0.0f;
+    rows[FeatMidLongSuit][c] = mid && context.suitCount[suit] >= 3;
+    rows[FeatMidEdge][c] = mid && edge;
+    rows[FeatLateSuitCount][c] = late ? static_cast<float>(context.suitCount[suit]) : 0.0f;
+    rows[FeatLateSuitLeft][c] = late ? static_cast<float>(13 - context.playedInSuit[suit]) : 0.0f;
+    rows[FeatSuitPlayability][c] = static_cast<float>(context.suitPlayability[suit]);
+    rows[FeatOpensBothEnds][c] = rank > 1 && rank < 13 &&
+                                 context.onTable[suit][rank - 1] && context.onTable[suit][rank + 1];
+    rows[FeatOpponentsBlocked][c] = context.opponentsBlocked;
+    rows[FeatEdgeCombo][c] = (rank == 1 && upperInHand) || (rank == 13 && lowerInHand);
+    rows[FeatOwnUnlocks][c] = static_cast<float>(ownUnlocks);
+    rows[FeatOpponentUnlocks][c] = static_cast<float>(opponentUnlocks);
+    return c;
+}
+
+void CandidateBatch::score(const FeatureWeights& w, float* scores) const {
+#if defined(__AVX__)
+    for (size_t c = 0; c < count; c += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(w.weights[f]),
+                                                   _mm256_load_ps(&rows[f][c])));
+        }
+        _mm256_storeu_ps(scores + c, acc);
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    for (size_t c = 0; c < count; c += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w.weights[f]), _mm_load_ps(&rows[f][c])));
+        }
+        _mm_storeu_ps(scores + c, acc);
+    }
+#else
+    for (size_t c = 0; c < count; ++c) {
+        float acc = 0.0f;
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            acc += w.weights[f] * rows[f][c];
+        }
+        scores[c] = acc;
+    }
+#endif
+}
+
+int CandidateBatch::best(const FeatureWeights& weights) const {
+    if (count == 0) return -1;
+    float scores[kMaxCandidates];
+    score(weights, scores);
+    int best = 0;
+    for (size_t c = 1; c < count; ++c) {
+        if (scores[c] > scores[best]) best = static_cast<int>(c);
+    }
+    return best;
+}
+
+void CandidateBatch::weightedSum(const float* p, float* out) const {
+#if defined(__AVX__)
+    for (size_t f = 0; f < kNumFeatures; ++f) {
+        __m256 acc = _mm256_setzero_ps();
+        for (size_t c = 0; c < count; c += 8) {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(p + c), _mm256_load_ps(&rows[f][c])));
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, acc);
+        out[f] = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    for (size_t f = 0; f < kNumFeatures; ++f) {
+        __m128 acc = _mm_setzero_ps();
+        for (size_t c = 0; c < count; c += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p + c), _mm_load_ps(&rows[f][c])));
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc);
+        out[f] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+#else
+    for (size_t f = 0; f < kNumFeatures; ++f) {
+        float acc = 0.0f;
+        for (size_t c = 0; c < count; ++c) {
+            acc += p[c] * rows[f][c];
+        }
+        out[f] = acc;
+    }
+#endif
+}
+
+} // namespace sevens
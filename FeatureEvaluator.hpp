@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Generic_card_parser.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Features describing one candidate card. Phase-gated features are 0 outside
+ * their phase, which lets a single linear model express phase-dependent play.
+ */
+enum Feature : size_t {
+    FeatSeven,            // the card is a 7
+    FeatEarlySeven,       // early game and a 7
+    FeatEarlyChain,       // early game x length of the run of own cards through it
+    FeatEarlyNeighbor,    // early game and an own card next to it
+    FeatEarlyEdge,        // early game and an ace or king
+    FeatMidChain,         // mid game x run length
+    FeatMidLongSuit,      // mid game and 3+ own cards of the suit
+    FeatMidEdge,          // mid game and an ace or king
+    FeatLateSuitCount,    // late game x own cards of the suit
+    FeatLateSuitLeft,     // late game x ranks of the suit not yet seen played
+    FeatSuitPlayability,  // 0 (blocked) .. 2 (open) for the suit
+    FeatOpensBothEnds,    // the card sits between two table cards
+    FeatOpponentsBlocked, // some opponent looks stuck from repeated passes
+    FeatEdgeCombo,        // ace with own 2, or king with own queen
+    FeatOwnUnlocks,       // own cards made playable by this card
+    FeatOpponentUnlocks,  // newly playable cards that are not in the own hand
+    kNumFeatures
+};
+
+const char* featureName(size_t feature);
+
+struct FeatureContext;
+
+// Length of the run of own cards through (suit, rank), the card itself included
+int chainLength(const FeatureContext& context, int suit, int rank);
+
+/**
+ * Everything the features are computed from, flattened once per decision.
+ * Indices are [suit][rank] with ranks 1..13.
+ */
+struct FeatureContext {
+    int phase = 0;                       // 0 early, 1 mid, 2 late
+    bool inHand[4][15] = {};
+    bool onTable[4][15] = {};
+    int suitCount[4] = {};               // own cards per suit
+    int playedInSuit[4] = {};            // cards seen played per suit
+    int suitPlayability[4] = {};
+    bool opponentsBlocked = false;
+};
+
+/**
+ * Context seen by a player who only looks at the hand and the table (no
+ * observed passes): the phase counts the cards played beyond the 7s, and suit
+ * playability follows the same open-ends rule as YuriaStrategy.
+ */
+FeatureContext tableContext(const std::vector<Card>& hand,
+                            const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout);
+
+// The same context from GameState bitmasks (bit suit * 13 + rank - 1), for engines without the maps
+FeatureContext maskContext(uint64_t hand, uint64_t table);
+
+/**
+ * Linear model over the features. The defaults reproduce the hand-tuned
+ * scores YuriaStrategy used before it was feature based.
+ */
+struct FeatureWeights {
+    alignas(32) std::array<float, kNumFeatures> weights{};
+
+    static FeatureWeights defaults();
+
+    /**
+     * Reads a text file of "<feature name> <weight>" lines ('#' starts a comment).
+     * Features the file does not mention keep their default weight. Files are
+     * cached per path, so every instance loading the same file shares one copy.
+     * Throws std::runtime_error if the file can't be read or names an unknown feature.
+     */
+    static std::shared_ptr<const FeatureWeights> load(const std::string& path);
+
+    void save(const std::string& path) const;
+};
+
+/**
+ * Feature matrix for all candidates of one decision, stored feature-major
+ * (one row per feature, one column per candidate) so that scoring is a
+ * vertical SIMD multiply-add over rows: 8 candidates per AVX instruction.
+ */
+class CandidateBatch {
+public:
+    static constexpr size_t kMaxCandidates = 56;   // 52 cards rounded up to a vector multiple
+
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+
+    // Fills the next column with the features of card; returns its column
+    size_t add(const FeatureContext& context, const Card& card);
+
+    float feature(size_t candidate, size_t feature) const { return rows[feature][candidate]; }
+
+    // scores[c] = weights . features of candidate c, for all candidates at once.
+    // scores must have room for kMaxCandidates values (whole vectors are stored).
+    void score(const FeatureWeights& weights, float* scores) const;
+
+    // Column of the best score (first one on ties), or -1 when empty
+    int best(const FeatureWeights& weights) const;
+
+    // out[f] = sum over candidates c of p[c] * feature f of c (e.g. the expected
+    // features under a policy). p must hold kMaxCandidates values, 0 past size().
+    void weightedSum(const float* p, float* out) const;
+
+private:
+    alignas(32) float rows[kNumFeatures][kMaxCandidates] = {};
+    size_t count = 0;
+};
+
+} // namespace sevens
@@ -0,0 +1,460 @@
+#pragma once
+
+#include "BatchRunner.hpp"
+#include "Deck.hpp"
+#include "GameEventLog.hpp"
+#include "GameState.hpp"
+#include "Metrics.hpp"
+#include "ResultStats.hpp"
+#include "StrategyRegistry.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Seat for a strategy only known at runtime (a loaded library), so that the
+ * GameEngine loop can run it too, at one virtual call per decision.
+ * A strategy that reads the event log gets it directly. For any other
+ * strategy, the events since its last turn are replayed as observe callbacks
+ * right before it decides, which is the first point where it could act on them.
+ */
+class DynamicStrategy final : public PlayerStrategy, public EventLogReader, public SeatNamesReader {
+public:
+    static constexpr const char* kName = "DynamicStrategy";
+
+    void reset(std::shared_ptr<PlayerStrategy> strategy) {
+        inner = std::move(strategy);
+        reader = dynamic_cast<EventLogReader*>(inner.get());
+        namesReader = dynamic_cast<SeatNamesReader*>(inner.get());
+    }
+
+    void setSeatNames(const std::vector<std::string>& names) override {
+        if (namesReader) namesReader->setSeatNames(names);
+    }
+
+    void attachEventLog(const GameEventLog* log) override {
+        if (reader) {
+            reader->attachEventLog(log);
+        } else {
+            pending.attach(log);
+        }
+    }
+
+    void initialize(uint64_t playerID) override {
+        myID = playerID;
+        inner->initialize(playerID);
+    }
+
+    int selectCardToPlay(
+        const std::vector<Card>& hand,
+        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) override
+    {
+        pending.catchUp([this](const GameEvent& event) {
+            if (event.playerID == myID) return;
+            if (event.pass) {
+                inner->observePass(event.playerID);
+            } else {
+                inner->observeMove(event.playerID, event.card);
+            }
+        });
+        return inner->selectCardToPlay(hand, tableLayout);
+    }
+
+    void observeMove(uint64_t playerID, const Card& playedCard) override {
+        inner->observeMove(playerID, playedCard);
+    }
+
+    void observePass(uint64_t playerID) override {
+        inner->observePass(playerID);
+    }
+
+    std::string getName() const override {
+        return inner->getName();
+    }
+
+private:
+    std::shared_ptr<PlayerStrategy> inner;
+    EventLogReader* reader = nullptr;
+    SeatNamesReader* namesReader = nullptr;
+    EventCursor pending;
+    uint64_t myID = 0;
+};
+
+/**
+ * Game loop specialised at compile time for a fixed lineup of strategy types.
+ *
+ * The strategies are held by value and called through their concrete (final)
+ * type with a qualified call, so a turn costs no virtual dispatch, no
+ * shared_ptr and no strategy lookup, and the compiler is free to inline the
+ * decision into the loop. Dealing and rules are the same as MyGameMapper, so a
+ * deal seed gives the same game in both engines. Libraries loaded at runtime
+ * keep using MyGameMapper.
+ */
+template <typename... Strategies>
+class GameEngine {
+public:
+    static constexpr size_t kPlayers = sizeof...(Strategies);
+    static_assert(kPlayers >= 1, "GameEngine needs at least one strategy");
+    static_assert(kPlayers <= GameState::kMaxPlayers, "GameEngine seats at most GameState::kMaxPlayers");
+    static_assert((std::is_final_v<Strategies> && ...),
+                  "GameEngine strategies must be final so that calls are direct");
+
+    // seating[seat] = index of the strategy (in the lineup) sitting there
+    using Seating = std::array<size_t, kPlayers>;
+    // ranks[i] = finishing rank of lineup strategy i
+    using Ranks = std::array<uint64_t, kPlayers>;
+
+    GameEngine() = default;
+
+    template <size_t I>
+    auto& strategy() { return std::get<I>(strategies); }
+
+    // Turns, passes and ranks per seat of the last game (strategy[] = lineup index)
+    const GameRecord& lastGame() const { return record; }
+
+    // Strategy time is measured on one decision in `every` (1 = every decision)
+    void setTimingSample(uint64_t every) { timingSample = (std::max<uint64_t>)(every, 1); }
+
+    Ranks playGame(const Deck& deck, const Seating& seating) {
+        resetTable();
+        // Same dealing as MyGameMapper: deck order, skipping the 7s already on the table
+        dealCards(deck, kPlayers, hands.data());
+        return play(seating);
+    }
+
+    // Plays already dealt hands (dealtHands[seat]); the 7s start on the table as usual
+    Ranks playGame(const std::array<std::vector<Card>, kPlayers>& dealtHands, const Seating& seating) {
+        resetTable();
+        for (size_t seat = 0; seat < kPlayers; ++seat) {
+            hands[seat].assign(dealtHands[seat].begin(), dealtHands[seat].end());
+        }
+        return play(seating);
+    }
+
+    /**
+     * Same contract as BatchRunner::playDeal. Result index u refers to lineup
+     * strategy order[u], so callers can report in their own order.
+     */
+    DealResult playDeal(uint64_t deal, uint64_t seed, bool duplicate, const Seating& order,
+                        StatsShard* stats = nullptr) {
+        const Deck deck = Deck::shuffled(BatchRunner::dealSeed(seed, deal));
+
+        // The tally's seating holds result indices; the engine seats lineup strategies
+        DealTally tally(deal, kPlayers, duplicate, stats);
+        do {
+            Seating seating;
+            for (size_t seat = 0; seat < kPlayers; ++seat) seating[seat] = order[tally.seating()[seat]];
+            playGame(deck, seating);
+        } while (tally.addGame(record));
+        return tally.finish();
+    }
+
+private:
+    using TableLayout = std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>;
+
+    static constexpr bool kAnyReadsNames = (std::is_base_of_v<SeatNamesReader, Strategies> || ...);
+
+    // Game loop over the current hands
+    Ranks play(const Seating& seating) {
+        const auto gameStart = std::chrono::steady_clock::now();
+        uint64_t strategyNanos = 0;
+        events.clear();
+        if constexpr (kAnyReadsNames) {
+            for (size_t seat = 0; seat < kPlayers; ++seat) {
+                visit(seating[seat], [this, seat](auto& s) {
+                    using S = std::decay_t<decltype(s)>;
+                    seatNames[seat] = s.S::getName();
+                });
+            }
+        }
+        for (size_t seat = 0; seat < kPlayers; ++seat) {
+            visit(seating[seat], [this, seat](auto& s) {
+                using S = std::decay_t<decltype(s)>;
+                if constexpr (std::is_base_of_v<EventLogReader, S>) {
+                    s.S::attachEventLog(&events);
+                }
+                if constexpr (std::is_base_of_v<SeatNamesReader, S>) {
+                    s.S::setSeatNames(seatNames);
+                }
+                s.S::initialize(seat);
+            });
+        }
+
+        std::array<uint64_t, GameState::kMaxPlayers> masks{};
+        for (size_t seat = 0; seat < kPlayers; ++seat) {
+            for (const Card& card : hands[seat]) masks[seat] |= GameState::cardBit(card);
+        }
+        GameState state = GameState::start(kPlayers, masks);
+        uint64_t turns = 0;
+        uint64_t passes = 0;
+
+        while (!state.over) {
+            const size_t seat = state.toMove;
+            auto& hand = hands[seat];
+            int index = -1;
+            // Only every timingSample-th decision reads the clock; its time stands for all of them
+            const bool timed = ++decisions % timingSample == 0;
+            const auto decisionStart = timed ? std::chrono::steady_clock::now()
+                                             : std::chrono::steady_clock::time_point{};
+            visit(seating[seat], [&](auto& s) {
+                using S = std::decay_t<decltype(s)>;
+                index = s.S::selectCardToPlay(hand, table);
+            });
+            if (timed) {
+                strategyNanos += timingSample * std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - decisionStart
+                ).count();
+            }
+            ++turns;
+
+            // An out-of-range or illegal answer counts as a pass
+            if (index < 0 || index >= static_cast<int>(hand.size()) || !state.isPlayable(hand[index])) {
+                ++passes;
+                state.apply(GameState::kPass);
+                recordEvent(seating, GameEvent{seat, Card{0, 0}, true});
+                continue;
+            }
+
+            const Card card = hand[index];
+            table[card.suit][card.rank] = true;
+            hand.erase(hand.begin() + index);
+            state.apply(GameState::cardIndex(card));
+            recordEvent(seating, GameEvent{seat, card, false});
+        }
+
+        const bool deadlocked = state.finishedCount < kPlayers;
+        Ranks ranks{};
+        record.numPlayers = kPlayers;
+        record.turns = turns;
+        record.passes = passes;
+        record.deadlocked = deadlocked;
+        for (size_t seat = 0; seat < kPlayers; ++seat) {
+            ranks[seating[seat]] = state.rank(seat);
+            record.rank[seat] = ranks[seating[seat]];
+            record.strategy[seat] = seating[seat];
+        }
+
+        const uint64_t gameNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - gameStart
+        ).count();
+        ThreadCounters& counters = Metrics::local();
+        counters.add(counters.gamesPlayed, 1);
+        counters.add(counters.turns, turns);
+        counters.add(counters.passes, passes);
+        counters.add(counters.strategyCalls, turns);
+        counters.add(counters.deadlockedGames, deadlocked ? 1 : 0);
+        counters.add(counters.strategyNanos, strategyNanos);
+        counters.add(counters.engineNanos, gameNanos > strategyNanos ? gameNanos - strategyNanos : 0);
+        return ranks;
+    }
+
+    // Calls f on lineup strategy `index` with its concrete type
+    template <typename F>
+    void visit(size_t index, F&& f) {
+        visitImpl(index, f, std::index_sequence_for<Strategies...>{});
+    }
+
+    template <typename F, size_t... Is>
+    void visitImpl(size_t index, F& f, std::index_sequence<Is...>) {
+        ((index == Is ? (void)f(std::get<Is>(strategies)) : (void)0), ...);
+    }
+
+    // Back to the starting layout, reusing the map nodes of the previous game
+    void resetTable() {
+        for (int suit = 0; suit < 4; ++suit) {
+            for (int rank = 1; rank <= 13; ++rank) {
+                table[suit][rank] = (rank == 7);
+            }
+        }
+    }
+
+    // Logs a turn; strategies that don't read the log get the observe callbacks
+    // (compiled out for the ones that do, and inlined to nothing for empty ones)
+    void recordEvent(const Seating& seating, const GameEvent& event) {
+        events.append(event);
+        for (size_t seat = 0; seat < kPlayers; ++seat) {
+            if (seat == event.playerID) continue;
+            visit(seating[seat], [&event](auto& s) {
+                using S = std::decay_t<decltype(s)>;
+                if constexpr (!std::is_base_of_v<EventLogReader, S>) {
+                    if (event.pass) {
+                        s.S::observePass(event.playerID);
+                    } else {
+                        s.S::observeMove(event.playerID, event.card);
+                    }
+                }
+            });
+        }
+    }
+
+    std::tuple<Strategies...> strategies;
+    std::array<std::vector<Card>, kPlayers> hands;
+    // The layout handed to strategies; the rules themselves run on a GameState
+    TableLayout table;
+    GameEventLog events;
+    GameRecord record;
+    std::vector<std::string> seatNames = std::vector<std::string>(kPlayers);
+    uint64_t timingSample = BatchConfig{}.timingSample;
+    uint64_t decisions = 0;   // decisions played by this engine, for the timing sample
+};
+
+/**
+ * Plays config.numDeals deals of one lineup on all cores, each worker with its
+ * own engine (and so its own strategy instances).
+ */
+template <typename Engine>
+std::vector<DealResult> runEngineDeals(const BatchConfig& config, const typename Engine::Seating& order) {
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = (std::max)(1u, std::thread::hardware_concurrency());
+    }
+    if (config.numDeals < numThreads) {
+        numThreads = static_cast<unsigned>((std::max<uint64_t>)(1, config.numDeals));
+    }
+
+    std::vector<DealResult> results(config.numDeals);
+    std::atomic<uint64_t> nextDeal{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            auto engine = std::make_unique<Engine>();
+            engine->setTimingSample(config.timingSample);
+            StatsShard* shard = config.stats ? &config.stats->claimShard() : nullptr;
+            for (uint64_t deal = nextDeal.fetch_add(1); deal < config.numDeals;
+                 deal = nextDeal.fetch_add(1)) {
+                results[deal] = engine->playDeal(deal, config.seed, config.duplicate, order, shard);
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            nextDeal.store(config.numDeals);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+// Largest built-in table the dispatcher below instantiates engines for
+constexpr size_t kMaxBuiltinSeats = 4;
+
+/**
+ * Maps a lineup chosen at runtime onto a GameEngine instantiation.
+ * Only sorted lineups are instantiated (a table of k seats needs one engine
+ * per multiset of built-ins, not per ordering); the caller's order is
+ * restored through GameEngine::playDeal's order argument.
+ */
+template <typename Chosen>
+struct BuiltinLineup;
+
+template <size_t... Chosen>
+struct BuiltinLineup<std::index_sequence<Chosen...>> {
+    static constexpr size_t depth = sizeof...(Chosen);
+    static constexpr size_t last = (std::max)({size_t(0), Chosen...});
+
+    static std::vector<DealResult> run(const std::vector<size_t>& sorted,
+                                       const std::vector<size_t>& order,
+                                       const BatchConfig& config)
+    {
+        if constexpr (depth > 0) {
+            if (sorted.size() == depth) {
+                using Engine = GameEngine<BuiltinStrategy<Chosen>...>;
+                typename Engine::Seating seating;
+                std::copy(order.begin(), order.end(), seating.begin());
+                return runEngineDeals<Engine>(config, seating);
+            }
+        }
+        if constexpr (depth < kMaxBuiltinSeats) {
+            return extend(sorted, order, config, std::make_index_sequence<BuiltinStrategies::size>{});
+        } else {
+            throw std::invalid_argument("Too many seats for the built-in engine");
+        }
+    }
+
+    template <size_t... Next>
+    static std::vector<DealResult> extend(const std::vector<size_t>& sorted,
+                                          const std::vector<size_t>& order,
+                                          const BatchConfig& config,
+                                          std::index_sequence<Next...>)
+    {
+        std::vector<DealResult> results;
+        (extendWith<Next>(sorted, order, config, results), ...);
+        return results;
+    }
+
+    template <size_t Next>
+    static void extendWith(const std::vector<size_t>& sorted,
+                           const std::vector<size_t>& order,
+                           const BatchConfig& config,
+                           std::vector<DealResult>& results)
+    {
+        if constexpr (depth == 0 || Next >= last) {
+            if (sorted[depth] == Next) {
+                results = BuiltinLineup<std::index_sequence<Chosen..., Next>>::run(sorted, order, config);
+            }
+        }
+    }
+};
+
+/**
+ * Runs a batch between built-in strategies (by kName) on the devirtualized engine.
+ * Throws std::invalid_argument for unknown names or more than kMaxBuiltinSeats seats.
+ */
+inline BatchSummary runBuiltinBatch(const std::vector<std::string>& names, const BatchConfig& config) {
+    if (names.empty() || names.size() > kMaxBuiltinSeats) {
+        throw std::invalid_argument("The built-in engine plays 1 to " +
+                                    std::to_string(kMaxBuiltinSeats) + " strategies");
+    }
+
+    std::vector<size_t> indices;
+    for (const auto& name : names) {
+        size_t index = builtinIndex(name);
+        if (index == BuiltinStrategies::size) {
+            throw std::invalid_argument("Unknown built-in strategy: " + name);
+        }
+        indices.push_back(index);
+    }
+
+    // order[u] = position in the sorted lineup of the u-th requested strategy
+    std::vector<size_t> byType(names.size());
+    std::iota(byType.begin(), byType.end(), 0);
+    std::stable_sort(byType.begin(), byType.end(),
+                     [&](size_t a, size_t b) { return indices[a] < indices[b]; });
+    std::vector<size_t> sorted(names.size());
+    std::vector<size_t> order(names.size());
+    for (size_t position = 0; position < byType.size(); ++position) {
+        sorted[position] = indices[byType[position]];
+        order[byType[position]] = position;
+    }
+
+    return BatchRunner::summarize(BuiltinLineup<std::index_sequence<>>::run(sorted, order, config), names);
+}
+
+} // namespace sevens
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Generic_card_parser.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sevens {
+
+// One turn of a game: a card played, or a pass
+struct GameEvent {
+    uint64_t playerID;
+    Card card;        // meaningless for a pass
+    bool pass;
+};
+
+/**
+ * Append-only history of the current game, owned by the engine. Strategies
+ * only ever see it as const and read it through an EventCursor, so one log
+ * serves every player instead of each keeping its own copy of the history.
+ */
+class GameEventLog {
+public:
+    void clear() { events.clear(); }
+    void append(const GameEvent& event) { events.push_back(event); }
+    void reserve(size_t count) { events.reserve(count); }
+
+    size_t size() const { return events.size(); }
+    const GameEvent& operator[](size_t index) const { return events[index]; }
+
+private:
+    std::vector<GameEvent> events;
+};
+
+/**
+ * Read position in a GameEventLog. Positions are indices, so a cursor stays
+ * valid while the log grows.
+ */
+class EventCursor {
+public:
+    void attach(const GameEventLog* log) {
+        events = log;
+        position = 0;
+    }
+    bool attached() const { return events != nullptr; }
+
+    // Calls onEvent for every event appended since the last call
+    template <typename F>
+    void catchUp(F&& onEvent) {
+        if (!events) return;
+        for (; position < events->size(); ++position) {
+            onEvent((*events)[position]);
+        }
+    }
+
+private:
+    const GameEventLog* events = nullptr;
+    size_t position = 0;
+};
+
+/**
+ * Optional interface for strategies that read the shared log. Engines attach
+ * the log before initialize() and then skip observeMove/observePass for the
+ * strategy; strategies without it keep getting the callbacks. Kept separate
+ * from PlayerStrategy so existing libraries stay binary compatible.
+ */
+class EventLogReader {
+public:
+    virtual ~EventLogReader() = default;
+    virtual void attachEventLog(const GameEventLog* log) = 0;
+};
+
+} // namespace sevens
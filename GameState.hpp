@@ -0,0 +1,202 @@
+#pragma once
+
+#include "Generic_card_parser.hpp"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace sevens {
+
+/**
+ * Position of a game as a small value type, cheap to copy for search and
+ * rollouts, and the rules every engine plays by.
+ *
+ * Cards are indexed suit * 13 + rank - 1 and hands are bitmasks of them.
+ * Because the 7s start on the table and every card is laid next to one
+ * already there, each suit's table is the interval low..high around 7.
+ * Turn order: seats in order, finished players skipped; the game ends when
+ * everyone has finished or a round (seat 0 to the last seat) passes without
+ * a card being played. Players still holding cards then rank in seat order.
+ */
+struct GameState {
+    static constexpr size_t kMaxPlayers = 8;
+    static constexpr int kPass = 52;
+    static constexpr uint64_t kPassBit = uint64_t{1} << kPass;
+    static constexpr uint64_t kAllCards = (uint64_t{1} << 52) - 1;
+
+    std::array<uint64_t, kMaxPlayers> hands{};
+    std::array<uint8_t, 4> low{{7, 7, 7, 7}};
+    std::array<uint8_t, 4> high{{7, 7, 7, 7}};
+    std::array<uint8_t, kMaxPlayers> finishOrder{};
+    uint8_t numPlayers = 0;
+    uint8_t toMove = 0;
+    uint8_t finishedCount = 0;
+    uint8_t finished = 0;        // bit per seat
+    bool changed = false;        // a card was played in the current round
+    bool over = false;
+
+    // What apply() changed besides the card itself, for undo()
+    struct Undo {
+        uint8_t toMove;
+        uint8_t finishedCount;
+        uint8_t finished;
+        bool changed;
+        bool over;
+    };
+
+    static int cardIndex(const Card& card) { return card.suit * 13 + card.rank - 1; }
+    static Card cardAt(int index) { return Card{index / 13, index % 13 + 1}; }
+    static uint64_t cardBit(const Card& card) { return uint64_t{1} << cardIndex(card); }
+
+    // Bit helpers for card masks, with plain loops where the builtins are missing
+    static int popCount(uint64_t mask) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(mask);
+#else
+        int count = 0;
+        for (; mask; mask &= mask - 1) ++count;
+        return count;
+#endif
+    }
+
+    // Index of the lowest set bit (mask != 0)
+    static int lowestBit(uint64_t mask) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(mask);
+#else
+        int index = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    // Index of the n-th set bit (n < popCount(mask))
+    static int nthBit(uint64_t mask, int n) {
+        for (; n > 0; --n) mask &= mask - 1;
+        return lowestBit(mask);
+    }
+
+    // Start of a game with the given hands (numPlayers <= kMaxPlayers)
+    static GameState start(size_t numPlayers, const std::array<uint64_t, kMaxPlayers>& dealt) {
+        GameState state;
+        state.numPlayers = static_cast<uint8_t>(numPlayers);
+        state.hands = dealt;
+        return state;
+    }
+
+    // Table from a bitmask of cards, which must form intervals around the 7s
+    void setTable(uint64_t table) {
+        for (int suit = 0; suit < 4; ++suit) {
+            int l = 7;
+            int h = 7;
+            while (l > 1 && (table >> (suit * 13 + l - 2)) & 1) --l;
+            while (h < 13 && (table >> (suit * 13 + h)) & 1) ++h;
+            low[suit] = static_cast<uint8_t>(l);
+            high[suit] = static_cast<uint8_t>(h);
+        }
+    }
+
+    bool onTable(int suit, int rank) const { return rank >= low[suit] && rank <= high[suit]; }
+
+    uint64_t tableMask() const {
+        uint64_t mask = 0;
+        for (int suit = 0; suit < 4; ++suit) {
+            mask |= ((uint64_t{1} << (high[suit] - low[suit] + 1)) - 1) << (suit * 13 + low[suit] - 1);
+        }
+        return mask;
+    }
+
+    // Cards that may be laid now, whoever holds them
+    uint64_t playableCells() const {
+        uint64_t mask = 0;
+        for (int suit = 0; suit < 4; ++suit) {
+            if (low[suit] > 1) mask |= uint64_t{1} << (suit * 13 + low[suit] - 2);
+            if (high[suit] < 13) mask |= uint64_t{1} << (suit * 13 + high[suit]);
+        }
+        return mask;
+    }
+
+    bool isPlayable(const Card& card) const {
+        return card.rank == low[card.suit] - 1 || card.rank == high[card.suit] + 1;
+    }
+
+    // Moves of the player to move: playable cards in hand, or only the pass when there are none
+    uint64_t legalMoves() const {
+        const uint64_t moves = playableCells() & hands[toMove];
+        return moves ? moves : kPassBit;
+    }
+
+    bool isFinished(size_t seat) const { return (finished >> seat) & 1u; }
+
+    Undo apply(int move) {
+        const Undo undo{toMove, finishedCount, finished, changed, over};
+        if (move != kPass) {
+            hands[toMove] &= ~(uint64_t{1} << move);
+            const int suit = move / 13;
+            const int rank = move % 13 + 1;
+            if (rank < low[suit]) low[suit] = static_cast<uint8_t>(rank);
+            else high[suit] = static_cast<uint8_t>(rank);
+            changed = true;
+            if (!hands[toMove]) {
+                finished |= static_cast<uint8_t>(1u << toMove);
+                finishOrder[finishedCount++] = toMove;
+            }
+        }
+        advance();
+        return undo;
+    }
+
+    void undo(int move, const Undo& undo) {
+        if (move != kPass) {
+            hands[undo.toMove] |= uint64_t{1} << move;
+            const int suit = move / 13;
+            const int rank = move % 13 + 1;
+            if (rank < 7) low[suit] = static_cast<uint8_t>(rank + 1);
+            else high[suit] = static_cast<uint8_t>(rank - 1);
+        }
+        if (finishedCount != undo.finishedCount) finishOrder[undo.finishedCount] = 0;
+        toMove = undo.toMove;
+        finishedCount = undo.finishedCount;
+        finished = undo.finished;
+        changed = undo.changed;
+        over = undo.over;
+    }
+
+    // Finishing rank (1 = first); for unfinished seats, the rank they get if the game ends now
+    uint64_t rank(size_t seat) const {
+        for (size_t i = 0; i < finishedCount; ++i) {
+            if (finishOrder[i] == seat) return i + 1;
+        }
+        uint64_t r = finishedCount + 1;
+        for (size_t s = 0; s < seat; ++s) {
+            if (!isFinished(s)) ++r;
+        }
+        return r;
+    }
+
+private:
+    // Next seat still playing, or the end of the game
+    void advance() {
+        do {
+            if (finishedCount == numPlayers) {
+                over = true;
+                return;
+            }
+            if (++toMove == numPlayers) {
+                toMove = 0;
+                if (!changed) {
+                    over = true;
+                    return;
+                }
+                changed = false;
+            }
+        } while (isFinished(toMove));
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>, "GameState must stay a plain value");
+
+} // namespace sevens
@@ -34,7 +34,7 @@ void GreedyStrategy::observePass(uint64_t /*playerID*/) {
 }
 
 std::string GreedyStrategy::getName() const {
-    return "GreedyStrategy";
+    return kName;
 }
 
 } // namespace sevens
@@ -7,8 +7,10 @@ namespace sevens {
 /**
  * A (placeholder) greedy strategy skeleton.
  */
-class GreedyStrategy : public PlayerStrategy {
+class GreedyStrategy final : public PlayerStrategy {
 public:
+    static constexpr const char* kName = "GreedyStrategy";
+
     GreedyStrategy() = default;
     ~GreedyStrategy() override = default;
     
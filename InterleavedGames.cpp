@@ -0,0 +1,240 @@
+#include "InterleavedGames.hpp"
+#include "Deck.hpp"
+#include "GameEventLog.hpp"
+#include "GameState.hpp"
+#include "Metrics.hpp"
+#include "ResultStats.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace sevens {
+
+struct InterleavedGames::Slot {
+    std::vector<std::shared_ptr<PlayerStrategy>> players;   // by strategy index
+    std::vector<DecideBatchFn> entryPoints;                 // by strategy index; nullptr = one call per decision
+    bool busy = false;
+
+    // Deal being played
+    DealTally tally{0, 0, true};
+    Deck deck{};
+
+    // Game being played
+    GameState state;
+    std::vector<std::vector<Card>> hands;
+    std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>> table;
+    GameEventLog events;
+    std::vector<std::pair<uint64_t, PlayerStrategy*>> observers;
+    std::vector<std::string> seatNames;
+    std::array<uint64_t, GameState::kMaxPlayers> versions{};
+    uint64_t turns = 0;
+    uint64_t passes = 0;
+};
+
+InterleavedGames::InterleavedGames(const std::vector<StrategyFactory>& factories, size_t numSlots,
+                                   uint64_t seed, bool duplicate, StatsShard* stats)
+    : numStrategies(factories.size()), seed(seed), duplicate(duplicate), stats(stats)
+{
+    if (numStrategies == 0 || numStrategies > GameState::kMaxPlayers) {
+        throw std::invalid_argument("Sevens is played by 1 to " +
+                                    std::to_string(GameState::kMaxPlayers) + " players");
+    }
+    for (size_t i = 0; i < std::max<size_t>(1, numSlots); ++i) {
+        auto slot = std::make_unique<Slot>();
+        for (const auto& factory : factories) {
+            slot->players.push_back(factory());
+            auto* decider = dynamic_cast<BatchDecider*>(slot->players.back().get());
+            slot->entryPoints.push_back(decider ? decider->batchEntryPoint() : nullptr);
+        }
+        slot->hands.resize(numStrategies);
+        slot->seatNames.resize(numStrategies);
+        slots.push_back(std::move(slot));
+    }
+}
+
+InterleavedGames::~InterleavedGames() = default;
+
+void InterleavedGames::start(uint64_t deal) {
+    auto it = std::find_if(slots.begin(), slots.end(), [](const auto& slot) { return !slot->busy; });
+    if (it == slots.end()) {
+        throw std::logic_error("InterleavedGames::start without a free slot");
+    }
+    Slot& slot = **it;
+    slot.busy = true;
+    ++running;
+
+    slot.tally = DealTally(deal, numStrategies, duplicate, stats);
+    slot.deck = Deck::shuffled(BatchRunner::dealSeed(seed, deal));
+    for (const auto& player : slot.players) {
+        if (auto* listener = dynamic_cast<DealListener*>(player.get())) listener->beginDeal(deal);
+    }
+    startGame(slot);
+}
+
+void InterleavedGames::startGame(Slot& slot) {
+    const size_t n = numStrategies;
+
+    // Same dealing as MyGameMapper: deck order, skipping the 7s already on the table
+    dealCards(slot.deck, n, slot.hands.data());
+    for (int suit = 0; suit < 4; ++suit) {
+        for (int rank = 1; rank <= 13; ++rank) {
+            slot.table[suit][rank] = (rank == 7);
+        }
+    }
+    slot.state = GameState::start(n, dealHands(slot.deck, n));
+    slot.events.clear();
+    slot.observers.clear();
+    slot.versions.fill(0);
+    slot.turns = 0;
+    slot.passes = 0;
+
+    const std::vector<size_t>& seating = slot.tally.seating();
+    for (size_t seat = 0; seat < n; ++seat) {
+        slot.seatNames[seat] = slot.players[seating[seat]]->getName();
+    }
+    for (size_t seat = 0; seat < n; ++seat) {
+        PlayerStrategy* player = slot.players[seating[seat]].get();
+        if (auto* namesReader = dynamic_cast<SeatNamesReader*>(player)) {
+            namesReader->setSeatNames(slot.seatNames);
+        }
+        if (auto* reader = dynamic_cast<EventLogReader*>(player)) {
+            reader->attachEventLog(&slot.events);
+        } else {
+            slot.observers.emplace_back(seat, player);
+        }
+        player->initialize(seat);
+        if (auto* versioned = dynamic_cast<VersionedStrategy*>(player)) {
+            slot.versions[seat] = versioned->strategyVersion();
+        }
+    }
+}
+
+void InterleavedGames::step(std::vector<DealResult>& finished) {
+    // Games share a step, so time is split per step: decisions, and everything else
+    const auto stepStart = std::chrono::steady_clock::now();
+    pending.clear();
+    owners.clear();
+    entryPoints.clear();
+    for (const auto& slot : slots) {
+        if (!slot->busy) continue;
+        const uint64_t seat = slot->state.toMove;
+        const size_t s = slot->tally.seating()[seat];
+        pending.push_back(PendingDecision{slot->players[s].get(), seat, &slot->hands[seat], &slot->table,
+                                          slot->state.hands[seat], slot->state.tableMask()});
+        owners.push_back(slot.get());
+        entryPoints.push_back(slot->entryPoints[s]);
+    }
+
+    // One call per entry point, with its decisions in slot order; the rest one by one
+    moves.assign(pending.size(), -1);
+    decided.assign(pending.size(), 0);
+    const auto decisionsStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (decided[i]) continue;
+        const DecideBatchFn entryPoint = entryPoints[i];
+        if (!entryPoint) {
+            moves[i] = pending[i].strategy->selectCardToPlay(*pending[i].hand, *pending[i].tableLayout);
+            continue;
+        }
+        group.clear();
+        groupIndex.clear();
+        for (size_t j = i; j < pending.size(); ++j) {
+            if (decided[j] || entryPoints[j] != entryPoint) continue;
+            group.push_back(pending[j]);
+            groupIndex.push_back(j);
+            decided[j] = 1;
+        }
+        groupMoves.assign(group.size(), -1);
+        {
+            TraceSpan span("decideBatch", "decision", "decisions", group.size());
+            entryPoint(group.data(), groupMoves.data(), group.size());
+        }
+        for (size_t g = 0; g < group.size(); ++g) {
+            moves[groupIndex[g]] = groupMoves[g];
+        }
+    }
+
+    const auto decisionsEnd = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (apply(*owners[i], moves[i])) {
+            finishGame(*owners[i], finished);
+        }
+    }
+
+    const auto stepEnd = std::chrono::steady_clock::now();
+    const uint64_t strategyNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        decisionsEnd - decisionsStart
+    ).count();
+    const uint64_t engineNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        (decisionsStart - stepStart) + (stepEnd - decisionsEnd)
+    ).count();
+    ThreadCounters& counters = Metrics::local();
+    counters.add(counters.strategyCalls, pending.size());
+    counters.add(counters.strategyNanos, strategyNanos);
+    counters.add(counters.engineNanos, engineNanos);
+}
+
+bool InterleavedGames::apply(Slot& slot, int index) {
+    const uint64_t seat = slot.state.toMove;
+    auto& hand = slot.hands[seat];
+    ++slot.turns;
+
+    // An out-of-range or illegal answer counts as a pass
+    GameEvent event{seat, Card{0, 0}, true};
+    if (index >= 0 && index < static_cast<int>(hand.size()) && slot.state.isPlayable(hand[index])) {
+        const Card card = hand[index];
+        slot.table[card.suit][card.rank] = true;
+        hand.erase(hand.begin() + index);
+        slot.state.apply(GameState::cardIndex(card));
+        event = GameEvent{seat, card, false};
+    } else {
+        ++slot.passes;
+        slot.state.apply(GameState::kPass);
+    }
+
+    slot.events.append(event);
+    for (const auto& [id, observer] : slot.observers) {
+        if (id == event.playerID) continue;
+        if (event.pass) {
+            observer->observePass(event.playerID);
+        } else {
+            observer->observeMove(event.playerID, event.card);
+        }
+    }
+    return slot.state.over;
+}
+
+void InterleavedGames::finishGame(Slot& slot, std::vector<DealResult>& finished) {
+    const size_t n = numStrategies;
+    const bool deadlocked = slot.state.finishedCount < n;
+    GameRecord record;
+    record.numPlayers = n;
+    record.turns = slot.turns;
+    record.passes = slot.passes;
+    record.deadlocked = deadlocked;
+    record.version = slot.versions;
+    for (size_t seat = 0; seat < n; ++seat) {
+        record.rank[seat] = slot.state.rank(seat);
+    }
+
+    ThreadCounters& counters = Metrics::local();
+    counters.add(counters.gamesPlayed, 1);
+    counters.add(counters.turns, slot.turns);
+    counters.add(counters.passes, slot.passes);
+    counters.add(counters.deadlockedGames, deadlocked ? 1 : 0);
+
+    if (slot.tally.addGame(record)) {
+        startGame(slot);
+        return;
+    }
+    finished.push_back(slot.tally.finish());
+    slot.busy = false;
+    --running;
+}
+
+} // namespace sevens
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "BatchRunner.hpp"
+#include "PlayerStrategy.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sevens {
+
+class StatsShard;
+
+/**
+ * Several deals in play at once on one thread, advanced a turn at a time in
+ * all of them, so that the decisions pending across the games can be handed
+ * to a strategy library together (BatchDecider) instead of one virtual call
+ * each. Decisions for strategies without a batch entry point, or whose
+ * wrapper hides it (a reloading seat), are still asked one by one.
+ *
+ * Every slot has its own strategy instances and plays its deal the same way
+ * as BatchRunner::playDeal (the same Deck and dealing, seatings and scoring
+ * through DealTally), so a run gives the same results whatever the number
+ * of slots.
+ */
+class InterleavedGames {
+public:
+    InterleavedGames(const std::vector<StrategyFactory>& factories, size_t numSlots,
+                     uint64_t seed, bool duplicate, StatsShard* stats = nullptr);
+    ~InterleavedGames();
+
+    InterleavedGames(const InterleavedGames&) = delete;
+    InterleavedGames& operator=(const InterleavedGames&) = delete;
+
+    bool hasFreeSlot() const { return running < slots.size(); }
+    bool idle() const { return running == 0; }
+
+    // Starts a deal in a free slot (hasFreeSlot() must be true)
+    void start(uint64_t deal);
+
+    // One decision in every running game; deals that ended are appended to finished
+    void step(std::vector<DealResult>& finished);
+
+private:
+    struct Slot;
+
+    void startGame(Slot& slot);
+    // Applies a decision; true if the game ended with it
+    bool apply(Slot& slot, int index);
+    // Records a game that ended and starts the next seating, or closes the deal
+    void finishGame(Slot& slot, std::vector<DealResult>& finished);
+
+    size_t numStrategies;
+    uint64_t seed;
+    bool duplicate;
+    StatsShard* stats;
+    std::vector<std::unique_ptr<Slot>> slots;
+    size_t running = 0;
+
+    // Scratch of step(), kept to avoid allocating every turn
+    std::vector<PendingDecision> pending;
+    std::vector<Slot*> owners;
+    std::vector<DecideBatchFn> entryPoints;
+    std::vector<char> decided;
+    std::vector<int> moves;
+    std::vector<PendingDecision> group;
+    std::vector<size_t> groupIndex;
+    std::vector<int> groupMoves;
+};
+
+} // namespace sevens
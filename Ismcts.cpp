@@ -0,0 +1,396 @@
+#include "Ismcts.hpp"
+#include "Deck.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace sevens {
+
+namespace {
+
+constexpr uint32_t kNone = UINT32_MAX;
+constexpr uint64_t kAllCards = GameState::kAllCards;
+
+// Aces and kings of every suit, to stop neighbour shifts crossing suits
+constexpr uint64_t kAces = 0x0008004002001ULL;
+constexpr uint64_t kKings = kAces << 12;
+constexpr uint64_t kSevens = kAces << 6;
+
+struct Node {
+    uint32_t parent;
+    uint32_t firstChild;
+    uint32_t nextSibling;
+    uint32_t visits;
+    uint32_t available;
+    uint8_t move;       // card index or kPass
+    uint8_t player;     // who made the move leading here
+    float reward;       // summed over visits, for player
+    uint64_t childMoves;
+};
+
+// Score of a finished game for player: 1 for first place down to 0 for last
+float reward(const GameState& s, uint8_t player) {
+    return static_cast<float>(s.numPlayers - s.rank(player)) / static_cast<float>(s.numPlayers - 1);
+}
+
+} // namespace
+
+// One thread's tree, with its pool and the spare pool used for compaction
+struct IsmctsSearch::Tree {
+    std::vector<Node> pool;
+    std::vector<Node> spare;
+    std::vector<std::pair<uint32_t, uint32_t>> queue;
+    std::vector<uint32_t> path;
+    uint32_t used = 0;
+    uint32_t root = kNone;
+    std::mt19937_64 rng;
+    uint64_t iterations = 0;
+
+    Tree(size_t capacity, uint64_t seed) : pool(capacity), spare(capacity), rng(seed) {
+        path.reserve(64);
+    }
+
+    uint32_t allocate(uint32_t parent, uint8_t move, uint8_t player) {
+        const uint32_t index = used++;
+        pool[index] = Node{parent, kNone, kNone, 0, 0, move, player, 0.0f, 0};
+        if (parent != kNone) {
+            pool[index].nextSibling = pool[parent].firstChild;
+            pool[parent].firstChild = index;
+            pool[parent].childMoves |= uint64_t{1} << move;
+        }
+        return index;
+    }
+
+    bool full() const { return used == pool.size(); }
+
+    uint32_t child(uint32_t node, int move) const {
+        for (uint32_t c = pool[node].firstChild; c != kNone; c = pool[c].nextSibling) {
+            if (pool[c].move == move) return c;
+        }
+        return kNone;
+    }
+
+    // Moves the subtree under root to the front of the pool; returns its size
+    uint32_t compact() {
+        spare[0] = pool[root];
+        spare[0].parent = kNone;
+        spare[0].firstChild = kNone;
+        uint32_t next = 1;
+        queue.clear();
+        queue.emplace_back(root, 0);
+        for (size_t q = 0; q < queue.size(); ++q) {
+            const auto [from, to] = queue[q];
+            uint32_t previous = kNone;
+            for (uint32_t c = pool[from].firstChild; c != kNone; c = pool[c].nextSibling) {
+                const uint32_t copy = next++;
+                spare[copy] = pool[c];
+                spare[copy].parent = to;
+                spare[copy].firstChild = kNone;
+                spare[copy].nextSibling = kNone;
+                if (previous == kNone) {
+                    spare[to].firstChild = copy;
+                } else {
+                    spare[previous].nextSibling = copy;
+                }
+                previous = copy;
+                queue.emplace_back(c, copy);
+            }
+        }
+        pool.swap(spare);
+        used = next;
+        root = 0;
+        return next;
+    }
+
+    void search(const GameState& start,
+                const std::array<uint64_t, kMaxPlayers>& need,
+                const std::array<uint64_t, kMaxPlayers>& notHeld,
+                uint64_t unknown,
+                double exploration,
+                std::chrono::steady_clock::time_point deadline,
+                bool timed,
+                uint64_t maxIterations)
+    {
+        int unknownCards[52];
+        int numUnknown = 0;
+        for (uint64_t m = unknown; m; m &= m - 1) unknownCards[numUnknown++] = GameState::lowestBit(m);
+
+        for (uint64_t done = 0; maxIterations == 0 || done < maxIterations; ++done) {
+            if (timed && (done & 63) == 0 && std::chrono::steady_clock::now() >= deadline) break;
+
+            GameState s = start;
+            determinize(s, need, notHeld, unknownCards, numUnknown);
+
+            // Selection and expansion
+            uint32_t node = root;
+            path.clear();
+            while (!s.over) {
+                const uint64_t legal = s.legalMoves();
+                const uint64_t untried = legal & ~pool[node].childMoves;
+                if (untried) {
+                    if (full()) break;
+                    const int move = GameState::nthBit(untried, static_cast<int>(rng() % GameState::popCount(untried)));
+                    node = allocate(node, static_cast<uint8_t>(move), s.toMove);
+                    path.push_back(node);
+                    s.apply(move);
+                    break;
+                }
+
+                uint32_t best = kNone;
+                double bestScore = -1.0;
+                for (uint32_t c = pool[node].firstChild; c != kNone; c = pool[c].nextSibling) {
+                    Node& n = pool[c];
+                    if (!(legal & (uint64_t{1} << n.move))) continue;
+                    ++n.available;
+                    const double score = n.reward / n.visits +
+                        exploration * std::sqrt(std::log(static_cast<double>(n.available)) / n.visits);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        best = c;
+                    }
+                }
+                node = best;
+                path.push_back(node);
+                s.apply(pool[node].move);
+            }
+
+            // Random playout
+            while (!s.over) {
+                const uint64_t legal = s.legalMoves();
+                s.apply(GameState::nthBit(legal, static_cast<int>(rng() % GameState::popCount(legal))));
+            }
+
+            ++pool[root].visits;
+            for (uint32_t n : path) {
+                ++pool[n].visits;
+                pool[n].reward += reward(s, pool[n].player);
+            }
+            ++iterations;
+        }
+    }
+
+    /**
+     * Deals the unknown cards to the opponents. Cards an opponent is known not
+     * to hold go elsewhere; if that keeps failing the constraint is dropped.
+     */
+    void determinize(GameState& s,
+                     const std::array<uint64_t, kMaxPlayers>& need,
+                     const std::array<uint64_t, kMaxPlayers>& notHeld,
+                     int* cards, int numCards)
+    {
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            const bool constrained = attempt < 7;
+            std::array<uint64_t, kMaxPlayers> left = need;
+            std::array<uint64_t, kMaxPlayers> hands = s.hands;
+            bool ok = true;
+            for (int i = numCards - 1; i >= 0 && ok; --i) {
+                std::swap(cards[i], cards[rng() % (i + 1)]);
+                const uint64_t bit = uint64_t{1} << cards[i];
+                uint64_t total = 0;
+                for (size_t p = 0; p < s.numPlayers; ++p) {
+                    if (left[p] && !(constrained && (notHeld[p] & bit))) total += left[p];
+                }
+                if (total == 0) {
+                    ok = false;
+                    break;
+                }
+                uint64_t pick = rng() % total;
+                for (size_t p = 0; p < s.numPlayers; ++p) {
+                    if (!left[p] || (constrained && (notHeld[p] & bit))) continue;
+                    if (pick < left[p]) {
+                        hands[p] |= bit;
+                        --left[p];
+                        break;
+                    }
+                    pick -= left[p];
+                }
+            }
+            if (ok) {
+                s.hands = hands;
+                return;
+            }
+        }
+    }
+};
+
+SearchConfig SearchConfig::fromEnvironment() {
+    SearchConfig config;
+    auto read = [](const char* name, auto& value) {
+        const char* text = std::getenv(name);
+        if (!text || !*text) return;
+        try {
+            value = static_cast<std::decay_t<decltype(value)>>(std::stod(text));
+        }
+        catch (const std::exception&) {
+            // Malformed values keep the default
+        }
+    };
+    double megabytes = static_cast<double>(config.memoryBytes >> 20);
+    read("SEVENS_YURIA_SEARCH_MS", config.timeMs);
+    read("SEVENS_YURIA_SEARCH_ITERATIONS", config.iterations);
+    read("SEVENS_YURIA_SEARCH_THREADS", config.threads);
+    read("SEVENS_YURIA_SEARCH_MB", megabytes);
+    config.memoryBytes = static_cast<size_t>(std::max(1.0, megabytes) * (1 << 20));
+    config.threads = std::max(1u, config.threads);
+    return config;
+}
+
+uint64_t IsmctsSearch::playableCells(uint64_t table) {
+    const uint64_t neighbours = ((table & ~kKings) << 1) | ((table & ~kAces) >> 1);
+    return (neighbours | kSevens) & ~table & kAllCards;
+}
+
+IsmctsSearch::IsmctsSearch(SearchConfig config) : config(config) {
+    // Half of each thread's share is the spare pool used for compaction
+    const size_t perTree = std::max<size_t>(1024, config.memoryBytes / config.threads / 2 / sizeof(Node));
+    std::random_device seeder;
+    for (unsigned t = 0; t < config.threads; ++t) {
+        const uint64_t seed = (static_cast<uint64_t>(seeder()) << 32) ^ seeder();
+        trees.push_back(std::make_unique<Tree>(std::min<size_t>(perTree, kNone - 1), seed));
+    }
+}
+
+IsmctsSearch::~IsmctsSearch() = default;
+
+void IsmctsSearch::newGame(uint64_t playerID) {
+    myID = playerID;
+    seenPlayers = playerID + 1;
+    numPlayers = 0;
+    tableFromEvents = kSevens;
+    played.fill(0);
+    notHeld.fill(0);
+    lastPlayAt.fill(0);
+    eventCount = 0;
+    lastEventPlayer = 0;
+    roundChanged = false;
+    for (auto& tree : trees) tree->root = kNone;
+}
+
+void IsmctsSearch::observe(const GameEvent& event) {
+    if (event.playerID >= kMaxPlayers) return;
+    seenPlayers = std::max(seenPlayers, event.playerID + 1);
+
+    // Events of one round come in seat order
+    if (eventCount > 0 && event.playerID <= lastEventPlayer) roundChanged = false;
+    lastEventPlayer = event.playerID;
+    ++eventCount;
+
+    int move = kPass;
+    if (event.pass) {
+        // Whoever passes holds none of the cards that were playable
+        notHeld[event.playerID] |= playableCells(tableFromEvents);
+    } else {
+        move = event.card.suit * 13 + event.card.rank - 1;
+        tableFromEvents |= uint64_t{1} << move;
+        ++played[event.playerID];
+        lastPlayAt[event.playerID] = eventCount;
+        roundChanged = true;
+    }
+
+    // Keep the subtree of the move actually made
+    for (auto& tree : trees) {
+        if (tree->root != kNone) tree->root = tree->child(tree->root, move);
+    }
+}
+
+GameState IsmctsSearch::rootPosition(uint64_t hand, uint64_t table) const {
+    const uint64_t n = numPlayers;
+    GameState root;
+    root.numPlayers = static_cast<uint8_t>(n);
+    root.setTable(table);
+    root.toMove = static_cast<uint8_t>(myID);
+    root.changed = roundChanged;
+    root.hands[myID] = hand;
+
+    // Players out of cards, ranked in the order they finished
+    std::vector<std::pair<uint64_t, size_t>> finishedOrder;
+    for (size_t p = 0; p < n; ++p) {
+        if (p != myID && played[p] >= handSize(n, p)) {
+            finishedOrder.emplace_back(lastPlayAt[p], p);
+        }
+    }
+    std::sort(finishedOrder.begin(), finishedOrder.end());
+    for (const auto& [at, p] : finishedOrder) {
+        root.finished |= static_cast<uint8_t>(1u << p);
+        root.finishOrder[root.finishedCount++] = static_cast<uint8_t>(p);
+    }
+    return root;
+}
+
+int IsmctsSearch::chooseMove(uint64_t hand, uint64_t table) {
+    stats = Stats{};
+    const uint64_t legal = playableCells(table) & hand;
+    if (!legal) return kPass;
+    if (myID >= kMaxPlayers) return -1;
+
+    if (numPlayers == 0) {
+        // The first hand size tells the table size
+        const uint64_t initial = static_cast<uint64_t>(GameState::popCount(hand)) + played[myID];
+        for (uint64_t n = std::max<uint64_t>(2, seenPlayers); n <= kMaxPlayers && numPlayers == 0; ++n) {
+            if (handSize(n, myID) == initial) numPlayers = n;
+        }
+        if (numPlayers == 0) return -1;
+    }
+    if (seenPlayers > numPlayers) return -1;
+
+    // Cards the player can't see must add up to the opponents' hands
+    std::array<uint64_t, kMaxPlayers> need{};
+    uint64_t needed = 0;
+    for (size_t p = 0; p < numPlayers; ++p) {
+        if (p == myID) continue;
+        const uint64_t size = handSize(numPlayers, p);
+        need[p] = played[p] < size ? size - played[p] : 0;
+        needed += need[p];
+    }
+    const uint64_t unknown = kAllCards & ~table & ~hand;
+    if (static_cast<uint64_t>(GameState::popCount(unknown)) != needed) return -1;
+
+    const GameState root = rootPosition(hand, table);
+
+    // Reuse what is left of each tree, or start a new one
+    for (auto& tree : trees) {
+        if (tree->root != kNone) {
+            stats.reusedNodes += tree->compact();
+        } else {
+            tree->used = 0;
+            tree->root = tree->allocate(kNone, 0, 0);
+        }
+        tree->iterations = 0;
+    }
+
+    const bool timed = config.timeMs > 0.0;
+    const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(static_cast<int64_t>(config.timeMs * 1000.0));
+    const uint64_t perTree = config.iterations ? std::max<uint64_t>(1, config.iterations / trees.size()) : 0;
+    auto run = [&](Tree& tree) {
+        tree.search(root, need, notHeld, unknown, config.exploration, deadline, timed, perTree);
+    };
+
+    std::vector<std::thread> helpers;
+    for (size_t t = 1; t < trees.size(); ++t) {
+        helpers.emplace_back(run, std::ref(*trees[t]));
+    }
+    run(*trees[0]);
+    for (auto& helper : helpers) helper.join();
+
+    // Most visited root move over all trees
+    std::array<uint64_t, 53> visits{};
+    for (const auto& tree : trees) {
+        for (uint32_t c = tree->pool[tree->root].firstChild; c != kNone; c = tree->pool[c].nextSibling) {
+            visits[tree->pool[c].move] += tree->pool[c].visits;
+        }
+        stats.iterations += tree->iterations;
+        stats.nodes += tree->used;
+    }
+    int best = GameState::lowestBit(legal);
+    for (uint64_t m = legal; m; m &= m - 1) {
+        const int move = GameState::lowestBit(m);
+        if (visits[move] > visits[best]) best = move;
+    }
+    return best;
+}
+
+} // namespace sevens
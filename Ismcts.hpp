@@ -0,0 +1,102 @@
+#pragma once
+
+#include "GameEventLog.hpp"
+#include "GameState.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Search budget. The search runs until timeMs or iterations is reached,
+ * whichever comes first (0 = no limit on that one); with both 0 it is off.
+ */
+struct SearchConfig {
+    double timeMs = 0.0;
+    uint64_t iterations = 0;
+    unsigned threads = 1;              // independent trees merged at the root
+    size_t memoryBytes = 64 << 20;     // node pools of all threads together
+    double exploration = 0.7;
+
+    bool enabled() const { return timeMs > 0.0 || iterations > 0; }
+
+    // SEVENS_YURIA_SEARCH_MS, _ITERATIONS, _THREADS and _MB; unset values keep the defaults
+    static SearchConfig fromEnvironment();
+};
+
+/**
+ * Single-observer information-set MCTS for one seat.
+ *
+ * Every iteration deals the cards the player can't see to the opponents (with
+ * the right hand sizes, and never a card an opponent passed on while it was
+ * playable), then walks one tree shared by all such deals: UCB over the
+ * moves legal in this deal, weighted by how often each was available.
+ *
+ * Nodes live in a fixed pool per thread, so a search never allocates and the
+ * memory budget is a hard cap (the tree stops growing when it is full). With
+ * several threads each grows its own tree and root visit counts are summed.
+ * Between decisions the subtree reached by the moves actually played is kept
+ * and compacted to the front of the pool.
+ */
+class IsmctsSearch {
+public:
+    static constexpr int kPass = GameState::kPass;
+    static constexpr size_t kMaxPlayers = GameState::kMaxPlayers;
+
+    explicit IsmctsSearch(SearchConfig config);
+    ~IsmctsSearch();
+
+    IsmctsSearch(const IsmctsSearch&) = delete;
+    IsmctsSearch& operator=(const IsmctsSearch&) = delete;
+
+    void newGame(uint64_t playerID);
+
+    // Every move and pass of the game in order, the player's own included
+    void observe(const GameEvent& event);
+
+    /**
+     * Card to play (suit * 13 + rank - 1), kPass, or -1 when the position is not
+     * one the search models (for example a deal that isn't the standard one).
+     * hand and table are bitmasks over the same card index.
+     */
+    int chooseMove(uint64_t hand, uint64_t table);
+
+    struct Stats {
+        uint64_t iterations = 0;
+        uint64_t nodes = 0;          // in use after the last search, all threads
+        uint64_t reusedNodes = 0;    // kept from the previous decision
+    };
+    const Stats& lastStats() const { return stats; }
+    const SearchConfig& configuration() const { return config; }
+
+    // Bitmask helpers over the card index suit * 13 + rank - 1
+    static uint64_t cardBit(int suit, int rank) { return uint64_t{1} << (suit * 13 + rank - 1); }
+    static uint64_t playableCells(uint64_t table);
+
+private:
+    struct Tree;
+
+    // The searching player's position: own hand, table and who already finished
+    GameState rootPosition(uint64_t hand, uint64_t table) const;
+
+    SearchConfig config;
+    std::vector<std::unique_ptr<Tree>> trees;
+    Stats stats;
+
+    // Information set, folded from the observed events
+    uint64_t myID = 0;
+    uint64_t seenPlayers = 0;           // highest player id seen + 1
+    uint64_t numPlayers = 0;            // fixed at the first decision
+    uint64_t tableFromEvents = 0;
+    std::array<uint64_t, kMaxPlayers> played{};
+    std::array<uint64_t, kMaxPlayers> notHeld{};
+    std::array<uint64_t, kMaxPlayers> lastPlayAt{};   // event number of each player's last card
+    uint64_t eventCount = 0;
+    uint64_t lastEventPlayer = 0;
+    bool roundChanged = false;
+};
+
+} // namespace sevens
@@ -0,0 +1,184 @@
+#include "League.hpp"
+#include "BatchRunner.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace sevens {
+
+namespace {
+
+// Weng-Lin parameters: performance noise and the floor of the variance shrink factor
+constexpr double kBeta = 25.0 / 6.0;
+constexpr double kKappa = 1e-4;
+
+// Refuse pools whose combination list would not fit comfortably in memory
+constexpr uint64_t kMaxCombinations = 5000000;
+
+} // namespace
+
+League::League(std::vector<StrategyFactory> factories,
+               std::vector<std::string> names,
+               LeagueConfig config)
+    : factories(std::move(factories)), names(std::move(names)), config(config)
+{
+    const size_t n = this->factories.size();
+    if (n < 2) {
+        throw std::invalid_argument("A league needs at least two strategies");
+    }
+    if (this->names.size() != n) {
+        throw std::invalid_argument("League needs exactly one name per strategy");
+    }
+    this->config.tableSize = std::clamp<size_t>(this->config.tableSize, 2, n);
+
+    ratings.assign(n, Rating{});
+    tablesPlayed.assign(n, 0);
+    inFlight.assign(n, 0);
+
+    // Enumerate every k-subset of the pool in lexicographic order
+    const size_t k = this->config.tableSize;
+    std::vector<size_t> table(k);
+    std::iota(table.begin(), table.end(), 0);
+    while (true) {
+        if (combinationPlays.size() >= kMaxCombinations) {
+            throw std::invalid_argument("Too many table combinations, use a smaller table size");
+        }
+        for (size_t member : table) {
+            combinations.push_back(static_cast<uint16_t>(member));
+        }
+        combinationPlays.push_back(0);
+
+        size_t i = k;
+        while (i > 0 && table[i - 1] == n - k + (i - 1)) --i;
+        if (i == 0) break;
+        ++table[i - 1];
+        for (size_t j = i; j < k; ++j) table[j] = table[j - 1] + 1;
+    }
+}
+
+std::vector<size_t> League::nextTable() {
+    const size_t k = config.tableSize;
+    size_t best = 0;
+    double bestPriority = -1.0;
+
+    for (size_t c = 0; c < combinationPlays.size(); ++c) {
+        double uncertainty = 0.0;
+        for (size_t j = 0; j < k; ++j) {
+            size_t member = combinations[c * k + j];
+            uncertainty += ratings[member].sigma * ratings[member].sigma / (1.0 + inFlight[member]);
+        }
+        // Tables never played come first, so every combination is covered
+        double priority = uncertainty + (combinationPlays[c] == 0 ? 1e9 : 0.0);
+        if (priority > bestPriority) {
+            bestPriority = priority;
+            best = c;
+        }
+    }
+
+    ++combinationPlays[best];
+    return std::vector<size_t>(combinations.begin() + best * k,
+                               combinations.begin() + (best + 1) * k);
+}
+
+void League::updateRatings(const std::vector<size_t>& table, const std::vector<double>& meanRank) {
+    const size_t k = table.size();
+    std::vector<Rating> updated(k);
+
+    for (size_t i = 0; i < k; ++i) {
+        const Rating& ri = ratings[table[i]];
+        double omega = 0.0;
+        double delta = 0.0;
+
+        for (size_t q = 0; q < k; ++q) {
+            if (q == i) continue;
+            const Rating& rq = ratings[table[q]];
+            double c = std::sqrt(ri.sigma * ri.sigma + rq.sigma * rq.sigma + 2.0 * kBeta * kBeta);
+            double pWin = 1.0 / (1.0 + std::exp((rq.mu - ri.mu) / c));
+            double score = meanRank[i] < meanRank[q] ? 1.0 : (meanRank[i] == meanRank[q] ? 0.5 : 0.0);
+            double gamma = ri.sigma / c;
+
+            omega += ri.sigma * ri.sigma / c * (score - pWin);
+            delta += gamma * ri.sigma * ri.sigma / (c * c) * pWin * (1.0 - pWin);
+        }
+
+        updated[i].mu = ri.mu + omega;
+        updated[i].sigma = ri.sigma * std::sqrt(std::max(1.0 - delta, kKappa));
+    }
+
+    for (size_t i = 0; i < k; ++i) {
+        ratings[table[i]] = updated[i];
+        ++tablesPlayed[table[i]];
+    }
+}
+
+std::vector<LeagueStanding> League::run() {
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::mutex schedulerMutex;
+    uint64_t scheduled = 0;
+    std::atomic<bool> stopRequested{false};
+    std::exception_ptr error;
+
+    auto worker = [&]() {
+        // Strategy instances of this worker, created the first time they are seated
+        std::vector<std::shared_ptr<PlayerStrategy>> instances(factories.size());
+        try {
+            while (!stopRequested.load()) {
+                std::vector<size_t> table;
+                uint64_t deal;
+                {
+                    std::lock_guard<std::mutex> lock(schedulerMutex);
+                    if (scheduled >= config.numTables) break;
+                    deal = scheduled++;
+                    table = nextTable();
+                    for (size_t member : table) ++inFlight[member];
+                }
+
+                std::vector<std::shared_ptr<PlayerStrategy>> players;
+                for (size_t member : table) {
+                    if (!instances[member]) instances[member] = factories[member]();
+                    players.push_back(instances[member]);
+                }
+                DealResult result = BatchRunner::playDeal(deal, config.seed, config.duplicate, players);
+
+                std::lock_guard<std::mutex> lock(schedulerMutex);
+                updateRatings(table, result.meanRank);
+                for (size_t member : table) --inFlight[member];
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(schedulerMutex);
+            if (!error) error = std::current_exception();
+            stopRequested.store(true);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    std::vector<LeagueStanding> standings;
+    for (size_t i = 0; i < factories.size(); ++i) {
+        standings.push_back(LeagueStanding{names[i], ratings[i], tablesPlayed[i]});
+    }
+    std::sort(standings.begin(), standings.end(),
+              [](const LeagueStanding& a, const LeagueStanding& b) { return a.rating.mu > b.rating.mu; });
+    return standings;
+}
+
+} // namespace sevens
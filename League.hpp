@@ -0,0 +1,75 @@
+#pragma once
+
+#include "PlayerStrategy.hpp"
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Settings of a league run over a pool of strategies.
+ * Every table seats tableSize strategies of the pool and plays one duplicate deal.
+ */
+struct LeagueConfig {
+    size_t tableSize = 4;
+    uint64_t numTables = 1000;
+    uint64_t seed = 1;
+    unsigned numThreads = 0;   // 0 = one worker per hardware thread
+    bool duplicate = true;
+};
+
+/**
+ * Multi-player skill rating (TrueSkill-style mean and uncertainty).
+ * The 95% confidence interval of the skill is mu +/- 1.96 sigma.
+ */
+struct Rating {
+    double mu = 25.0;
+    double sigma = 25.0 / 3.0;
+};
+
+struct LeagueStanding {
+    std::string name;
+    Rating rating;
+    uint64_t tables = 0;
+};
+
+/**
+ * Round-robin league: plays tables of strategies drawn from the pool on all
+ * cores and rates them with the Weng-Lin Bradley-Terry update, which handles
+ * any number of players per table.
+ *
+ * Scheduling first covers every table combination once, then keeps picking
+ * the table whose members have the least certain ratings. Strategies that
+ * are already playing on another worker count less, so parallel workers
+ * spread over the pool instead of all picking the same table.
+ */
+class League {
+public:
+    League(std::vector<StrategyFactory> factories,
+           std::vector<std::string> names,
+           LeagueConfig config);
+
+    // Standings sorted by rating, best first
+    std::vector<LeagueStanding> run();
+
+private:
+    // Members of the next table to play (called with the scheduler lock held)
+    std::vector<size_t> nextTable();
+
+    // Applies the outcome of a table (mean rank per member, lower is better)
+    void updateRatings(const std::vector<size_t>& table, const std::vector<double>& meanRank);
+
+    std::vector<StrategyFactory> factories;
+    std::vector<std::string> names;
+    LeagueConfig config;
+
+    std::vector<Rating> ratings;
+    std::vector<uint64_t> tablesPlayed;
+    std::vector<unsigned> inFlight;
+
+    // All table combinations, tableSize indices each, and how often each was played
+    std::vector<uint16_t> combinations;
+    std::vector<uint64_t> combinationPlays;
+};
+
+} // namespace sevens
@@ -0,0 +1,87 @@
+#include "LearnedStrategy.hpp"
+#include "GameState.hpp"
+#include <cstdlib>
+#include <iostream>
+
+namespace sevens {
+
+namespace {
+
+std::shared_ptr<const FeatureWeights> loadModel() {
+    const char* path = std::getenv("SEVENS_LEARNED_WEIGHTS");
+    const std::string file = path && *path ? path : "learned.weights";
+    try {
+        return FeatureWeights::load(file);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[LearnedStrategy] " << e.what() << ", using default weights\n";
+        return std::make_shared<const FeatureWeights>(FeatureWeights::defaults());
+    }
+}
+
+} // namespace
+
+LearnedStrategy::LearnedStrategy() : weights(loadModel()) {}
+
+PlayerStrategy* LearnedStrategy::clone() const {
+    auto* copy = new LearnedStrategy(*this);
+    copy->candidates.clear();
+    return copy;
+}
+
+void LearnedStrategy::initialize(uint64_t playerID) {
+    myID = playerID;
+}
+
+int LearnedStrategy::selectCardToPlay(
+    const std::vector<Card>& hand,
+    const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout)
+{
+    // Same position as the trainer sees it: hand and table bitmasks
+    uint64_t handMask = 0;
+    for (const Card& card : hand) handMask |= GameState::cardBit(card);
+    uint64_t tableMask = 0;
+    for (const auto& [suit, ranks] : tableLayout) {
+        for (const auto& [rank, present] : ranks) {
+            if (present && suit < 4 && rank >= 1 && rank <= 13) {
+                tableMask |= GameState::cardBit(Card{static_cast<int>(suit), static_cast<int>(rank)});
+            }
+        }
+    }
+    GameState state;
+    state.setTable(tableMask);
+    const FeatureContext context = maskContext(handMask, tableMask);
+
+    candidates.clear();
+    int handIndex[CandidateBatch::kMaxCandidates];
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+        if (!state.isPlayable(hand[i])) continue;
+        handIndex[candidates.add(context, hand[i])] = i;
+    }
+    const int best = candidates.best(*weights);
+    return best < 0 ? -1 : handIndex[best];
+}
+
+void LearnedStrategy::observeMove(uint64_t /*playerID*/, const Card& /*playedCard*/) {
+}
+
+void LearnedStrategy::observePass(uint64_t /*playerID*/) {
+}
+
+std::string LearnedStrategy::getName() const {
+    return kName;
+}
+
+} // namespace sevens
+
+#ifdef BUILD_SHARED_LIB
+extern "C" sevens::PlayerStrategy* createStrategy() {
+    return new sevens::LearnedStrategy();
+}
+
+// Copies a prototype made by createStrategy (see CloneableStrategy)
+extern "C" sevens::PlayerStrategy* cloneStrategy(const sevens::PlayerStrategy* prototype) {
+    const auto* cloneable = dynamic_cast<const sevens::CloneableStrategy*>(prototype);
+    return cloneable ? cloneable->clone() : nullptr;
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "FeatureEvaluator.hpp"
+#include "PlayerStrategy.hpp"
+#include <memory>
+
+namespace sevens {
+
+/**
+ * Plays a model written by the trainer (Trainer.hpp): the playable card with
+ * the best linear score over the FeatureEvaluator features, which is the most
+ * likely move of the trained policy. The model is the weight file named by
+ * SEVENS_LEARNED_WEIGHTS, learned.weights otherwise; it is read once per
+ * process and shared by every instance. Without a readable model it plays the
+ * hand-tuned default weights.
+ */
+class LearnedStrategy final : public PlayerStrategy, public CloneableStrategy {
+public:
+    static constexpr const char* kName = "LearnedStrategy";
+
+    LearnedStrategy();
+    ~LearnedStrategy() override = default;
+
+    PlayerStrategy* clone() const override;
+
+    void initialize(uint64_t playerID) override;
+    int selectCardToPlay(
+        const std::vector<Card>& hand,
+        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) override;
+    void observeMove(uint64_t playerID, const Card& playedCard) override;
+    void observePass(uint64_t playerID) override;
+    std::string getName() const override;
+
+private:
+    std::shared_ptr<const FeatureWeights> weights;
+    CandidateBatch candidates;
+    uint64_t myID = 0;
+};
+
+} // namespace sevens
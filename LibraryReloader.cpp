@@ -0,0 +1,228 @@
+#include "LibraryReloader.hpp"
+#include "StrategyLoader.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+namespace sevens {
+
+/**
+ * One loaded version of a library: its private copy, kept loaded by one
+ * instance, and removed once the version is released.
+ */
+struct LibraryVersion {
+    uint64_t number = 0;
+    std::string shadowPath;
+    std::shared_ptr<PlayerStrategy> keepLoaded;   // also the prototype copies are made from
+    CloneStrategyFn cloneStrategy = nullptr;
+
+    ~LibraryVersion() {
+        keepLoaded.reset();
+        std::error_code ignored;
+        std::filesystem::remove(shadowPath, ignored);
+    }
+};
+
+LibraryReloader::LibraryReloader(std::string libraryPath) : libraryPath(std::move(libraryPath)) {
+    const std::filesystem::path original(this->libraryPath);
+    const auto unique = std::chrono::system_clock::now().time_since_epoch().count() ^
+                        static_cast<long long>(reinterpret_cast<std::uintptr_t>(this));
+    shadowPrefix = (std::filesystem::temp_directory_path() /
+                    (original.stem().string() + ".reload-" + std::to_string(unique) + "-v")).string();
+
+    if (!stamp(loadedStamp)) {
+        throw std::runtime_error("Cannot read strategy library: " + this->libraryPath);
+    }
+    current = load(1);
+    versions.push_back(current);
+}
+
+LibraryReloader::~LibraryReloader() {
+    if (watcher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(watchMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        watcher.join();
+    }
+    // Newest first, so no version outlives one whose statics it may use
+    current.reset();
+    while (!versions.empty()) versions.pop_back();
+}
+
+bool LibraryReloader::stamp(FileStamp& out) const {
+    std::error_code error;
+    out.size = std::filesystem::file_size(libraryPath, error);
+    if (error) return false;
+    out.modified = std::filesystem::last_write_time(libraryPath, error);
+    return !error;
+}
+
+std::shared_ptr<const LibraryVersion> LibraryReloader::load(uint64_t number) const {
+    auto version = std::make_shared<LibraryVersion>();
+    version->number = number;
+    version->shadowPath = shadowPrefix + std::to_string(number) +
+                          std::filesystem::path(libraryPath).extension().string();
+    std::error_code error;
+    std::filesystem::copy_file(libraryPath, version->shadowPath,
+                               std::filesystem::copy_options::overwrite_existing, error);
+    if (error) {
+        throw std::runtime_error("Cannot copy " + libraryPath + " to " + version->shadowPath + ": " + error.message());
+    }
+    version->keepLoaded = StrategyLoader::loadFromLibrary(version->shadowPath);
+    version->cloneStrategy = StrategyLoader::findClone(version->shadowPath);
+    return version;
+}
+
+bool LibraryReloader::poll() {
+    FileStamp now;
+    if (!stamp(now) || now == loadedStamp) {
+        changed = false;
+        return false;
+    }
+    if (!changed || now != changedStamp) {
+        changed = true;
+        changedStamp = now;
+        return false;
+    }
+
+    // Settled: this content is tried once, and again only after the next change
+    changed = false;
+    loadedStamp = now;
+    ReloadCallback callback;
+    try {
+        auto next = load(version() + 1);
+        const uint64_t number = next->number;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = std::move(next);
+            versions.push_back(current);
+            callback = onReload;
+        }
+        if (callback) callback(number, "");
+        return true;
+    }
+    catch (const std::exception& e) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            callback = onReload;
+        }
+        if (callback) callback(version(), e.what());
+        return false;
+    }
+}
+
+void LibraryReloader::watch(std::chrono::milliseconds interval) {
+    if (watcher.joinable() || interval.count() <= 0) return;
+    watcher = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(watchMutex);
+        while (!wakeUp.wait_for(lock, interval, [this]() { return stopping; })) {
+            poll();
+        }
+    });
+}
+
+void LibraryReloader::setReloadCallback(ReloadCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    onReload = std::move(callback);
+}
+
+uint64_t LibraryReloader::version() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current->number;
+}
+
+std::shared_ptr<PlayerStrategy> LibraryReloader::create(std::shared_ptr<const LibraryVersion>& version) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        version = current;
+    }
+    if (auto copy = StrategyLoader::cloneFromPrototype(version->cloneStrategy, version->keepLoaded)) {
+        return copy;
+    }
+    return StrategyLoader::loadFromLibrary(version->shadowPath);
+}
+
+StrategyFactory LibraryReloader::factory(std::shared_ptr<LibraryReloader> reloader) {
+    return [reloader]() { return std::make_shared<ReloadingStrategy>(reloader); };
+}
+
+ReloadingStrategy::ReloadingStrategy(std::shared_ptr<LibraryReloader> reloader) : reloader(std::move(reloader)) {
+    inner = this->reloader->create(version);
+    reader = dynamic_cast<EventLogReader*>(inner.get());
+    namesReader = dynamic_cast<SeatNamesReader*>(inner.get());
+}
+
+void ReloadingStrategy::prepareGame() {
+    if (prepared) return;
+    prepared = true;
+    const bool mayReload = !followsDeals || dealStarted;
+    dealStarted = false;
+    if (!mayReload || reloader->version() == version->number) return;
+    std::shared_ptr<const LibraryVersion> next;
+    inner = reloader->create(next);
+    version = std::move(next);
+    reader = dynamic_cast<EventLogReader*>(inner.get());
+    namesReader = dynamic_cast<SeatNamesReader*>(inner.get());
+}
+
+void ReloadingStrategy::setSeatNames(const std::vector<std::string>& names) {
+    prepareGame();
+    if (namesReader) namesReader->setSeatNames(names);
+}
+
+void ReloadingStrategy::attachEventLog(const GameEventLog* log) {
+    prepareGame();
+    if (reader) {
+        reader->attachEventLog(log);
+        pending.attach(nullptr);
+    } else {
+        pending.attach(log);
+    }
+}
+
+void ReloadingStrategy::initialize(uint64_t playerID) {
+    prepareGame();
+    myID = playerID;
+    inner->initialize(playerID);
+    prepared = false;   // the next game checks for a newer version again
+}
+
+int ReloadingStrategy::selectCardToPlay(
+    const std::vector<Card>& hand,
+    const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout)
+{
+    pending.catchUp([this](const GameEvent& event) {
+        if (event.playerID == myID) return;
+        if (event.pass) {
+            inner->observePass(event.playerID);
+        } else {
+            inner->observeMove(event.playerID, event.card);
+        }
+    });
+    return inner->selectCardToPlay(hand, tableLayout);
+}
+
+void ReloadingStrategy::observeMove(uint64_t playerID, const Card& playedCard) {
+    inner->observeMove(playerID, playedCard);
+}
+
+void ReloadingStrategy::observePass(uint64_t playerID) {
+    inner->observePass(playerID);
+}
+
+std::string ReloadingStrategy::getName() const {
+    return inner->getName();
+}
+
+uint64_t ReloadingStrategy::strategyVersion() const {
+    return version->number;
+}
+
+void ReloadingStrategy::beginDeal(uint64_t) {
+    followsDeals = true;
+    dealStarted = true;
+}
+
+} // namespace sevens
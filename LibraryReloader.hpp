@@ -0,0 +1,139 @@
+#pragma once
+
+#include "GameEventLog.hpp"
+#include "PlayerStrategy.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sevens {
+
+struct LibraryVersion;
+
+/**
+ * A strategy library that is loaded again whenever its file changes, so a
+ * running tournament picks up a rebuilt strategy without a restart (and keeps
+ * everything else warm: other libraries, shared tables, worker threads).
+ *
+ * Every version is loaded from its own copy of the file, so the original can
+ * be overwritten while versions are in use and each version is a distinct
+ * module. A new version is only taken once the file has stayed the same for
+ * two polls in a row (the compiler may still be writing it), and only if it
+ * loads and creates a strategy; otherwise the current version stays.
+ *
+ * Seats made by factory() switch to the newest version between games, never
+ * during one, and report the version they played with (VersionedStrategy).
+ * With an engine that announces deals (DealListener), they switch only when a
+ * deal starts, so every seat rotation of a duplicate deal plays one version.
+ * Versions are numbered from 1 in every process. Old versions stay loaded
+ * until the reloader is destroyed: with dlopen, a newer copy binds its inline
+ * function statics to the copy loaded first, so that one must not go away.
+ */
+class LibraryReloader {
+public:
+    // Loads version 1; throws std::runtime_error like StrategyLoader
+    explicit LibraryReloader(std::string libraryPath);
+    ~LibraryReloader();
+
+    LibraryReloader(const LibraryReloader&) = delete;
+    LibraryReloader& operator=(const LibraryReloader&) = delete;
+
+    // Checks the file once; true if a new version was swapped in
+    bool poll();
+
+    // Polls every interval on a background thread until destroyed
+    void watch(std::chrono::milliseconds interval);
+
+    // Told about every version loaded after the first, or why a changed file was rejected
+    using ReloadCallback = std::function<void(uint64_t version, const std::string& error)>;
+    void setReloadCallback(ReloadCallback callback);
+
+    const std::string& path() const { return libraryPath; }
+    uint64_t version() const;
+
+    // Fresh instance of the current version (a copy of its prototype if the library can clone)
+    std::shared_ptr<PlayerStrategy> create(std::shared_ptr<const LibraryVersion>& version) const;
+
+    // Factory of seats that follow the library's current version
+    static StrategyFactory factory(std::shared_ptr<LibraryReloader> reloader);
+
+private:
+    struct FileStamp {
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type modified{};
+        bool operator==(const FileStamp& other) const { return size == other.size && modified == other.modified; }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    bool stamp(FileStamp& out) const;
+    std::shared_ptr<const LibraryVersion> load(uint64_t number) const;
+
+    std::string libraryPath;
+    std::string shadowPrefix;   // copies are <shadowPrefix><version><extension>
+    mutable std::mutex mutex;   // guards current, versions and callback
+    std::shared_ptr<const LibraryVersion> current;
+    std::vector<std::shared_ptr<const LibraryVersion>> versions;   // every version loaded, oldest first
+    ReloadCallback onReload;
+
+    // Only touched by poll(), which callers don't run concurrently
+    FileStamp loadedStamp;
+    FileStamp changedStamp;
+    bool changed = false;
+
+    std::mutex watchMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread watcher;
+};
+
+/**
+ * Seat backed by a LibraryReloader. It checks for a newer version when a game
+ * is set up (seat names, event log or initialize, whichever comes first) and
+ * keeps its instance for the whole game. Once the engine has called
+ * beginDeal(), it only checks in the first game after each call. Like DynamicStrategy, it replays the
+ * event log as observe callbacks for an inner strategy that doesn't read it.
+ */
+class ReloadingStrategy final : public PlayerStrategy, public EventLogReader, public SeatNamesReader,
+                                public VersionedStrategy, public DealListener {
+public:
+    explicit ReloadingStrategy(std::shared_ptr<LibraryReloader> reloader);
+
+    void setSeatNames(const std::vector<std::string>& names) override;
+    void attachEventLog(const GameEventLog* log) override;
+    void initialize(uint64_t playerID) override;
+
+    int selectCardToPlay(
+        const std::vector<Card>& hand,
+        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) override;
+    void observeMove(uint64_t playerID, const Card& playedCard) override;
+    void observePass(uint64_t playerID) override;
+    std::string getName() const override;
+
+    uint64_t strategyVersion() const override;
+
+    void beginDeal(uint64_t deal) override;
+
+private:
+    // Swaps to the current version before a game starts, if a swap is allowed there
+    void prepareGame();
+
+    std::shared_ptr<LibraryReloader> reloader;
+    std::shared_ptr<const LibraryVersion> version;   // outlives inner's module use
+    std::shared_ptr<PlayerStrategy> inner;
+    EventLogReader* reader = nullptr;
+    SeatNamesReader* namesReader = nullptr;
+    EventCursor pending;
+    bool prepared = false;
+    bool followsDeals = false;   // beginDeal() has been called: swap only at deal starts
+    bool dealStarted = false;    // beginDeal() since the last game was set up
+    uint64_t myID = 0;
+};
+
+} // namespace sevens
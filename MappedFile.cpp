@@ -0,0 +1,184 @@
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sevens {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) : path(path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open " + path + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot read the size of " + path);
+    }
+    fileHandle = file;
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length == 0) return;   // empty files can't be mapped
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        release();
+        throw std::runtime_error("Cannot map " + path + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    mappingHandle = mapping;
+    bytes = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!bytes) {
+        release();
+        throw std::runtime_error("Cannot map " + path + " (error " + std::to_string(GetLastError()) + ")");
+    }
+}
+
+MappedFile MappedFile::openForUpdate(const std::string& path, size_t minimumSize) {
+    MappedFile mapped;
+    mapped.path = path;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open " + path + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    mapped.fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        throw std::runtime_error("Cannot read the size of " + path);
+    }
+    // A mapping larger than the file extends it with zeros
+    const uint64_t size = std::max<uint64_t>(static_cast<uint64_t>(fileSize.QuadPart), minimumSize);
+    if (size == 0) return mapped;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE,
+                                        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), NULL);
+    if (!mapping) {
+        throw std::runtime_error("Cannot map " + path + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    mapped.mappingHandle = mapping;
+    mapped.bytes = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (!mapped.bytes) {
+        throw std::runtime_error("Cannot map " + path + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    mapped.length = static_cast<size_t>(size);
+    mapped.writable = true;
+    return mapped;
+}
+
+void MappedFile::release() {
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    bytes = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    length = 0;
+    writable = false;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) : path(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read the size of " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* view = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            throw std::runtime_error("Cannot map " + path);
+        }
+        bytes = static_cast<uint8_t*>(view);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile MappedFile::openForUpdate(const std::string& path, size_t minimumSize) {
+    MappedFile mapped;
+    mapped.path = path;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read the size of " + path);
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size < minimumSize) {
+        if (::ftruncate(fd, static_cast<off_t>(minimumSize)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot grow " + path);
+        }
+        size = minimumSize;
+    }
+    if (size > 0) {
+        void* view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        mapped.bytes = static_cast<uint8_t*>(view);
+        mapped.length = size;
+        mapped.writable = true;
+    }
+    ::close(fd);
+    return mapped;
+}
+
+void MappedFile::release() {
+    if (bytes) ::munmap(bytes, length);
+    bytes = nullptr;
+    length = 0;
+    writable = false;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        path = std::move(other.path);
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        writable = std::exchange(other.writable, false);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+} // namespace sevens
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sevens {
+
+/**
+ * Memory mapping of a whole file, read-only unless opened with openForUpdate.
+ * The view starts page aligned, so data written at aligned file offsets can
+ * be used in place.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    // Throws std::runtime_error if the file can't be opened or mapped
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    /**
+     * Shared read-write mapping: the file is created if missing and grown to
+     * minimumSize if shorter (new bytes are zero). Stores through
+     * mutableData() go straight to the file. Throws std::runtime_error.
+     */
+    static MappedFile openForUpdate(const std::string& path, size_t minimumSize);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    uint8_t* mutableData() const { return writable ? bytes : nullptr; }
+    size_t size() const { return length; }
+    const std::string& fileName() const { return path; }
+
+private:
+    void release();
+
+    std::string path;
+    uint8_t* bytes = nullptr;
+    size_t length = 0;
+    bool writable = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+} // namespace sevens
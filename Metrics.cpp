@@ -0,0 +1,189 @@
+#include "Metrics.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+
+namespace sevens {
+
+namespace {
+
+// The last slot is never claimed: threads beyond kMaxThreads share it
+struct SlotTable {
+    ThreadCounters slots[Metrics::kMaxThreads];
+    SlotTable() { slots[Metrics::kMaxThreads - 1].shared = true; }
+};
+
+SlotTable& slotTable() {
+    static SlotTable table;
+    return table;
+}
+
+// Gives the slot back when its thread exits
+struct SlotHandle {
+    ThreadCounters* slot = nullptr;
+    ~SlotHandle() {
+        if (slot && !slot->shared) {
+            slot->inUse.store(false, std::memory_order_release);
+        }
+        // Anything counted during the rest of thread teardown goes to the shared slot
+        slot = &slotTable().slots[Metrics::kMaxThreads - 1];
+    }
+};
+
+void writeAtomically(const std::string& path, const std::function<void(std::ostream&)>& write) {
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) return;
+        write(out);
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        // Some platforms refuse to rename over an existing file
+        std::filesystem::remove(path, ec);
+        std::filesystem::rename(temporary, path, ec);
+    }
+}
+
+double seconds(uint64_t nanos) {
+    return static_cast<double>(nanos) / 1e9;
+}
+
+double perGame(uint64_t value, uint64_t games) {
+    return games ? static_cast<double>(value) / static_cast<double>(games) : 0.0;
+}
+
+} // namespace
+
+ThreadCounters& Metrics::local() {
+    thread_local SlotHandle handle;
+    if (!handle.slot) {
+        SlotTable& table = slotTable();
+        for (size_t i = 0; i + 1 < kMaxThreads && !handle.slot; ++i) {
+            bool expected = false;
+            if (table.slots[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                handle.slot = &table.slots[i];
+            }
+        }
+        if (!handle.slot) {
+            handle.slot = &table.slots[kMaxThreads - 1];
+        }
+    }
+    return *handle.slot;
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot total;
+    for (const ThreadCounters& slot : slotTable().slots) {
+        total.gamesPlayed += slot.gamesPlayed.load(std::memory_order_relaxed);
+        total.turns += slot.turns.load(std::memory_order_relaxed);
+        total.passes += slot.passes.load(std::memory_order_relaxed);
+        total.deadlockedGames += slot.deadlockedGames.load(std::memory_order_relaxed);
+        total.strategyCalls += slot.strategyCalls.load(std::memory_order_relaxed);
+        total.engineNanos += slot.engineNanos.load(std::memory_order_relaxed);
+        total.strategyNanos += slot.strategyNanos.load(std::memory_order_relaxed);
+        total.allocations += slot.allocations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Metrics::writePrometheus(std::ostream& out, const MetricsSnapshot& s) {
+    auto metric = [&out](const char* name, const char* type, const char* help, double value) {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n"
+            << name << " " << value << "\n";
+    };
+    metric("sevens_games_played_total", "counter", "Games played to the end.", static_cast<double>(s.gamesPlayed));
+    metric("sevens_turns_total", "counter", "Player turns, including passes.", static_cast<double>(s.turns));
+    metric("sevens_passes_total", "counter", "Turns where the player passed.", static_cast<double>(s.passes));
+    metric("sevens_deadlocked_games_total", "counter", "Games ended with players still holding cards.", static_cast<double>(s.deadlockedGames));
+    metric("sevens_strategy_calls_total", "counter", "Calls to selectCardToPlay.", static_cast<double>(s.strategyCalls));
+    metric("sevens_engine_seconds_total", "counter", "Time spent in the game engine.", seconds(s.engineNanos));
+    metric("sevens_strategy_seconds_total", "counter", "Time spent inside strategies.", seconds(s.strategyNanos));
+    metric("sevens_allocations_total", "counter", "Heap allocations (0 unless built with SEVENS_COUNT_ALLOCATIONS).", static_cast<double>(s.allocations));
+    metric("sevens_allocations_per_game", "gauge", "Average heap allocations per game.", perGame(s.allocations, s.gamesPlayed));
+}
+
+void Metrics::writeJson(std::ostream& out, const MetricsSnapshot& s) {
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    out << "{\n"
+        << "  \"timestamp_ms\": " << timestamp << ",\n"
+        << "  \"games_played\": " << s.gamesPlayed << ",\n"
+        << "  \"turns\": " << s.turns << ",\n"
+        << "  \"passes\": " << s.passes << ",\n"
+        << "  \"deadlocked_games\": " << s.deadlockedGames << ",\n"
+        << "  \"strategy_calls\": " << s.strategyCalls << ",\n"
+        << "  \"engine_seconds\": " << seconds(s.engineNanos) << ",\n"
+        << "  \"strategy_seconds\": " << seconds(s.strategyNanos) << ",\n"
+        << "  \"allocations\": " << s.allocations << ",\n"
+        << "  \"allocations_per_game\": " << perGame(s.allocations, s.gamesPlayed) << "\n"
+        << "}\n";
+}
+
+MetricsExporter::MetricsExporter(std::string prefix, std::chrono::milliseconds interval)
+    : prefix(std::move(prefix)), interval(interval)
+{
+    thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wakeUp.wait_for(lock, this->interval, [this]() { return stopping; })) {
+            lock.unlock();
+            writeNow();
+            lock.lock();
+        }
+    });
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    thread.join();
+    writeNow();
+}
+
+void MetricsExporter::writeNow() const {
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    writeAtomically(prefix + ".prom", [&](std::ostream& out) { Metrics::writePrometheus(out, snapshot); });
+    writeAtomically(prefix + ".json", [&](std::ostream& out) { Metrics::writeJson(out, snapshot); });
+}
+
+} // namespace sevens
+
+#ifdef SEVENS_COUNT_ALLOCATIONS
+// Counting replacement of the global allocator (define SEVENS_COUNT_ALLOCATIONS
+// when compiling this file). The array and nothrow forms forward to these.
+namespace {
+thread_local bool countingAllocation = false;
+}
+
+void* operator new(std::size_t size) {
+    if (!countingAllocation) {
+        countingAllocation = true;
+        sevens::ThreadCounters& counters = sevens::Metrics::local();
+        counters.add(counters.allocations, 1);
+        countingAllocation = false;
+    }
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace sevens {
+
+/**
+ * Counters of one thread. Only the owning thread writes them (plain relaxed
+ * load + store, no locked instruction), any thread may read them.
+ * Padded to a cache line so that neighbouring threads never share one.
+ */
+struct alignas(64) ThreadCounters {
+    std::atomic<uint64_t> gamesPlayed{0};
+    std::atomic<uint64_t> turns{0};
+    std::atomic<uint64_t> passes{0};
+    std::atomic<uint64_t> deadlockedGames{0};
+    std::atomic<uint64_t> strategyCalls{0};
+    std::atomic<uint64_t> engineNanos{0};
+    std::atomic<uint64_t> strategyNanos{0};
+    std::atomic<uint64_t> allocations{0};
+
+    std::atomic<bool> inUse{false};
+    bool shared = false;   // overflow slot used by several threads at once
+
+    void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        if (shared) {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        } else {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Sum of all thread counters at one point in time
+struct MetricsSnapshot {
+    uint64_t gamesPlayed = 0;
+    uint64_t turns = 0;
+    uint64_t passes = 0;
+    uint64_t deadlockedGames = 0;
+    uint64_t strategyCalls = 0;
+    uint64_t engineNanos = 0;
+    uint64_t strategyNanos = 0;
+    uint64_t allocations = 0;
+};
+
+/**
+ * Process-wide registry of per-thread counters.
+ * A thread claims a slot on first use and releases it when it exits; the
+ * counts stay in the slot, so the next thread simply adds on top of them.
+ */
+class Metrics {
+public:
+    static constexpr size_t kMaxThreads = 256;
+
+    // Counters of the calling thread
+    static ThreadCounters& local();
+
+    // Sum over every slot; never blocks the threads that are counting
+    static MetricsSnapshot snapshot();
+
+    static void writePrometheus(std::ostream& out, const MetricsSnapshot& snapshot);
+    static void writeJson(std::ostream& out, const MetricsSnapshot& snapshot);
+};
+
+/**
+ * Background thread writing <prefix>.prom (Prometheus text format) and
+ * <prefix>.json every interval, and once more when destroyed.
+ * Files are written next to their final name and renamed into place, so a
+ * scraper never reads a half-written file.
+ */
+class MetricsExporter {
+public:
+    MetricsExporter(std::string prefix, std::chrono::milliseconds interval);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void writeNow() const;
+
+private:
+    std::string prefix;
+    std::chrono::milliseconds interval;
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread thread;
+};
+
+} // namespace sevens
@@ -1,34 +1,33 @@
 #include "MyCardParser.hpp"
 #include <iostream>
-#include <vector>
-#include <random>
 #include <chrono>
-#include <algorithm>
 
 namespace sevens {
 
 void MyCardParser::read_cards(const std::string& filename) {
+    (void)filename;   // the deck is generated, not read from a file
     std::cout << "[MyCardParser::read_cards] Creating and shuffling 52-card deck.\n";
 
-    std::vector<Card> deck;
-    for (int suit = 0; suit < 4; ++suit) {
-        for (int rank = 1; rank < 14; ++rank) {
-            deck.push_back(Card{suit, rank});
-        }
+    const Deck deck = read_deck();
+    for (uint64_t id = 0; id < deck.cards.size(); ++id) {
+        this->cards_hashmap[id] = deck.at(id);
     }
+}
 
-    auto now = std::chrono::high_resolution_clock::now();
-    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        now.time_since_epoch()
-    ).count();
-    
-    std::mt19937 rng(static_cast<unsigned long>(nanos));
-    std::shuffle(deck.begin(), deck.end(), rng);
-
-    int id = 0;
-    for (const auto& card : deck) {
-        this->cards_hashmap[id++] = card;
+Deck MyCardParser::read_deck() const {
+    uint64_t deckSeed = seed;
+    if (!seeded) {
+        auto now = std::chrono::high_resolution_clock::now();
+        deckSeed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now.time_since_epoch()
+        ).count());
     }
+    return Deck::shuffled(deckSeed);
+}
+
+void MyCardParser::set_seed(uint64_t seed) {
+    this->seeded = true;
+    this->seed = seed;
 }
 
 } // namespace sevens
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Generic_card_parser.hpp"
+#include "Deck.hpp"
 
 namespace sevens {
 
@@ -14,6 +15,16 @@ public:
     ~MyCardParser() = default;
 
     void read_cards(const std::string& filename) override;
+
+    // Use a fixed seed for the shuffle so that a deal can be replayed
+    void set_seed(uint64_t seed);
+
+    // The deck read_cards stores, without filling the card map
+    Deck read_deck() const;
+
+private:
+    bool seeded = false;
+    uint64_t seed = 0;
 };
 
 } // namespace sevens
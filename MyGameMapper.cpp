@@ -1,8 +1,17 @@
 #include "MyGameMapper.hpp"
 #include "MyCardParser.hpp"
 #include "MyGameParser.hpp"
+#include "Metrics.hpp"
+#include "TableRenderer.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace sevens {
 
@@ -28,162 +37,273 @@ void MyGameMapper::print_table_layout() const {
 }
 
 void MyGameMapper::read_cards(const std::string& filename) {
-    MyCardParser parser;
-    parser.read_cards(filename);
-    cards = parser.get_cards_hashmap();
-    std::cout << "[MyGameMapper::read_cards] Loaded " << cards.size() << " cards.\n";
+    TraceSpan span("read_cards", "setup");
+    (void)filename;   // the deck is generated, not read from a file
+    if (!deckSet) {
+        MyCardParser parser;
+        if (dealSeeded) {
+            parser.set_seed(dealSeed);
+        }
+        deck = parser.read_deck();
+    }
+    deckSize = deck.cards.size();
+    std::cout << "[MyGameMapper::read_cards] Loaded " << deckSize << " cards.\n";
 }
 
 void MyGameMapper::read_game(const std::string& filename) {
+    TraceSpan span("read_game", "setup");
     MyGameParser parser;
     parser.read_game(filename);
     table_layout = parser.get_table_layout();
     std::cout << "[MyGameMapper::read_game] Table layout initialized.\n";
 }
 
+void MyGameMapper::set_deal_seed(uint64_t seed) {
+    dealSeeded = true;
+    dealSeed = seed;
+}
+
+void MyGameMapper::set_deck(const Deck& deck) {
+    deckSet = true;
+    this->deck = deck;
+}
+
+void MyGameMapper::set_display_rate(double framesPerSecond) {
+    displayRate = framesPerSecond;
+}
+
+void MyGameMapper::set_decision_observer(DecisionObserver observer) {
+    decisionObserver = std::move(observer);
+}
+
 bool MyGameMapper::hasRegisteredStrategies() const {
     return !strategies.empty();
 }
 
 void MyGameMapper::registerStrategy(uint64_t playerID, std::shared_ptr<PlayerStrategy> strategy) {
-    (void)playerID;
-    (void)strategy;
     strategies[playerID] = strategy;
     std::cout << "[MyGameMapper::registerStrategy] Registered strategy for player " << playerID << ".\n";
 }
 
-std::vector<std::pair<uint64_t, uint64_t>>
-MyGameMapper::compute_game_progress(uint64_t numPlayers)
-{
-    std::cout << "[MyGameMapper::compute_game_progress] Simulating quietly...\n";
-
-    // Distribute cards
-    uint64_t i = 0;
-    for (const auto& pair : cards) {
-        const auto& card = pair.second;
-        playerHands[i % numPlayers].push_back(card);
-        ++i;
+std::array<uint64_t, GameState::kMaxPlayers> MyGameMapper::deal_cards(uint64_t numPlayers) {
+    TraceSpan span("deal_cards", "setup");
+    playerHands.clear();
+    // Cards already laid out by read_game (the 7s) stay on the table
+    uint64_t laid = 0;
+    for (const auto& [suit, ranks] : table_layout) {
+        for (const auto& [rank, onTable] : ranks) {
+            if (onTable && suit < 4 && rank >= 1 && rank <= 13) {
+                laid |= GameState::cardBit(Card{static_cast<int>(suit), static_cast<int>(rank)});
+            }
+        }
     }
+    std::array<uint64_t, GameState::kMaxPlayers> hands{};
+    uint64_t dealt = 0;
+    for (size_t position = 0; position < deckSize; ++position) {
+        const uint8_t id = deck.cards[position];
+        const uint64_t bit = uint64_t{1} << id;
+        if (laid & bit) continue;
+        const uint64_t seat = dealt++ % numPlayers;
+        playerHands[seat].push_back(GameState::cardAt(id));
+        hands[seat] |= bit;
+    }
+    return hands;
+}
 
-    std::vector<std::pair<uint64_t, uint64_t>> rankings;
-    std::vector<bool> finished(numPlayers, false);
-    std::vector<uint64_t> playerRanks(numPlayers, 0);
-    uint64_t rank = 1;
-    bool changed;
+bool MyGameMapper::can_play(const Card& card) const {
+    return state.isPlayable(card);
+}
 
-    do {
-        changed = false;
-        for (uint64_t p = 0; p < numPlayers; ++p) {
-            if (finished[p]) continue;
-            auto& hand = playerHands[p];
-            auto it = hand.begin();
-            while (it != hand.end()) {
-                const Card& card = *it;
-                uint64_t s = card.suit;
-                uint64_t r = card.rank;
-
-                bool canPlay = (r == 7) ||
-                               (r > 1 && table_layout[s][r - 1]) ||
-                               (r < 13 && table_layout[s][r + 1]);
-
-                if (canPlay) {
-                    table_layout[s][r] = true;
-                    it = hand.erase(it);
-                    changed = true;
-                    if (hand.empty()) {
-                        finished[p] = true;
-                        playerRanks[p] = rank++;
-                    }
-                    break;
-                } else {
-                    ++it;
-                }
-            }
+int MyGameMapper::choose_card(uint64_t playerID, uint64_t& strategyNanos) {
+    const auto& hand = playerHands[playerID];
+    auto itStrategy = strategies.find(playerID);
+
+    // No strategy registered: play the first playable card
+    if (itStrategy == strategies.end() || !itStrategy->second) {
+        for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+            if (can_play(hand[i])) return i;
         }
-    } while (changed);
+        return -1;
+    }
 
-    for (uint64_t p = 0; p < numPlayers; ++p) {
-        if (!finished[p]) playerRanks[p] = rank++;
-        rankings.emplace_back(p, playerRanks[p]);
+    auto start = std::chrono::steady_clock::now();
+    int index;
+    {
+        TraceSpan span(traceNames[playerID] ? traceNames[playerID] : "selectCardToPlay", "decision", "player", playerID);
+        index = itStrategy->second->selectCardToPlay(hand, table_layout);
     }
-    std::cout << "[MyGameMapper::compute_game_progress] Game progressing.\n";
+    strategyNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
 
-    return rankings;
+    ThreadCounters& counters = Metrics::local();
+    counters.add(counters.strategyCalls, 1);
+
+    // An out-of-range or illegal answer counts as a pass
+    if (index < 0 || index >= static_cast<int>(hand.size()) || !can_play(hand[index])) {
+        return -1;
+    }
+    return index;
+}
+
+void MyGameMapper::record_event(const GameEvent& event) {
+    events.append(event);
+    for (const auto& [id, observer] : observers) {
+        if (id == event.playerID) continue;
+        TraceSpan span(event.pass ? "observePass" : "observeMove", "observe", "player", id);
+        if (event.pass) {
+            observer->observePass(event.playerID);
+        } else {
+            observer->observeMove(event.playerID, event.card);
+        }
+    }
 }
 
 std::vector<std::pair<uint64_t, uint64_t>>
-MyGameMapper::compute_and_display_game(uint64_t numPlayers)
+MyGameMapper::play_game(uint64_t numPlayers, bool display)
 {
-    std::cout << "[MyGameMapper::compute_and_display_game] Starting simulation.\n";
+    auto gameStart = std::chrono::steady_clock::now();
+    uint64_t strategyNanos = 0;
+    uint64_t turns = 0;
+    uint64_t passes = 0;
 
-    uint64_t i = 0;
-    for (const auto& pair : cards) {
-        const auto& card = pair.second;
-        playerHands[i % numPlayers].push_back(card);
-        ++i;
+    if (numPlayers == 0 || numPlayers > GameState::kMaxPlayers) {
+        throw std::invalid_argument("Sevens is played by 1 to " +
+                                    std::to_string(GameState::kMaxPlayers) + " players");
+    }
+    TraceSpan gameSpan("game", "game", "players", numPlayers);
+    state = GameState::start(numPlayers, deal_cards(numPlayers));
+    events.clear();
+    observers.clear();
+    std::array<uint64_t, GameState::kMaxPlayers> versions{};
+    std::vector<std::string> seatNames(numPlayers);
+    for (const auto& [id, strategy] : strategies) {
+        if (strategy && id < numPlayers) seatNames[id] = strategy->getName();
+    }
+    traceNames.fill(nullptr);
+    {
+        TraceSpan setupSpan("initialize", "setup");
+        for (const auto& entry : strategies) {
+            if (!entry.second) continue;
+            if (auto* namesReader = dynamic_cast<SeatNamesReader*>(entry.second.get())) {
+                namesReader->setSeatNames(seatNames);
+            }
+            if (auto* reader = dynamic_cast<EventLogReader*>(entry.second.get())) {
+                reader->attachEventLog(&events);
+            } else {
+                observers.emplace_back(entry.first, entry.second.get());
+            }
+            entry.second->initialize(entry.first);
+            if (auto* versioned = dynamic_cast<VersionedStrategy*>(entry.second.get())) {
+                if (entry.first < versions.size()) versions[entry.first] = versioned->strategyVersion();
+            }
+        }
+    }
+    // After initialize: a reloading seat may only now have its name for this game
+    if (Trace::enabled()) {
+        for (const auto& [id, strategy] : strategies) {
+            if (strategy && id < numPlayers) traceNames[id] = Trace::intern(strategy->getName());
+        }
     }
 
-    for (uint64_t p = 0; p < numPlayers; ++p) {
-        std::cout << "Initial hand for Player " << p << ": ";
-        for (const Card& c : playerHands[p]) {
-            std::cout << c << " ";
+    // Watched games are drawn on the renderer's thread; the loop only hands it snapshots
+    std::unique_ptr<TableRenderer> renderer;
+    RenderFrame frame;
+    if (display) {
+        std::vector<std::string> labels;
+        for (uint64_t p = 0; p < numPlayers; ++p) {
+            auto it = strategies.find(p);
+            labels.push_back("Player " + std::to_string(p) +
+                             (it != strategies.end() && it->second ? " (" + it->second->getName() + ")" : ""));
         }
-        std::cout << "\n";
+        renderer = std::make_unique<TableRenderer>(std::move(labels), displayRate);
+        frame.state = state;
+        renderer->submit(frame);
     }
 
-    std::vector<std::pair<uint64_t, uint64_t>> rankings;
-    std::vector<bool> finished(numPlayers, false);
-    std::vector<uint64_t> playerRanks(numPlayers, 0);
-    uint64_t rank = 1;
-    bool changed;
+    while (!state.over) {
+        const uint64_t p = state.toMove;
+        auto& hand = playerHands[p];
+        int index = choose_card(p, strategyNanos);
+        ++turns;
+        if (decisionObserver) {
+            decisionObserver(p, hand, table_layout, index);
+        }
 
-    do {
-        changed = false;
-        for (uint64_t p = 0; p < numPlayers; ++p) {
-            if (finished[p]) continue;
-            auto& hand = playerHands[p];
-            bool played = false;
-            auto it = hand.begin();
-            while (it != hand.end()) {
-                const Card& card = *it;
-                uint64_t s = card.suit;
-                uint64_t r = card.rank;
-
-                bool canPlay = (r == 7) ||
-                            (r > 1 && table_layout[s][r - 1]) ||
-                            (r < 13 && table_layout[s][r + 1]);
-
-                if (canPlay) {
-                    std::cout << "Player " << p << " plays " << card << "\n";
-                    table_layout[s][r] = true;
-                    it = hand.erase(it);
-                    played = true;
-                    changed = true;
-                    if (hand.empty()) {
-                        finished[p] = true;
-                        playerRanks[p] = rank++;
-                        std::cout << "Player " << p << " finished with rank " << playerRanks[p] << "\n";
-                    }
-                    break;
-                } else {
-                    ++it;
-                }
-            }
-            if (!played) {
-                std::cout << "Player " << p << " cannot play this turn.\n";
+        GameEvent event{p, Card{0, 0}, true};
+        if (index >= 0) {
+            const Card card = hand[index];
+            table_layout[card.suit][card.rank] = true;
+            hand.erase(hand.begin() + index);
+            state.apply(GameState::cardIndex(card));
+            event = GameEvent{p, card, false};
+        } else {
+            ++passes;
+            state.apply(GameState::kPass);
+        }
+        record_event(event);
+
+        if (renderer) {
+            if (frame.recentCount == RenderFrame::kRecent) {
+                std::copy(frame.recent.begin() + 1, frame.recent.end(), frame.recent.begin());
+                --frame.recentCount;
             }
-            print_table_layout();
+            frame.recent[frame.recentCount++] = event;
+            frame.state = state;
+            frame.turn = turns;
+            renderer->submit(frame);
         }
-    } while (changed);
+    }
+    if (renderer) {
+        renderer->finish(frame);
+    }
 
+    // Players still holding cards when nobody can move are ranked in seat order
+    std::vector<std::pair<uint64_t, uint64_t>> rankings;
+    for (uint64_t p = 0; p < numPlayers; ++p) {
+        rankings.emplace_back(p, state.rank(p));
+    }
+    const bool deadlocked = state.finishedCount < numPlayers;
+    lastGame = GameRecord{};
+    lastGame.numPlayers = numPlayers;
+    lastGame.turns = turns;
+    lastGame.passes = passes;
+    lastGame.deadlocked = deadlocked;
+    lastGame.version = versions;
     for (uint64_t p = 0; p < numPlayers; ++p) {
-        if (!finished[p]) playerRanks[p] = rank++;
-        rankings.emplace_back(p, playerRanks[p]);
+        lastGame.rank[p] = state.rank(p);
     }
 
+    uint64_t gameNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - gameStart
+    ).count();
+    ThreadCounters& counters = Metrics::local();
+    counters.add(counters.gamesPlayed, 1);
+    counters.add(counters.turns, turns);
+    counters.add(counters.passes, passes);
+    counters.add(counters.deadlockedGames, deadlocked ? 1 : 0);
+    counters.add(counters.strategyNanos, strategyNanos);
+    counters.add(counters.engineNanos, gameNanos > strategyNanos ? gameNanos - strategyNanos : 0);
+
+    return rankings;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>>
+MyGameMapper::compute_game_progress(uint64_t numPlayers)
+{
+    std::cout << "[MyGameMapper::compute_game_progress] Simulating quietly...\n";
+    auto rankings = play_game(numPlayers, false);
+    std::cout << "[MyGameMapper::compute_game_progress] Game progressing.\n";
     return rankings;
 }
 
+std::vector<std::pair<uint64_t, uint64_t>>
+MyGameMapper::compute_and_display_game(uint64_t numPlayers)
+{
+    std::cout << "[MyGameMapper::compute_and_display_game] Starting simulation.\n";
+    return play_game(numPlayers, true);
+}
+
 std::vector<std::pair<std::string, uint64_t>>
 MyGameMapper::compute_game_progress(const std::vector<std::string>& playerNames)
 {
@@ -1,7 +1,13 @@
 #pragma once
 
 #include "Generic_game_mapper.hpp"
+#include "Deck.hpp"
 #include "PlayerStrategy.hpp"
+#include "GameEventLog.hpp"
+#include "GameState.hpp"
+#include "ResultStats.hpp"
+#include <array>
+#include <functional>
 #include <random>
 #include <unordered_map>
 #include <vector>
@@ -16,13 +22,38 @@ namespace sevens {
  */
 class MyGameMapper : public Generic_game_mapper {
 private:
-    std::unordered_map<uint64_t, Card> cards;
+    Deck deck{};
+    bool deckSet = false;     // by set_deck, so read_cards keeps it
+    size_t deckSize = 0;      // cards loaded by read_cards (none before)
     std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>> tableLayout;
     std::unordered_map<uint64_t, std::vector<Card>> playerHands;
     std::unordered_map<uint64_t, std::shared_ptr<PlayerStrategy>> strategies;
 
+    // Rules, turn order and finishing order of the current game; tableLayout
+    // and playerHands mirror it in the form strategies are handed
+    GameState state;
+
+    // History of the current game, shared by the strategies that read it
+    GameEventLog events;
+    // Strategies without EventLogReader, which get observeMove/observePass instead
+    std::vector<std::pair<uint64_t, PlayerStrategy*>> observers;
+    // Decision span name of each seat (interned strategy names), set only while tracing
+    std::array<const char*, GameState::kMaxPlayers> traceNames{};
+
     std::mt19937 rng;  // Random number generator
+
+    bool dealSeeded = false;
+    uint64_t dealSeed = 0;
+    double displayRate = 30.0;
 public:
+    // Sees every decision before it is applied: the hand and table the strategy
+    // was shown and its answer (a legal hand index, or -1 for a pass)
+    using DecisionObserver = std::function<void(
+        uint64_t playerID,
+        const std::vector<Card>& hand,
+        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout,
+        int index)>;
+
     MyGameMapper();
     ~MyGameMapper() = default;
 
@@ -41,6 +72,20 @@ public:
     // Required by Generic_card_parser and Generic_game_parser
     void read_cards(const std::string& filename) override;
     void read_game(const std::string& filename) override;
+
+    // Make read_cards produce a reproducible deal (used to replay the same deal)
+    void set_deal_seed(uint64_t seed);
+
+    // Make read_cards use this deck as is (batch engines shuffle once per deal, not per game)
+    void set_deck(const Deck& deck);
+
+    void set_decision_observer(DecisionObserver observer);
+
+    // Turns, passes, ranks and strategy versions per seat of the last game played (strategy[] left at 0)
+    const GameRecord& last_game() const { return lastGame; }
+
+    // Most redraws per second in compute_and_display_game (0 = every turn)
+    void set_display_rate(double framesPerSecond);
     
     // Strategy management
     void registerStrategy(uint64_t playerID, std::shared_ptr<PlayerStrategy> strategy);
@@ -50,9 +95,24 @@ public:
     void print_table_layout() const;
 
 private:
-    // You can define any data structures needed to track the game
-    // E.g., player hands, table layout, random engine, etc.
-    // ...
+    // Deal the deck round-robin in deck order; returns the hands as bitmasks
+    std::array<uint64_t, GameState::kMaxPlayers> deal_cards(uint64_t numPlayers);
+
+    // Sevens rule: a card next to one already on the table (the 7s start there)
+    bool can_play(const Card& card) const;
+
+    // Index of the card player p plays this turn, or -1 to pass.
+    // Time spent inside the strategy is added to strategyNanos.
+    int choose_card(uint64_t playerID, uint64_t& strategyNanos);
+
+    // Logs a turn and tells the strategies that don't read the log (other than the mover)
+    void record_event(const GameEvent& event);
+
+    // Shared game loop of compute_game_progress / compute_and_display_game
+    std::vector<std::pair<uint64_t, uint64_t>> play_game(uint64_t numPlayers, bool display);
+
+    DecisionObserver decisionObserver;
+    GameRecord lastGame;
 };
 
 } // namespace sevens
@@ -0,0 +1,308 @@
+#include "OpeningBook.hpp"
+#include "Deck.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sevens {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'V', 'N', 'B', 'O', 'O', 'K', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr int kMoves = 8;   // 4 suit slots x 2 sides
+
+// File header; the slots follow at offset sizeof(BookHeader)
+struct BookHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved0;
+    uint64_t maxPlayed;
+    uint64_t numSlots;       // power of two
+    uint64_t numEntries;
+    uint64_t reserved[3];
+};
+
+// One situation: key (0 = free slot), playouts per move, book move (slot * 2 + side)
+struct BookSlot {
+    uint64_t key;
+    uint32_t samples;
+    uint8_t move;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(BookHeader) == 64, "slots start on a cache line");
+static_assert(sizeof(BookSlot) == 16, "slot layout is part of the file format");
+
+uint64_t slotOf(uint64_t key, uint64_t mask) {
+    return (key * 0x9E3779B97F4A7C15ULL >> 17) & mask;
+}
+
+/**
+ * The canonical form of a position: the key, and for each slot of the sorted
+ * suits which suit it is and whether its first side is the high one.
+ */
+struct Situation {
+    uint64_t key = 0;
+    std::array<uint8_t, 4> suit{};
+    std::array<bool, 4> highFirst{};
+
+    // Card of a canonical move, or -1 if that side is closed
+    int card(const GameState& state, int move) const {
+        const int s = suit[move / 2];
+        const bool high = highFirst[move / 2] == (move % 2 == 0);
+        if (high) return state.high[s] < 13 ? s * 13 + state.high[s] : -1;
+        return state.low[s] > 1 ? s * 13 + state.low[s] - 2 : -1;
+    }
+
+    // Canonical move of a playable card
+    int move(int card) const {
+        const int s = card / 13;
+        const int slot = static_cast<int>(std::find(suit.begin(), suit.end(), s) - suit.begin());
+        const bool high = card % 13 + 1 > 7;
+        return slot * 2 + (high == highFirst[slot] ? 0 : 1);
+    }
+};
+
+// 3 bits: next card held, and how many further ones on that side (capped at 2)
+uint32_t sideSignature(uint64_t hand, int suit, int edge, int step) {
+    uint32_t signature = 0;
+    uint32_t further = 0;
+    for (int rank = edge + step; rank >= 1 && rank <= 13; rank += step) {
+        if (!((hand >> (suit * 13 + rank - 1)) & 1)) continue;
+        if (rank == edge + step) signature = 4;
+        else further = std::min(further + 1, 2u);
+    }
+    return signature | further;
+}
+
+Situation situationOf(const GameState& state) {
+    const uint64_t hand = state.hands[state.toMove];
+    std::array<uint32_t, 4> signature{};
+    Situation situation;
+    for (int s = 0; s < 4; ++s) {
+        const uint32_t low = sideSignature(hand, s, state.low[s], -1);
+        const uint32_t high = sideSignature(hand, s, state.high[s], 1);
+        // Both sides have six ranks, so only the unordered pair matters
+        situation.highFirst[s] = high >= low;
+        signature[s] = std::max(low, high) << 3 | std::min(low, high);
+    }
+    std::array<uint8_t, 4> order{{0, 1, 2, 3}};
+    std::stable_sort(order.begin(), order.end(), [&](uint8_t a, uint8_t b) { return signature[a] > signature[b]; });
+
+    situation.key = uint64_t{1} << 63 | static_cast<uint64_t>(state.numPlayers) << 48;
+    std::array<bool, 4> highFirst = situation.highFirst;
+    for (int slot = 0; slot < 4; ++slot) {
+        situation.suit[slot] = order[slot];
+        situation.highFirst[slot] = highFirst[order[slot]];
+        situation.key |= static_cast<uint64_t>(signature[order[slot]]) << (6 * (3 - slot));
+    }
+    return situation;
+}
+
+uint64_t cardsPlayed(const GameState& state) {
+    return static_cast<uint64_t>(GameState::popCount(state.tableMask()) - 4);
+}
+
+// Random deal, dealt as the engines deal
+GameState randomDeal(uint64_t numPlayers, std::mt19937_64& rng) {
+    return GameState::start(numPlayers, dealHands(Deck::shuffled(rng()), numPlayers));
+}
+
+void randomPlayout(GameState& s, std::mt19937_64& rng) {
+    while (!s.over) {
+        const uint64_t legal = s.legalMoves();
+        s.apply(GameState::nthBit(legal, static_cast<int>(rng() % GameState::popCount(legal))));
+    }
+}
+
+struct MoveTally {
+    uint64_t playouts = 0;
+    uint64_t rankSum = 0;
+};
+
+using Tallies = std::unordered_map<uint64_t, std::array<MoveTally, kMoves>>;
+
+} // namespace
+
+OpeningBook::OpeningBook(const std::string& path) : file(path) {
+    if (file.size() < sizeof(BookHeader)) {
+        throw std::runtime_error(path + " is not an opening book");
+    }
+    BookHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.numSlots == 0 || (header.numSlots & (header.numSlots - 1)) != 0) {
+        throw std::runtime_error(path + " is not an opening book");
+    }
+    if (file.size() < sizeof(BookHeader) + header.numSlots * sizeof(BookSlot)) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    played = header.maxPlayed;
+    numEntries = header.numEntries;
+    slotMask = header.numSlots - 1;
+    slots = file.data() + sizeof(BookHeader);
+}
+
+uint64_t OpeningBook::situationKey(const GameState& state) {
+    return situationOf(state).key;
+}
+
+int OpeningBook::lookup(const GameState& state) const {
+    if (cardsPlayed(state) >= played) return -1;
+    const Situation situation = situationOf(state);
+    const auto* table = reinterpret_cast<const BookSlot*>(slots);
+    for (uint64_t i = slotOf(situation.key, slotMask);; i = (i + 1) & slotMask) {
+        if (table[i].key == 0) return -1;
+        if (table[i].key != situation.key) continue;
+        const int card = situation.card(state, table[i].move);
+        const bool legal = card >= 0 && ((state.hands[state.toMove] >> card) & 1);
+        return legal ? card : -1;
+    }
+}
+
+BookStats OpeningBook::build(const std::string& path, const BookConfig& config) {
+    if (config.numPlayers < 2 || config.numPlayers > GameState::kMaxPlayers) {
+        throw std::invalid_argument("Opening book player count must be 2 to 8");
+    }
+
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = static_cast<unsigned>(std::min<uint64_t>(numThreads, std::max<uint64_t>(1, config.games)));
+
+    std::atomic<uint64_t> nextGame{0};
+    std::atomic<uint64_t> playouts{0};
+    std::mutex resultMutex;
+    std::exception_ptr error;
+    Tallies merged;
+
+    auto worker = [&]() {
+        try {
+            Tallies tallies;
+            uint64_t done = 0;
+            for (uint64_t game = nextGame.fetch_add(1); game < config.games; game = nextGame.fetch_add(1)) {
+                // Seeded per game, so the book doesn't depend on the thread count
+                std::mt19937_64 rng(config.seed * 0x9E3779B97F4A7C15ULL + game);
+                GameState s = randomDeal(config.numPlayers, rng);
+                while (!s.over && cardsPlayed(s) < config.maxPlayed) {
+                    const uint64_t legal = s.legalMoves();
+                    if (GameState::popCount(legal) >= 2) {
+                        const Situation situation = situationOf(s);
+                        auto& moves = tallies[situation.key];
+                        for (uint64_t rest = legal; rest; rest &= rest - 1) {
+                            const int card = GameState::lowestBit(rest);
+                            MoveTally& tally = moves[situation.move(card)];
+                            for (uint64_t r = 0; r < config.rollouts; ++r) {
+                                GameState t = s;
+                                t.apply(card);
+                                randomPlayout(t, rng);
+                                ++tally.playouts;
+                                tally.rankSum += t.rank(s.toMove);
+                            }
+                            done += config.rollouts;
+                        }
+                    }
+                    s.apply(GameState::nthBit(legal, static_cast<int>(rng() % GameState::popCount(legal))));
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            for (const auto& [key, moves] : tallies) {
+                auto& total = merged[key];
+                for (int m = 0; m < kMoves; ++m) {
+                    total[m].playouts += moves[m].playouts;
+                    total[m].rankSum += moves[m].rankSum;
+                }
+            }
+            playouts += done;
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (!error) error = std::current_exception();
+            nextGame.store(config.games);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    // Keep situations where every candidate has enough playouts; book move = best mean place
+    std::vector<BookSlot> entries;
+    for (const auto& [key, moves] : merged) {
+        int best = -1;
+        uint64_t samples = UINT64_MAX;
+        for (int m = 0; m < kMoves; ++m) {
+            if (moves[m].playouts == 0) continue;
+            samples = std::min(samples, moves[m].playouts);
+            if (best < 0 || moves[m].rankSum * moves[best].playouts < moves[best].rankSum * moves[m].playouts) {
+                best = m;
+            }
+        }
+        if (best < 0 || samples < config.minSamples) continue;
+        entries.push_back(BookSlot{key, static_cast<uint32_t>(std::min<uint64_t>(samples, UINT32_MAX)),
+                                   static_cast<uint8_t>(best), {}});
+    }
+
+    uint64_t numSlots = 1;
+    while (numSlots < entries.size() * 2) numSlots *= 2;
+    std::vector<BookSlot> table(numSlots, BookSlot{0, 0, 0, {}});
+    for (const BookSlot& entry : entries) {
+        uint64_t i = slotOf(entry.key, numSlots - 1);
+        while (table[i].key != 0) i = (i + 1) & (numSlots - 1);
+        table[i] = entry;
+    }
+
+    BookHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.maxPlayed = config.maxPlayed;
+    header.numSlots = numSlots;
+    header.numEntries = entries.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(numSlots * sizeof(BookSlot)));
+    if (!out) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+
+    BookStats stats;
+    stats.situations = merged.size();
+    stats.entries = entries.size();
+    stats.playouts = playouts.load();
+    stats.bytes = sizeof(header) + numSlots * sizeof(BookSlot);
+    return stats;
+}
+
+std::shared_ptr<const OpeningBook> OpeningBook::shared(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const OpeningBook>> books;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& book = books[path];
+    if (!book) book = std::make_shared<const OpeningBook>(path);
+    return book;
+}
+
+} // namespace sevens
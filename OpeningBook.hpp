@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GameState.hpp"
+#include "MappedFile.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace sevens {
+
+struct BookConfig {
+    uint64_t numPlayers = 4;
+    uint64_t games = 20000;      // simulated games; each early decision in them is sampled
+    uint64_t maxPlayed = 10;     // situations with fewer cards played than this (Yuria's early game)
+    uint64_t rollouts = 8;       // random playouts per candidate move and sample
+    uint64_t minSamples = 64;    // playouts every move needs before a situation is kept
+    unsigned numThreads = 0;     // 0 = one worker per hardware thread
+    uint64_t seed = 1;
+};
+
+struct BookStats {
+    uint64_t situations = 0;     // distinct canonical situations sampled
+    uint64_t entries = 0;        // situations written to the book
+    uint64_t playouts = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Best early moves by canonical situation, read from a memory-mapped file.
+ *
+ * A situation is what the player to move sees, reduced to what matters for
+ * the first few moves and made independent of which suit is which: per suit
+ * and side of the 7, whether the player holds the next card and how many
+ * further ones (capped at 2). Ranks 1..6 mirror 8..13, so the two sides of a
+ * suit are put in a fixed order, and the suits are sorted. A move is then
+ * "slot s, side k" of the sorted suits and means the same card in every deal
+ * of the situation.
+ *
+ * The builder plays random games, and at every early decision with a choice
+ * scores each candidate by random playouts of the actual deal; a situation's
+ * book move is the one with the best mean finishing place. Lookups are one
+ * hash probe in the mapped table.
+ */
+class OpeningBook {
+public:
+    // Maps a book file; throws std::runtime_error
+    explicit OpeningBook(const std::string& path);
+
+    // Card index the book plays for the player to move, or -1 if the situation isn't in it
+    int lookup(const GameState& state) const;
+
+    uint64_t size() const { return numEntries; }
+    uint64_t maxPlayed() const { return played; }
+
+    // Canonical situation of the player to move, with the player count
+    static uint64_t situationKey(const GameState& state);
+
+    // Simulates on all cores and writes the book; throws std::runtime_error
+    static BookStats build(const std::string& path, const BookConfig& config);
+
+    // One book per path for the whole process
+    static std::shared_ptr<const OpeningBook> shared(const std::string& path);
+
+private:
+    MappedFile file;
+    uint64_t played = 0;
+    uint64_t numEntries = 0;
+    uint64_t slotMask = 0;
+    const uint8_t* slots = nullptr;
+};
+
+} // namespace sevens
@@ -0,0 +1,155 @@
+#include "OpponentProfiles.hpp"
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+namespace sevens {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'V', 'N', 'P', 'R', 'O', 'F', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kClaiming = 1;
+// A claim takes a name copy; one still open after this long was left by a dead process
+constexpr auto kClaimTimeout = std::chrono::milliseconds(100);
+
+// File header; the profile table follows at offset sizeof(ProfileHeader)
+struct ProfileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t profileSize;
+    uint64_t capacity;
+    uint64_t reserved[5];
+};
+
+static_assert(sizeof(ProfileHeader) == 64, "profiles start on a cache line");
+static_assert(sizeof(OpponentProfile) == 1024, "profile layout is part of the file format");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && sizeof(std::atomic<uint64_t>) == 8,
+              "mapped counters must be plain lock-free words");
+
+// FNV-1a, kept clear of the free and claiming markers
+uint64_t nameKey(const std::string& name) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 0x100000001B3ULL;
+    }
+    return hash > kClaiming ? hash : hash + 2;
+}
+
+void add(std::atomic<uint64_t>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void OpponentProfile::recordPass(int phase, unsigned openSuits) {
+    add(turns[phase]);
+    add(passes[phase]);
+    for (int suit = 0; suit < 4; ++suit) {
+        if (openSuits & (1u << suit)) add(passesWithSuitOpen[suit]);
+    }
+}
+
+void OpponentProfile::recordPlay(int phase, int cardIndex) {
+    add(turns[phase]);
+    add(plays[cardIndex]);
+    if (phase == 0) add(earlyPlays[cardIndex]);
+}
+
+double OpponentProfile::passRate(int phase) const {
+    const uint64_t total = count(turns[phase]);
+    return total ? static_cast<double>(count(passes[phase])) / static_cast<double>(total) : 0.0;
+}
+
+OpponentProfileStore::OpponentProfileStore(const std::string& path, uint64_t capacity) {
+    file = MappedFile::openForUpdate(path, sizeof(ProfileHeader) + capacity * sizeof(OpponentProfile));
+    auto* header = reinterpret_cast<ProfileHeader*>(file.mutableData());
+
+    static const char zeros[8] = {};
+    if (std::memcmp(header->magic, zeros, sizeof(zeros)) == 0) {
+        // Fresh file: the zero bytes are already an empty table
+        header->version = kVersion;
+        header->profileSize = sizeof(OpponentProfile);
+        header->capacity = capacity;
+        std::memcpy(header->magic, kMagic, sizeof(kMagic));
+    }
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+        header->profileSize != sizeof(OpponentProfile)) {
+        throw std::runtime_error(path + " is not an opponent profile store");
+    }
+    if (file.size() < sizeof(ProfileHeader) + header->capacity * sizeof(OpponentProfile)) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    this->capacity = header->capacity;
+
+    // A process killed between claiming a slot and publishing its key leaves the
+    // claim marker behind; no counter was written yet, so the slot is still free
+    for (uint64_t i = 0; i < this->capacity; ++i) {
+        uint64_t claiming = kClaiming;
+        OpponentProfile* profile = slot(i);
+        if (profile->key.compare_exchange_strong(claiming, 0, std::memory_order_acq_rel)) {
+            std::memset(profile->name, 0, sizeof(profile->name));
+        }
+    }
+}
+
+OpponentProfile* OpponentProfileStore::slot(uint64_t index) const {
+    return reinterpret_cast<OpponentProfile*>(file.mutableData() + sizeof(ProfileHeader)) + index;
+}
+
+OpponentProfile* OpponentProfileStore::lookup(const std::string& name, bool create) const {
+    const uint64_t key = nameKey(name);
+    for (uint64_t probe = 0; probe < capacity; ++probe) {
+        OpponentProfile* profile = slot((key + probe) % capacity);
+        uint64_t current = profile->key.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (!create) return nullptr;
+            if (profile->key.compare_exchange_strong(current, kClaiming, std::memory_order_acq_rel)) {
+                // Ours: write the name, then publish the key
+                std::strncpy(profile->name, name.c_str(), OpponentProfile::kNameLength - 1);
+                profile->key.store(key, std::memory_order_release);
+                return profile;
+            }
+        }
+        // Another thread is claiming this slot, possibly for the same name. If the
+        // claim never completes (its process died), probe on as if the slot were taken
+        const auto deadline = std::chrono::steady_clock::now() + kClaimTimeout;
+        while (current == kClaiming && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+            current = profile->key.load(std::memory_order_acquire);
+        }
+        if (current == key) return profile;
+    }
+    return nullptr;
+}
+
+OpponentProfile* OpponentProfileStore::profile(const std::string& name) {
+    return lookup(name, true);
+}
+
+const OpponentProfile* OpponentProfileStore::find(const std::string& name) const {
+    return lookup(name, false);
+}
+
+std::vector<const OpponentProfile*> OpponentProfileStore::profiles() const {
+    std::vector<const OpponentProfile*> used;
+    for (uint64_t i = 0; i < capacity; ++i) {
+        if (slot(i)->key.load(std::memory_order_acquire) > kClaiming) used.push_back(slot(i));
+    }
+    return used;
+}
+
+std::shared_ptr<OpponentProfileStore> OpponentProfileStore::shared(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<OpponentProfileStore>> stores;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& store = stores[path];
+    if (!store) store = std::make_shared<OpponentProfileStore>(path);
+    return store;
+}
+
+} // namespace sevens
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MappedFile.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * What has been seen of one strategy (by getName()) over all games, as
+ * counters updated in place with relaxed atomic adds. Phases follow Yuria:
+ * 0 = fewer than 10 cards played, 1 = fewer than 30, 2 = the rest.
+ */
+struct alignas(64) OpponentProfile {
+    static constexpr size_t kNameLength = 56;
+
+    std::atomic<uint64_t> key;                       // name hash; 0 = free, 1 = being claimed
+    char name[kNameLength];                          // zero-terminated, truncated
+    std::atomic<uint64_t> games;
+    std::atomic<uint64_t> turns[3];                  // by phase
+    std::atomic<uint64_t> passes[3];                 // by phase
+    std::atomic<uint64_t> passesWithSuitOpen[4];     // passes while the suit had a playable card
+    std::atomic<uint64_t> plays[52];                 // by card index suit * 13 + rank - 1
+    std::atomic<uint64_t> earlyPlays[52];            // the same, in phase 0 only
+    uint64_t reserved[5];
+
+    static int phaseOf(int cardsPlayed) { return cardsPlayed < 10 ? 0 : (cardsPlayed < 30 ? 1 : 2); }
+
+    // openSuits: bit s set when suit s had a playable card at the time of the pass
+    void recordPass(int phase, unsigned openSuits);
+    void recordPlay(int phase, int cardIndex);
+
+    uint64_t count(const std::atomic<uint64_t>& counter) const { return counter.load(std::memory_order_relaxed); }
+    // Share of the turns in a phase that were passes (0 without data)
+    double passRate(int phase) const;
+};
+
+/**
+ * Opponent profiles in a memory-mapped file, so they outlive the process and
+ * every game of the process shares them without locks or copies.
+ *
+ * The file is a 64-byte header and a fixed table of profiles, found by
+ * open addressing on a 64-bit hash of the name (names that collide share a
+ * profile). A free slot is claimed with one compare-exchange; after that all
+ * updates are atomic adds on the mapped counters. Claims left unfinished by a
+ * killed process are released when the store is opened, and lookups wait for
+ * a claim only for a bounded time.
+ */
+class OpponentProfileStore {
+public:
+    static constexpr uint64_t kDefaultCapacity = 1024;
+
+    // Opens the store, creating it with room for capacity profiles if needed; throws std::runtime_error
+    explicit OpponentProfileStore(const std::string& path, uint64_t capacity = kDefaultCapacity);
+
+    // Profile of a strategy name, created on first use; nullptr when the table is full
+    OpponentProfile* profile(const std::string& name);
+    const OpponentProfile* find(const std::string& name) const;
+
+    // Every profile in use, in table order
+    std::vector<const OpponentProfile*> profiles() const;
+
+    const std::string& fileName() const { return file.fileName(); }
+
+    // One store per path for the whole process (strategies of all games share it)
+    static std::shared_ptr<OpponentProfileStore> shared(const std::string& path);
+
+private:
+    OpponentProfile* slot(uint64_t index) const;
+    OpponentProfile* lookup(const std::string& name, bool create) const;
+
+    MappedFile file;
+    uint64_t capacity = 0;
+};
+
+} // namespace sevens
@@ -3,6 +3,8 @@
 #include "Generic_card_parser.hpp"
 #include <vector>
 #include <memory>
+#include <functional>
+#include <string>
 
 namespace sevens {
 
@@ -33,7 +35,91 @@ public:
     virtual std::string getName() const = 0;
 };
 
+/**
+ * Optional interface for strategies that want to know who they play against.
+ * Engines call it before initialize() with getName() of the strategy in every
+ * seat (names[playerID]; empty for a seat without one). Separate from
+ * PlayerStrategy, like EventLogReader, so existing libraries stay compatible.
+ */
+class SeatNamesReader {
+public:
+    virtual ~SeatNamesReader() = default;
+    virtual void setSeatNames(const std::vector<std::string>& names) = 0;
+};
+
+/**
+ * Optional interface for seats whose implementation can change between games,
+ * such as a library that is reloaded while a tournament runs. Engines read it
+ * after initialize() and tag the game with the version that played it.
+ */
+class VersionedStrategy {
+public:
+    virtual ~VersionedStrategy() = default;
+    virtual uint64_t strategyVersion() const = 0;
+};
+
+/**
+ * Optional interface for seats that want to know when a deal starts. A
+ * duplicate deal is played once per seat rotation; engines call beginDeal()
+ * before the first of those games, so a seat can keep whatever must stay the
+ * same for the whole rotation (such as its VersionedStrategy version).
+ */
+class DealListener {
+public:
+    virtual ~DealListener() = default;
+    virtual void beginDeal(uint64_t deal) = 0;
+};
+
+/**
+ * Optional interface for strategies that can copy a prototype. A copy shares
+ * the prototype's read-only data (weights, books, tables) and gets its own
+ * game state and random seed, so many instances cost one construction.
+ * Libraries expose it as extern "C" cloneStrategy(prototype), which returns
+ * nullptr when the prototype can't be copied; the loader only needs that
+ * symbol, no RTTI across the library boundary.
+ */
+class CloneableStrategy {
+public:
+    virtual ~CloneableStrategy() = default;
+    virtual PlayerStrategy* clone() const = 0;
+};
+
+/**
+ * One decision waiting in one of many games: the seat's own instance and what
+ * selectCardToPlay would be given, plus the same position as bitmasks
+ * (GameState card indices: the cards in hand, the cards on the table).
+ */
+struct PendingDecision {
+    PlayerStrategy* strategy;
+    uint64_t playerID;
+    const std::vector<Card>* hand;
+    const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>* tableLayout;
+    uint64_t handMask;
+    uint64_t tableMask;
+};
+
+// Fills moves[i] for decisions[i], with selectCardToPlay's meaning (index in hand, -1 to pass)
+typedef void (*DecideBatchFn)(const PendingDecision* decisions, int* moves, size_t count);
+
+/**
+ * Optional interface for strategies that decide for many games in one call.
+ * An engine running several games on a thread gathers the decisions whose
+ * strategies return the same entry point and calls it once for all of them,
+ * so a library can evaluate them together instead of paying a virtual call
+ * and its setup per decision. Every strategy in such a batch is an instance
+ * of the library that returned the entry point.
+ */
+class BatchDecider {
+public:
+    virtual ~BatchDecider() = default;
+    virtual DecideBatchFn batchEntryPoint() const = 0;
+};
+
 // Type for strategy factory functions (for dynamic loading)
 typedef PlayerStrategy* (*CreateStrategyFn)();
+typedef PlayerStrategy* (*CloneStrategyFn)(const PlayerStrategy* prototype);
+
+// Produces a fresh, independent strategy instance (one per worker thread in batch runs)
+using StrategyFactory = std::function<std::shared_ptr<PlayerStrategy>()>;
 
 } // namespace sevens
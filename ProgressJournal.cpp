@@ -0,0 +1,260 @@
+#include "ProgressJournal.hpp"
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace sevens {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'V', 'N', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t kMaxRecord = 1 << 26;
+
+enum RecordType : uint8_t {
+    kIdentity = 1,
+    kRange = 2,           // a finished range, as written before library versions were counted
+    kRangeVersions = 3,   // the same with games per library version after the length counts
+};
+
+uint32_t crc32(const std::string& bytes) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char b : bytes) crc = table[(crc ^ b) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Little-endian fields of a record payload
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+void putF64(std::string& out, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(out, bits);
+}
+
+void putWelford(std::string& out, const Welford& w) {
+    putU64(out, w.count);
+    putF64(out, w.mean);
+    putF64(out, w.m2);
+}
+
+// Counters are mostly zero: stored as (index, value) pairs of the non-zero ones
+void putSparse(std::string& out, const std::vector<uint64_t>& counts) {
+    uint64_t used = 0;
+    for (uint64_t c : counts) used += c != 0;
+    putU64(out, used);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0) continue;
+        putU64(out, i);
+        putU64(out, counts[i]);
+    }
+}
+
+class PayloadReader {
+public:
+    explicit PayloadReader(const std::string& bytes) : bytes(bytes) {}
+
+    uint64_t u64() {
+        if (bytes.size() - offset < 8) throw std::runtime_error("short record");
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[offset++])) << (8 * i);
+        return value;
+    }
+    double f64() {
+        const uint64_t bits = u64();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    Welford welford() {
+        Welford w;
+        w.count = u64();
+        w.mean = f64();
+        w.m2 = f64();
+        return w;
+    }
+    bool atEnd() const { return offset == bytes.size(); }
+    uint8_t type() const { return static_cast<uint8_t>(bytes[0]); }
+    void sparse(std::vector<uint64_t>& counts) {
+        const uint64_t used = u64();
+        for (uint64_t i = 0; i < used; ++i) {
+            const uint64_t index = u64();
+            const uint64_t value = u64();
+            if (index < counts.size()) counts[index] = value;
+        }
+    }
+
+private:
+    const std::string& bytes;
+    size_t offset = 1;   // after the record type
+};
+
+std::string frame(const std::string& payload) {
+    std::string record;
+    const uint32_t length = static_cast<uint32_t>(payload.size());
+    const uint32_t crc = crc32(payload);
+    for (int i = 0; i < 4; ++i) record.push_back(static_cast<char>(length >> (8 * i)));
+    for (int i = 0; i < 4; ++i) record.push_back(static_cast<char>(crc >> (8 * i)));
+    return record + payload;
+}
+
+// Next intact record from the file, or false at the end or at a torn/corrupt record
+bool readRecord(std::FILE* in, std::string& payload) {
+    unsigned char header[8];
+    if (std::fread(header, 1, sizeof(header), in) != sizeof(header)) return false;
+    uint32_t length = 0;
+    uint32_t crc = 0;
+    for (int i = 0; i < 4; ++i) {
+        length |= static_cast<uint32_t>(header[i]) << (8 * i);
+        crc |= static_cast<uint32_t>(header[4 + i]) << (8 * i);
+    }
+    if (length == 0 || length > kMaxRecord) return false;
+    payload.resize(length);
+    if (std::fread(&payload[0], 1, length, in) != length) return false;
+    return crc32(payload) == crc;
+}
+
+} // namespace
+
+std::string ProgressJournal::batchIdentity(const std::vector<std::string>& names, uint64_t seed, uint64_t numDeals,
+                                           uint64_t chunkDeals, bool duplicate) {
+    std::ostringstream identity;
+    identity << "batch seed=" << seed << " deals=" << numDeals << " chunk=" << chunkDeals
+             << " duplicate=" << (duplicate ? 1 : 0) << " strategies=";
+    for (size_t s = 0; s < names.size(); ++s) identity << (s ? "," : "") << names[s];
+    return identity.str();
+}
+
+ProgressJournal::ProgressJournal(const std::string& path, const std::string& identity, size_t numStrategies)
+    : path(path), numStrategies(numStrategies), deals(numStrategies), statistics(numStrategies)
+{
+    bool fresh = true;
+    if (std::FILE* in = std::fopen(path.c_str(), "rb")) {
+        char magic[sizeof(kMagic)] = {};
+        const size_t got = std::fread(magic, 1, sizeof(magic), in);
+        std::string payload;
+        uint64_t good = 0;
+        if (got == sizeof(magic) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 &&
+            readRecord(in, payload) && payload[0] == kIdentity) {
+            if (payload.substr(1) != identity) {
+                std::fclose(in);
+                throw std::runtime_error(path + " belongs to a different run (" + payload.substr(1) + ")");
+            }
+            fresh = false;
+            good = static_cast<uint64_t>(std::ftell(in));
+            while (readRecord(in, payload)) {
+                if (payload[0] != kRange && payload[0] != kRangeVersions) break;
+                try {
+                    PayloadReader record(payload);
+                    const uint64_t first = record.u64();
+                    const uint64_t end = record.u64();
+
+                    DealTotals rangeDeals(numStrategies);
+                    rangeDeals.deals = record.u64();
+                    rangeDeals.games = record.u64();
+                    for (size_t s = 0; s < numStrategies; ++s) {
+                        rangeDeals.meanRank[s] = record.welford();
+                        rangeDeals.relativeScore[s] = record.welford();
+                    }
+
+                    ResultTotals rangeStatistics(numStrategies);
+                    rangeStatistics.games = record.u64();
+                    rangeStatistics.turns = record.u64();
+                    rangeStatistics.passes = record.u64();
+                    rangeStatistics.deadlocked = record.u64();
+                    record.sparse(rangeStatistics.rankCounts);
+                    record.sparse(rangeStatistics.lengthCounts);
+                    if (record.type() == kRangeVersions) record.sparse(rangeStatistics.versionCounts);
+                    for (size_t s = 0; s < numStrategies; ++s) {
+                        rangeStatistics.rank[s] = record.welford();
+                        rangeStatistics.relativeScore[s] = record.welford();
+                    }
+                    if (!record.atEnd()) throw std::runtime_error("long record");
+
+                    ranges.emplace(first, end);
+                    deals.merge(rangeDeals);
+                    statistics.merge(rangeStatistics);
+                }
+                catch (const std::runtime_error&) {
+                    break;
+                }
+                good = static_cast<uint64_t>(std::ftell(in));
+            }
+        } else if (got > 0) {
+            std::fclose(in);
+            throw std::runtime_error(path + " is not a progress journal");
+        }
+        std::fclose(in);
+
+        // Cut a torn tail so new records follow the last intact one
+        const uint64_t size = std::filesystem::file_size(path);
+        if (!fresh && good < size) {
+            discarded = size - good;
+            std::filesystem::resize_file(path, good);
+        }
+    }
+
+    file = std::fopen(path.c_str(), fresh ? "wb" : "ab");
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    if (fresh) {
+        std::string payload(1, static_cast<char>(kIdentity));
+        payload += identity;
+        const std::string record = frame(payload);
+        if (std::fwrite(kMagic, 1, sizeof(kMagic), file) != sizeof(kMagic) ||
+            std::fwrite(record.data(), 1, record.size(), file) != record.size() || std::fflush(file) != 0) {
+            throw std::runtime_error("Cannot write " + path);
+        }
+    }
+}
+
+ProgressJournal::~ProgressJournal() {
+    if (file) std::fclose(file);
+}
+
+void ProgressJournal::append(uint64_t first, uint64_t end, const DealTotals& rangeDeals,
+                             const ResultTotals& rangeStatistics) {
+    std::string payload(1, static_cast<char>(kRangeVersions));
+    putU64(payload, first);
+    putU64(payload, end);
+
+    putU64(payload, rangeDeals.deals);
+    putU64(payload, rangeDeals.games);
+    for (size_t s = 0; s < numStrategies; ++s) {
+        putWelford(payload, s < rangeDeals.meanRank.size() ? rangeDeals.meanRank[s] : Welford{});
+        putWelford(payload, s < rangeDeals.relativeScore.size() ? rangeDeals.relativeScore[s] : Welford{});
+    }
+
+    putU64(payload, rangeStatistics.games);
+    putU64(payload, rangeStatistics.turns);
+    putU64(payload, rangeStatistics.passes);
+    putU64(payload, rangeStatistics.deadlocked);
+    putSparse(payload, rangeStatistics.rankCounts);
+    putSparse(payload, rangeStatistics.lengthCounts);
+    putSparse(payload, rangeStatistics.versionCounts);
+    for (size_t s = 0; s < numStrategies; ++s) {
+        putWelford(payload, s < rangeStatistics.rank.size() ? rangeStatistics.rank[s] : Welford{});
+        putWelford(payload, s < rangeStatistics.relativeScore.size() ? rangeStatistics.relativeScore[s] : Welford{});
+    }
+
+    const std::string record = frame(payload);
+    if (std::fwrite(record.data(), 1, record.size(), file) != record.size() || std::fflush(file) != 0) {
+        throw std::runtime_error("Cannot append to " + path);
+    }
+    ranges.emplace(first, end);
+}
+
+} // namespace sevens
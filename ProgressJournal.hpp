@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ResultStats.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Append-only record of a long run's finished deal ranges, for resuming it.
+ *
+ * The file is a magic number and a sequence of records, each framed as
+ * [length u32][CRC-32 u32][payload]. The first record names the run (strategies,
+ * seed, deal count, chunk size); every later one is a finished range of deals
+ * with its per-deal totals and game statistics. Range records from before
+ * games per library version were counted have their own record type and are
+ * still read. Opening an existing journal replays the records and merges
+ * them; a torn or corrupt tail (the process died mid-write) is cut off, so at
+ * most the ranges being written are lost.
+ * Each record is flushed to the OS as it is appended, which survives the
+ * process being killed at the cost of one write per range.
+ */
+class ProgressJournal {
+public:
+    /**
+     * Opens the journal at path for the run described by identity, creating
+     * it if missing. Throws std::runtime_error if it belongs to another run.
+     */
+    ProgressJournal(const std::string& path, const std::string& identity, size_t numStrategies);
+    ~ProgressJournal();
+
+    ProgressJournal(const ProgressJournal&) = delete;
+    ProgressJournal& operator=(const ProgressJournal&) = delete;
+
+    // What earlier runs finished: [first, end) ranges and their merged totals
+    const std::set<std::pair<uint64_t, uint64_t>>& completedRanges() const { return ranges; }
+    const DealTotals& completedDeals() const { return deals; }
+    const ResultTotals& completedStatistics() const { return statistics; }
+    bool isComplete(uint64_t first, uint64_t end) const { return ranges.count({first, end}) > 0; }
+
+    // Records a finished range; callers serialize appends. Throws std::runtime_error.
+    void append(uint64_t first, uint64_t end, const DealTotals& rangeDeals, const ResultTotals& rangeStatistics);
+
+    // Bytes of a damaged tail dropped when the journal was opened
+    uint64_t discardedBytes() const { return discarded; }
+
+    // Identity of a duplicate match; runs with the same identity play the same deals
+    static std::string batchIdentity(const std::vector<std::string>& names, uint64_t seed, uint64_t numDeals,
+                                     uint64_t chunkDeals, bool duplicate);
+
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+    size_t numStrategies;
+    std::set<std::pair<uint64_t, uint64_t>> ranges;
+    DealTotals deals;
+    ResultTotals statistics;
+    uint64_t discarded = 0;
+};
+
+} // namespace sevens
@@ -1,4 +1,5 @@
 #include "RandomStrategy.hpp"
+#include "GameState.hpp"
 #include <algorithm>
 #include <vector>
 #include <chrono>
@@ -48,14 +49,15 @@ int RandomStrategy::selectCardToPlay(
                 canPlay = true;
             }
         }
-        else if (r > 1 && tableLayout.count(s) > 0) {
+        if (!canPlay && r != 7 && r > 1 && tableLayout.count(s) > 0) {
             auto& suitLayout = tableLayout.at(s);
             if (suitLayout.count(r - 1) > 0 && suitLayout.at(r - 1) &&
                 (suitLayout.count(r) == 0 || !suitLayout.at(r))) {
                 canPlay = true;
             }
         }
-        else if (r < 13 && tableLayout.count(s) > 0) {
+        // Checked separately: a card below 7 is reached from its upper neighbour
+        if (!canPlay && r != 7 && r < 13 && tableLayout.count(s) > 0) {
             auto& suitLayout = tableLayout.at(s);
             if (suitLayout.count(r + 1) > 0 && suitLayout.at(r + 1) &&
                 (suitLayout.count(r) == 0 || !suitLayout.at(r))) {
@@ -77,6 +79,53 @@ int RandomStrategy::selectCardToPlay(
     return validMoves[randomIndex];
 }
 
+namespace {
+
+constexpr uint64_t kRankOne = uint64_t{1} | uint64_t{1} << 13 | uint64_t{1} << 26 | uint64_t{1} << 39;
+constexpr uint64_t kRankThirteen = kRankOne << 12;
+
+// Cards next to the table in their suit, which are the ones that can be laid
+uint64_t playableCells(uint64_t table) {
+    const uint64_t up = (table & ~kRankThirteen) << 1;
+    const uint64_t down = (table & ~kRankOne) >> 1;
+    return (up | down) & ~table & GameState::kAllCards;
+}
+
+} // namespace
+
+DecideBatchFn RandomStrategy::batchEntryPoint() const {
+    return &RandomStrategy::decideBatch;
+}
+
+void RandomStrategy::decideBatch(const PendingDecision* decisions, int* moves, size_t count) {
+    // Legal cards of every decision first, in a branch-free loop the compiler can vectorise
+    thread_local std::vector<uint64_t> playable;
+    playable.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        playable[i] = playableCells(decisions[i].tableMask) & decisions[i].handMask;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t legal = playable[i];
+        if (!legal) {
+            moves[i] = -1;
+            continue;
+        }
+        auto* self = static_cast<RandomStrategy*>(decisions[i].strategy);
+        std::uniform_int_distribution<int> dist(0, GameState::popCount(legal) - 1);
+        const Card card = GameState::cardAt(GameState::nthBit(legal, dist(self->rng)));
+
+        const std::vector<Card>& hand = *decisions[i].hand;
+        moves[i] = -1;
+        for (int h = 0; h < static_cast<int>(hand.size()); ++h) {
+            if (hand[h].suit == card.suit && hand[h].rank == card.rank) {
+                moves[i] = h;
+                break;
+            }
+        }
+    }
+}
+
 void RandomStrategy::observeMove(uint64_t /*playerID*/, const Card& /*playedCard*/) {
 }
 
@@ -84,7 +133,7 @@ void RandomStrategy::observePass(uint64_t /*playerID*/) {
 }
 
 std::string RandomStrategy::getName() const {
-    return "RandomStrategy";
+    return kName;
 }
 
 
@@ -8,9 +8,12 @@ namespace sevens {
 
 /**
  * A simple strategy that selects a random playable card.
+ * Also decides in batches (BatchDecider), from the position bitmasks.
  */
-class RandomStrategy : public PlayerStrategy {
+class RandomStrategy final : public PlayerStrategy, public BatchDecider {
 public:
+    static constexpr const char* kName = "RandomStrategy";
+
     RandomStrategy();
     ~RandomStrategy() override = default;
     
@@ -22,6 +25,10 @@ public:
     void observeMove(uint64_t playerID, const Card& playedCard) override;
     void observePass(uint64_t playerID) override;
     std::string getName() const override;
+
+    DecideBatchFn batchEntryPoint() const override;
+    // Every decisions[i].strategy is a RandomStrategy; each draws from its own generator
+    static void decideBatch(const PendingDecision* decisions, int* moves, size_t count);
     
 private:
     uint64_t myID;
@@ -0,0 +1,217 @@
+#include "ResultStats.hpp"
+#include "BatchRunner.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace sevens {
+
+namespace {
+
+constexpr size_t kSeats = GameState::kMaxPlayers;
+
+// Single-writer increment: the owner is the only thread that stores
+void bump(std::atomic<uint64_t>& counter, uint64_t value = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+ResultTotals::ResultTotals(size_t numStrategies)
+    : numStrategies(numStrategies),
+      rankCounts(numStrategies * kSeats * kSeats, 0),
+      rank(numStrategies),
+      relativeScore(numStrategies),
+      lengthCounts(kMaxTurns + 1, 0),
+      versionCounts(numStrategies * kMaxVersions, 0)
+{
+}
+
+void ResultTotals::merge(const ResultTotals& other) {
+    if (numStrategies == 0) {
+        *this = other;
+        return;
+    }
+    games += other.games;
+    turns += other.turns;
+    passes += other.passes;
+    deadlocked += other.deadlocked;
+    for (size_t i = 0; i < rankCounts.size() && i < other.rankCounts.size(); ++i) {
+        rankCounts[i] += other.rankCounts[i];
+    }
+    for (size_t s = 0; s < numStrategies && s < other.numStrategies; ++s) {
+        rank[s].merge(other.rank[s]);
+        relativeScore[s].merge(other.relativeScore[s]);
+    }
+    for (size_t i = 0; i < lengthCounts.size() && i < other.lengthCounts.size(); ++i) {
+        lengthCounts[i] += other.lengthCounts[i];
+    }
+    for (size_t i = 0; i < versionCounts.size() && i < other.versionCounts.size(); ++i) {
+        versionCounts[i] += other.versionCounts[i];
+    }
+}
+
+Welford ResultTotals::seatRank(size_t strategy, size_t seat) const {
+    Welford total;
+    for (uint64_t r = 1; r <= kSeats; ++r) {
+        // Every game at one rank is a run with that mean and no spread
+        const uint64_t count = rankCount(strategy, seat, r);
+        total.merge(Welford{count, static_cast<double>(r), 0.0});
+    }
+    return total;
+}
+
+uint64_t ResultTotals::lengthQuantile(double q) const {
+    uint64_t total = 0;
+    for (uint64_t count : lengthCounts) total += count;
+    if (total == 0) return 0;
+    const double target = std::max(1.0, q * static_cast<double>(total));
+    uint64_t seen = 0;
+    for (size_t length = 0; length < lengthCounts.size(); ++length) {
+        seen += lengthCounts[length];
+        if (static_cast<double>(seen) >= target) return length;
+    }
+    return kMaxTurns;
+}
+
+void DealTotals::add(const DealResult& deal) {
+    ++deals;
+    games += deal.games;
+    for (size_t s = 0; s < meanRank.size() && s < deal.meanRank.size(); ++s) {
+        meanRank[s].add(deal.meanRank[s]);
+        relativeScore[s].add(deal.relativeScore[s]);
+    }
+}
+
+void DealTotals::merge(const DealTotals& other) {
+    if (meanRank.empty()) {
+        *this = other;
+        return;
+    }
+    deals += other.deals;
+    games += other.games;
+    for (size_t s = 0; s < meanRank.size() && s < other.meanRank.size(); ++s) {
+        meanRank[s].merge(other.meanRank[s]);
+        relativeScore[s].merge(other.relativeScore[s]);
+    }
+}
+
+StatsShard::StatsShard(size_t numStrategies)
+    : numStrategies(numStrategies),
+      rankCounts(numStrategies * kSeats * kSeats),
+      lengthCounts(ResultTotals::kMaxTurns + 1),
+      versionCounts(numStrategies * ResultTotals::kMaxVersions),
+      welfordCounts(numStrategies * 2),
+      welfordMeans(numStrategies * 2),
+      welfordM2(numStrategies * 2)
+{
+}
+
+// Odd sequence = record in progress; readers retry until they see the same even value twice
+template <typename F>
+void StatsShard::write(F&& update) {
+    const uint64_t start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    update();
+    sequence.store(start + 2, std::memory_order_release);
+}
+
+void StatsShard::recordGame(const GameRecord& game) {
+    write([&]() {
+        bump(games);
+        bump(turns, game.turns);
+        bump(passes, game.passes);
+        if (game.deadlocked) bump(deadlocked);
+        bump(lengthCounts[std::min<uint64_t>(game.turns, ResultTotals::kMaxTurns)]);
+        for (size_t seat = 0; seat < game.numPlayers && seat < kSeats; ++seat) {
+            const uint64_t s = game.strategy[seat];
+            const uint64_t r = game.rank[seat];
+            if (s >= numStrategies || r < 1 || r > kSeats) continue;
+            bump(rankCounts[(s * kSeats + seat) * kSeats + r - 1]);
+            bump(versionCounts[s * ResultTotals::kMaxVersions +
+                               std::min<uint64_t>(game.version[seat], ResultTotals::kMaxVersions - 1)]);
+
+            Welford w{welfordCounts[s].load(std::memory_order_relaxed),
+                      welfordMeans[s].load(std::memory_order_relaxed),
+                      welfordM2[s].load(std::memory_order_relaxed)};
+            w.add(static_cast<double>(r));
+            welfordCounts[s].store(w.count, std::memory_order_relaxed);
+            welfordMeans[s].store(w.mean, std::memory_order_relaxed);
+            welfordM2[s].store(w.m2, std::memory_order_relaxed);
+        }
+    });
+}
+
+void StatsShard::recordDeal(const DealResult& deal) {
+    write([&]() {
+        for (size_t s = 0; s < numStrategies && s < deal.relativeScore.size(); ++s) {
+            const size_t i = numStrategies + s;
+            Welford w{welfordCounts[i].load(std::memory_order_relaxed),
+                      welfordMeans[i].load(std::memory_order_relaxed),
+                      welfordM2[i].load(std::memory_order_relaxed)};
+            w.add(deal.relativeScore[s]);
+            welfordCounts[i].store(w.count, std::memory_order_relaxed);
+            welfordMeans[i].store(w.mean, std::memory_order_relaxed);
+            welfordM2[i].store(w.m2, std::memory_order_relaxed);
+        }
+    });
+}
+
+ResultTotals StatsShard::read() const {
+    ResultTotals totals(numStrategies);
+    for (;;) {
+        const uint64_t start = sequence.load(std::memory_order_acquire);
+        if (start & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        totals.games = games.load(std::memory_order_relaxed);
+        totals.turns = turns.load(std::memory_order_relaxed);
+        totals.passes = passes.load(std::memory_order_relaxed);
+        totals.deadlocked = deadlocked.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < rankCounts.size(); ++i) {
+            totals.rankCounts[i] = rankCounts[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < lengthCounts.size(); ++i) {
+            totals.lengthCounts[i] = lengthCounts[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < versionCounts.size(); ++i) {
+            totals.versionCounts[i] = versionCounts[i].load(std::memory_order_relaxed);
+        }
+        for (size_t s = 0; s < numStrategies; ++s) {
+            for (size_t kind = 0; kind < 2; ++kind) {
+                const size_t i = kind * numStrategies + s;
+                Welford& w = kind == 0 ? totals.rank[s] : totals.relativeScore[s];
+                w.count = welfordCounts[i].load(std::memory_order_relaxed);
+                w.mean = welfordMeans[i].load(std::memory_order_relaxed);
+                w.m2 = welfordM2[i].load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == start) return totals;
+    }
+}
+
+ResultStats::ResultStats(size_t numStrategies) : numStrategies(numStrategies), absorbed(numStrategies) {}
+
+StatsShard& ResultStats::claimShard() {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    shards.push_back(std::make_unique<StatsShard>(numStrategies));
+    return *shards.back();
+}
+
+void ResultStats::absorb(const ResultTotals& totals) {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    absorbed.merge(totals);
+}
+
+ResultTotals ResultStats::snapshot() const {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    ResultTotals totals = absorbed;
+    for (const auto& shard : shards) {
+        totals.merge(shard->read());
+    }
+    return totals;
+}
+
+} // namespace sevens
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "GameState.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sevens {
+
+struct DealResult;
+
+// Running mean and variance (Welford); merge() combines two runs exactly (Chan et al.)
+struct Welford {
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    void add(double x) {
+        ++count;
+        const double delta = x - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (x - mean);
+    }
+
+    void merge(const Welford& other) {
+        if (other.count == 0) return;
+        const double total = static_cast<double>(count + other.count);
+        const double delta = other.mean - mean;
+        mean += delta * static_cast<double>(other.count) / total;
+        m2 += other.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) / total;
+        count += other.count;
+    }
+
+    double variance() const { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+};
+
+// One finished game as the engines report it; strategy[seat] is filled in by the caller
+struct GameRecord {
+    uint64_t numPlayers = 0;
+    uint64_t turns = 0;
+    uint64_t passes = 0;
+    bool deadlocked = false;
+    std::array<uint64_t, GameState::kMaxPlayers> rank{};       // per seat
+    std::array<uint64_t, GameState::kMaxPlayers> strategy{};   // per seat
+    std::array<uint64_t, GameState::kMaxPlayers> version{};    // per seat, 0 = not a reloadable library
+};
+
+/**
+ * Totals of a run: plain values, merged associatively. rankCounts is indexed
+ * [(strategy * kMaxPlayers + seat) * kMaxPlayers + rank - 1]; game lengths
+ * in turns are counted exactly up to kMaxTurns, longer games in the last bucket.
+ * versionCounts is indexed [strategy * kMaxVersions + version] the same way.
+ */
+struct ResultTotals {
+    static constexpr size_t kMaxTurns = 512;
+    static constexpr size_t kMaxVersions = 64;
+
+    size_t numStrategies = 0;
+    uint64_t games = 0;
+    uint64_t turns = 0;
+    uint64_t passes = 0;
+    uint64_t deadlocked = 0;
+    std::vector<uint64_t> rankCounts;
+    std::vector<Welford> rank;            // per strategy, over games
+    std::vector<Welford> relativeScore;   // per strategy, over deals
+    std::vector<uint64_t> lengthCounts;
+    std::vector<uint64_t> versionCounts;  // games per strategy and library version
+
+    explicit ResultTotals(size_t numStrategies = 0);
+
+    void merge(const ResultTotals& other);
+
+    uint64_t rankCount(size_t strategy, size_t seat, uint64_t rank) const {
+        return rankCounts[(strategy * GameState::kMaxPlayers + seat) * GameState::kMaxPlayers + rank - 1];
+    }
+    uint64_t versionCount(size_t strategy, uint64_t version) const {
+        return versionCounts[strategy * kMaxVersions + std::min<uint64_t>(version, kMaxVersions - 1)];
+    }
+    // Mean rank and variance of one strategy in one seat, from the histogram
+    Welford seatRank(size_t strategy, size_t seat) const;
+
+    double passRate() const { return turns ? static_cast<double>(passes) / static_cast<double>(turns) : 0.0; }
+    double deadlockRate() const { return games ? static_cast<double>(deadlocked) / static_cast<double>(games) : 0.0; }
+
+    // Smallest game length (turns) that at least fraction q of the games don't exceed
+    uint64_t lengthQuantile(double q) const;
+};
+
+/**
+ * Per-deal outcome of a run (each deal's mean rank and relative score per
+ * strategy), as running moments so that it can be merged and stored compactly.
+ */
+struct DealTotals {
+    uint64_t deals = 0;
+    uint64_t games = 0;
+    std::vector<Welford> meanRank;        // per strategy, over deals
+    std::vector<Welford> relativeScore;   // per strategy, over deals
+
+    explicit DealTotals(size_t numStrategies = 0) : meanRank(numStrategies), relativeScore(numStrategies) {}
+
+    void add(const DealResult& deal);
+    void merge(const DealTotals& other);
+};
+
+/**
+ * Statistics of one worker. Only the owning thread records (relaxed stores,
+ * no locked instruction, nothing shared with other workers). Readers copy the
+ * shard under a sequence counter and retry if a record was in progress, so
+ * they never hold the writer up.
+ */
+class StatsShard {
+public:
+    explicit StatsShard(size_t numStrategies);
+
+    void recordGame(const GameRecord& game);
+    void recordDeal(const DealResult& deal);
+
+    // Consistent copy; safe from any thread while the owner keeps recording
+    ResultTotals read() const;
+
+private:
+    template <typename F>
+    void write(F&& update);
+
+    size_t numStrategies;
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> games{0};
+    std::atomic<uint64_t> turns{0};
+    std::atomic<uint64_t> passes{0};
+    std::atomic<uint64_t> deadlocked{0};
+    std::vector<std::atomic<uint64_t>> rankCounts;
+    std::vector<std::atomic<uint64_t>> lengthCounts;
+    std::vector<std::atomic<uint64_t>> versionCounts;
+    // Welford state per strategy: count, mean, m2 (ranks, then relative scores)
+    std::vector<std::atomic<uint64_t>> welfordCounts;
+    std::vector<std::atomic<double>> welfordMeans;
+    std::vector<std::atomic<double>> welfordM2;
+};
+
+/**
+ * Live statistics of a batch. Each worker claims its own shard once and then
+ * records without contention; snapshot() merges the shards at any time, during
+ * the run or after it.
+ */
+class ResultStats {
+public:
+    explicit ResultStats(size_t numStrategies);
+
+    StatsShard& claimShard();
+    ResultTotals snapshot() const;
+
+    // Adds totals recorded elsewhere (a finished chunk, a resumed run) to every later snapshot
+    void absorb(const ResultTotals& totals);
+
+    size_t strategies() const { return numStrategies; }
+
+private:
+    size_t numStrategies;
+    mutable std::mutex shardsMutex;   // guards the list only, never a record
+    std::vector<std::unique_ptr<StatsShard>> shards;
+    ResultTotals absorbed;
+};
+
+} // namespace sevens
@@ -0,0 +1,212 @@
+#include "SelfPlay.hpp"
+#include "BatchRunner.hpp"
+#include "FeatureEvaluator.hpp"
+#include "MyGameMapper.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace sevens {
+
+namespace {
+
+enum Column : size_t {
+    ColGame, ColTurn, ColSeat, ColPlayers, ColStrategy,
+    ColHand, ColTable, ColLegal, ColMove, ColRank,
+    ColFirstFeature
+};
+
+uint64_t cardBit(const Card& card) {
+    return uint64_t{1} << (card.suit * 13 + card.rank - 1);
+}
+
+// One decision, kept until the game is over and the mover's rank is known
+struct Decision {
+    uint64_t seat;
+    uint64_t hand;
+    uint64_t table;
+    uint64_t legal;
+    int move;
+    std::array<float, kNumFeatures> features;
+};
+
+} // namespace
+
+SelfPlay::SelfPlay(std::vector<StrategyFactory> factories,
+                   std::vector<std::string> names,
+                   SelfPlayConfig config)
+    : factories(std::move(factories)), names(std::move(names)), config(config)
+{
+    if (this->factories.empty() || this->factories.size() > 255) {
+        throw std::invalid_argument("Self-play needs 1 to 255 strategies");
+    }
+    if (this->names.size() != this->factories.size()) {
+        throw std::invalid_argument("Self-play needs exactly one name per strategy");
+    }
+    if (config.numPlayers < 2 || config.numPlayers > 8) {
+        throw std::invalid_argument("Self-play supports 2 to 8 players");
+    }
+    if (config.chunkRows == 0) {
+        throw std::invalid_argument("Chunks need at least one row");
+    }
+}
+
+std::vector<ColumnSpec> SelfPlay::schema() {
+    std::vector<ColumnSpec> columns = {
+        {"game", ColumnType::UInt64},
+        {"turn", ColumnType::UInt16},
+        {"seat", ColumnType::UInt8},
+        {"players", ColumnType::UInt8},
+        {"strategy", ColumnType::UInt8},     // index into the "strategy.<i>" metadata
+        {"hand", ColumnType::UInt64},
+        {"table", ColumnType::UInt64},
+        {"legal", ColumnType::UInt64},
+        {"move", ColumnType::Int8},          // suit * 13 + rank - 1, or -1 for a pass
+        {"rank", ColumnType::UInt8},         // final rank of the mover
+    };
+    for (size_t f = 0; f < kNumFeatures; ++f) {
+        columns.push_back({std::string("f_") + featureName(f), ColumnType::Float32});
+    }
+    return columns;
+}
+
+SelfPlayStats SelfPlay::run(const std::string& path) {
+    std::map<std::string, std::string> metadata;
+    metadata["games"] = std::to_string(config.numGames);
+    metadata["players"] = std::to_string(config.numPlayers);
+    metadata["seed"] = std::to_string(config.seed);
+    for (size_t s = 0; s < names.size(); ++s) {
+        metadata["strategy." + std::to_string(s)] = names[s];
+    }
+    const std::vector<ColumnSpec> columns = schema();
+    TrainingDataWriter writer(path, columns, metadata, config.compress);
+
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config.numGames < numThreads) {
+        numThreads = static_cast<unsigned>(std::max<uint64_t>(1, config.numGames));
+    }
+
+    std::atomic<uint64_t> nextGame{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            // instances[s][k]: k-th copy of strategy s, so a strategy can take several seats
+            std::vector<std::vector<std::shared_ptr<PlayerStrategy>>> instances(factories.size());
+            ColumnChunk chunk(columns);
+            CandidateBatch batch;
+            std::vector<Decision> decisions;
+            const uint64_t n = config.numPlayers;
+
+            for (uint64_t game = nextGame.fetch_add(1); game < config.numGames; game = nextGame.fetch_add(1)) {
+                const uint64_t dealSeed = BatchRunner::dealSeed(config.seed, game);
+                std::mt19937_64 mix(dealSeed ^ 0x5E1F9A7ULL);
+                std::vector<size_t> strategyOf(n);
+                std::vector<size_t> copies(factories.size(), 0);
+
+                MyGameMapper mapper;
+                mapper.set_deal_seed(dealSeed);
+                mapper.read_cards("");
+                mapper.read_game("");
+                for (uint64_t seat = 0; seat < n; ++seat) {
+                    const size_t s = std::uniform_int_distribution<size_t>(0, factories.size() - 1)(mix);
+                    auto& pool = instances[s];
+                    if (copies[s] == pool.size()) pool.push_back(factories[s]());
+                    strategyOf[seat] = s;
+                    mapper.registerStrategy(seat, pool[copies[s]++]);
+                }
+
+                decisions.clear();
+                mapper.set_decision_observer([&](uint64_t seat, const std::vector<Card>& hand,
+                                                 const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& table,
+                                                 int index) {
+                    Decision d{seat, 0, 0, 0, -1, {}};
+                    FeatureContext context = tableContext(hand, table);
+                    for (int suit = 0; suit < 4; ++suit) {
+                        for (int rank = 1; rank <= 13; ++rank) {
+                            if (context.onTable[suit][rank]) d.table |= cardBit(Card{suit, rank});
+                        }
+                    }
+                    for (const Card& card : hand) {
+                        d.hand |= cardBit(card);
+                        const bool free = !context.onTable[card.suit][card.rank];
+                        if (free && (card.rank == 7 ||
+                                     (card.rank > 1 && context.onTable[card.suit][card.rank - 1]) ||
+                                     (card.rank < 13 && context.onTable[card.suit][card.rank + 1]))) {
+                            d.legal |= cardBit(card);
+                        }
+                    }
+                    if (index >= 0) {
+                        const Card& card = hand[index];
+                        d.move = card.suit * 13 + card.rank - 1;
+                        batch.clear();
+                        batch.add(context, card);
+                        for (size_t f = 0; f < kNumFeatures; ++f) d.features[f] = batch.feature(0, f);
+                    }
+                    decisions.push_back(d);
+                });
+
+                std::vector<uint64_t> rankOf(n, 0);
+                for (const auto& [seat, rank] : mapper.compute_game_progress(n)) {
+                    rankOf[seat] = rank;
+                }
+
+                uint16_t turn = 0;
+                for (const Decision& d : decisions) {
+                    chunk.push<uint64_t>(ColGame, game);
+                    chunk.push<uint16_t>(ColTurn, turn++);
+                    chunk.push<uint8_t>(ColSeat, static_cast<uint8_t>(d.seat));
+                    chunk.push<uint8_t>(ColPlayers, static_cast<uint8_t>(n));
+                    chunk.push<uint8_t>(ColStrategy, static_cast<uint8_t>(strategyOf[d.seat]));
+                    chunk.push<uint64_t>(ColHand, d.hand);
+                    chunk.push<uint64_t>(ColTable, d.table);
+                    chunk.push<uint64_t>(ColLegal, d.legal);
+                    chunk.push<int8_t>(ColMove, static_cast<int8_t>(d.move));
+                    chunk.push<uint8_t>(ColRank, static_cast<uint8_t>(rankOf[d.seat]));
+                    for (size_t f = 0; f < kNumFeatures; ++f) {
+                        chunk.push<float>(ColFirstFeature + f, d.features[f]);
+                    }
+                }
+                if (chunk.rows() >= config.chunkRows) {
+                    writer.write(chunk);
+                    chunk.clear();
+                }
+            }
+            writer.write(chunk);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            nextGame.store(config.numGames);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    writer.close();
+    SelfPlayStats stats;
+    stats.games = config.numGames;
+    stats.rows = writer.rowsWritten();
+    stats.bytes = writer.bytesWritten();
+    return stats;
+}
+
+} // namespace sevens
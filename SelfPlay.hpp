@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PlayerStrategy.hpp"
+#include "TrainingData.hpp"
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Settings of a self-play data run.
+ * Every game seats numPlayers strategies drawn from the mix (with repetition,
+ * so listing a strategy twice makes it twice as common) and uses the deck of
+ * BatchRunner::dealSeed(seed, game).
+ */
+struct SelfPlayConfig {
+    uint64_t numGames = 1000;
+    uint64_t numPlayers = 4;
+    uint64_t seed = 1;
+    unsigned numThreads = 0;       // 0 = one worker per hardware thread
+    uint64_t chunkRows = 1 << 16;  // rows per chunk and per worker buffer
+    bool compress = false;
+};
+
+struct SelfPlayStats {
+    uint64_t games = 0;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Plays games in parallel and writes one row per decision (pass or play) to a
+ * training file. Besides the game bookkeeping each row has the hand, table and
+ * legal-move bitmasks (bit suit * 13 + rank - 1), the move, the mover's final
+ * rank and the FeatureEvaluator features of the played card (all zero for a
+ * pass), computed with tableContext. See selfPlaySchema for the columns.
+ */
+class SelfPlay {
+public:
+    SelfPlay(std::vector<StrategyFactory> factories,
+             std::vector<std::string> names,
+             SelfPlayConfig config);
+
+    SelfPlayStats run(const std::string& path);
+
+    static std::vector<ColumnSpec> schema();
+
+private:
+    std::vector<StrategyFactory> factories;
+    std::vector<std::string> names;
+    SelfPlayConfig config;
+};
+
+} // namespace sevens
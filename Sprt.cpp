@@ -0,0 +1,57 @@
+#include "Sprt.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sevens {
+
+Sprt::Sprt(double elo0, double elo1, double alpha, double beta, uint64_t minSamples)
+    : score0(eloToScore(elo0)), score1(eloToScore(elo1)), minSamples(minSamples)
+{
+    if (!(elo1 > elo0)) {
+        throw std::invalid_argument("SPRT needs elo1 > elo0");
+    }
+    if (alpha <= 0.0 || alpha >= 1.0 || beta <= 0.0 || beta >= 1.0) {
+        throw std::invalid_argument("SPRT error rates must be in (0, 1)");
+    }
+    lower = std::log(beta / (1.0 - alpha));
+    upper = std::log((1.0 - beta) / alpha);
+}
+
+double Sprt::eloToScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+void Sprt::addSample(double score) {
+    ++count;
+    double delta = score - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (score - mean);
+}
+
+double Sprt::meanScore() const {
+    return count ? mean : 0.5;
+}
+
+double Sprt::eloEstimate() const {
+    double s = std::clamp(meanScore(), 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / s - 1.0);
+}
+
+double Sprt::llr() const {
+    if (count == 0) return 0.0;
+    // Sample variance shrunk towards the prior, so a run of equal scores can't make it vanish
+    const double variance = (m2 + kPriorSamples * kPriorVariance) / (static_cast<double>(count) + kPriorSamples);
+    return static_cast<double>(count) * (score1 - score0)
+         * (2.0 * mean - score0 - score1) / (2.0 * variance);
+}
+
+Sprt::Decision Sprt::decision() const {
+    if (count < minSamples) return Decision::Continue;
+    double value = llr();
+    if (value >= upper) return Decision::AcceptH1;
+    if (value <= lower) return Decision::AcceptH0;
+    return Decision::Continue;
+}
+
+} // namespace sevens
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sevens {
+
+/**
+ * Sequential probability ratio test for an A/B match between two strategies.
+ *
+ * Each sample is the score of the candidate against the baseline on one deal
+ * (1 = always ahead, 0.5 = even, 0 = always behind). The hypotheses are
+ *   H0: the Elo difference is elo0    H1: the Elo difference is elo1
+ * and the log-likelihood ratio uses the normal approximation of the generalized
+ * SPRT, so the per-deal score may take any value in [0, 1].
+ *
+ * Early samples say little about the variance (a few equal scores have none),
+ * so the sample variance is blended with a prior worth kPriorSamples deals,
+ * and the bounds are only tested once minSamples deals have been added.
+ */
+class Sprt {
+public:
+    enum class Decision { Continue, AcceptH0, AcceptH1 };
+
+    static constexpr uint64_t kDefaultMinSamples = 100;
+    // Prior variance: a deal of two even games (win/loss per seating) scores 0, 0.5 or 1
+    static constexpr double kPriorVariance = 0.125;
+    static constexpr double kPriorSamples = 20.0;
+
+    Sprt(double elo0, double elo1, double alpha, double beta, uint64_t minSamples = kDefaultMinSamples);
+
+    void addSample(double score);
+
+    double llr() const;
+    double lowerBound() const { return lower; }
+    double upperBound() const { return upper; }
+    Decision decision() const;
+
+    uint64_t samples() const { return count; }
+    double meanScore() const;
+    // Elo difference implied by the mean score so far
+    double eloEstimate() const;
+
+    // Expected score of a player rated elo points above its opponent
+    static double eloToScore(double elo);
+
+private:
+    double score0;
+    double score1;
+    double lower;
+    double upper;
+    uint64_t minSamples;
+
+    // Welford running mean / variance of the samples
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+};
+
+} // namespace sevens
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace sevens {
+
+/**
+ * Bounded single-producer single-consumer ring. Neither side ever waits:
+ * tryPush fails when the ring is full and tryPop when it is empty.
+ * The two indices sit on their own cache lines so that the producer and the
+ * consumer only share a line when one of them reads the other's index.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "SpscQueue holds plain values");
+
+    // Producer side
+    bool tryPush(const T& value) {
+        const size_t tail = writeIndex.load(std::memory_order_relaxed);
+        if (tail - readIndex.load(std::memory_order_acquire) == Capacity) return false;
+        slots[tail & (Capacity - 1)] = value;
+        writeIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool tryPop(T& value) {
+        const size_t head = readIndex.load(std::memory_order_relaxed);
+        if (head == writeIndex.load(std::memory_order_acquire)) return false;
+        value = slots[head & (Capacity - 1)];
+        readIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    alignas(64) std::atomic<size_t> readIndex{0};
+    alignas(64) std::array<T, Capacity> slots{};
+};
+
+} // namespace sevens
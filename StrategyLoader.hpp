@@ -1,10 +1,14 @@
 #pragma once
 
 #include "PlayerStrategy.hpp"
+#include <functional>
 #include <memory>
 #include <string>
 #include <stdexcept>
 #include <iostream>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <windows.h>
 
 namespace sevens {
@@ -91,6 +95,61 @@ public:
         }
     }
 
+    /**
+     * brief the library's cloneStrategy export (see CloneableStrategy), or nullptr
+     *
+     * param libraryPath a library the caller keeps loaded (e.g. through a prototype)
+     */
+    static CloneStrategyFn findClone(const std::string& libraryPath) {
+        HMODULE hDll = LoadLibraryA(libraryPath.c_str());
+        if (!hDll) {
+            return nullptr;
+        }
+        auto cloneStrategy = reinterpret_cast<CloneStrategyFn>(GetProcAddress(hDll, "cloneStrategy"));
+        // only a reference count: the caller's instance keeps the module loaded
+        FreeLibrary(hDll);
+        return cloneStrategy;
+    }
+
+    /**
+     * brief copy of a prototype through the library's cloneStrategy
+     *
+     * return nullptr if the prototype can't be copied; a copy keeps the prototype
+     *        (and with it the library) alive
+     */
+    static std::shared_ptr<PlayerStrategy> cloneFromPrototype(CloneStrategyFn cloneStrategy,
+                                                              const std::shared_ptr<PlayerStrategy>& prototype) {
+        PlayerStrategy* copy = cloneStrategy ? cloneStrategy(prototype.get()) : nullptr;
+        if (!copy) {
+            return nullptr;
+        }
+        return std::shared_ptr<PlayerStrategy>(copy, [prototype](PlayerStrategy* p) { delete p; });
+    }
+
+    /**
+     * brief factory of fresh strategy instances from a library
+     *
+     * Loads one prototype and copies it for every instance when the library
+     * exports cloneStrategy, so read-only data is loaded once and shared;
+     * otherwise every instance is a new loadFromLibrary().
+     * throws runtime_error like loadFromLibrary
+     */
+    static std::function<std::shared_ptr<PlayerStrategy>()> prototypeFactory(const std::string& libraryPath) {
+        std::shared_ptr<PlayerStrategy> prototype = loadFromLibrary(libraryPath);
+        CloneStrategyFn cloneStrategy = findClone(libraryPath);
+        if (!cloneStrategy) {
+            return [libraryPath]() { return loadFromLibrary(libraryPath); };
+        }
+        // No trial copy up front (a copy may allocate search memory): an instance
+        // the prototype can't be copied into is loaded like any other
+        return [cloneStrategy, prototype, libraryPath]() {
+            if (auto copy = cloneFromPrototype(cloneStrategy, prototype)) {
+                return copy;
+            }
+            return loadFromLibrary(libraryPath);
+        };
+    }
+
     static bool isValidLibrary(const std::string& libraryPath) {
         HMODULE hDll = LoadLibraryA(libraryPath.c_str());
         if (!hDll) {
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "RandomStrategy.hpp"
+#include "GreedyStrategy.hpp"
+#include "YuriaStrategy.hpp"
+#include <memory>
+#include <string_view>
+#include <tuple>
+
+namespace sevens {
+
+/**
+ * Compile-time list of strategy types.
+ * Every type must be a final PlayerStrategy with a static kName matching getName().
+ */
+template <typename... Strategies>
+struct StrategyList {
+    static constexpr size_t size = sizeof...(Strategies);
+};
+
+// Strategies compiled into the executable, usable without loading a library
+using BuiltinStrategies = StrategyList<RandomStrategy, GreedyStrategy, YuriaStrategy>;
+
+template <size_t I, typename List>
+struct StrategyAt;
+
+template <size_t I, typename... Strategies>
+struct StrategyAt<I, StrategyList<Strategies...>> {
+    using type = std::tuple_element_t<I, std::tuple<Strategies...>>;
+};
+
+template <size_t I>
+using BuiltinStrategy = typename StrategyAt<I, BuiltinStrategies>::type;
+
+template <typename... Strategies>
+constexpr size_t strategyIndex(std::string_view name, StrategyList<Strategies...>) {
+    size_t index = 0;
+    size_t found = sizeof...(Strategies);
+    ((found == sizeof...(Strategies) && name == std::string_view(Strategies::kName)
+          ? (void)(found = index) : (void)0, ++index), ...);
+    return found;
+}
+
+// Position of a built-in strategy in BuiltinStrategies, or BuiltinStrategies::size if unknown
+constexpr size_t builtinIndex(std::string_view name) {
+    return strategyIndex(name, BuiltinStrategies{});
+}
+
+static_assert(builtinIndex("YuriaStrategy") == 2, "built-in strategy names must be unique");
+
+template <typename... Strategies>
+std::shared_ptr<PlayerStrategy> makeStrategy(std::string_view name, StrategyList<Strategies...>) {
+    std::shared_ptr<PlayerStrategy> strategy;
+    ((!strategy && name == std::string_view(Strategies::kName)
+          ? (void)(strategy = std::make_shared<Strategies>()) : (void)0), ...);
+    return strategy;
+}
+
+// Polymorphic instance of a built-in strategy (for the virtual-call engine), nullptr if unknown
+inline std::shared_ptr<PlayerStrategy> makeBuiltinStrategy(std::string_view name) {
+    return makeStrategy(name, BuiltinStrategies{});
+}
+
+} // namespace sevens
@@ -0,0 +1,198 @@
+#include "TableRenderer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+#else
+#include <unistd.h>
+#endif
+
+namespace sevens {
+
+namespace {
+
+// Whether stdout is a terminal that understands ANSI cursor control
+bool ansiTerminal() {
+#ifdef _WIN32
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (out == INVALID_HANDLE_VALUE || !GetConsoleMode(out, &mode)) return false;
+    return SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+#else
+    return isatty(STDOUT_FILENO) != 0;
+#endif
+}
+
+} // namespace
+
+TableRenderer::TableRenderer(std::vector<std::string> playerLabels, double framesPerSecond)
+    : labels(std::move(playerLabels)),
+      frameInterval(framesPerSecond > 0.0
+                        ? std::chrono::nanoseconds(static_cast<int64_t>(1e9 / framesPerSecond))
+                        : std::chrono::nanoseconds(0)),
+      ansi(ansiTerminal()),
+      screen(std::cout.rdbuf())
+{
+    if (ansi) {
+        std::cout.flush();
+        std::cout.rdbuf(nullptr);
+        muted = true;
+    }
+    thread = std::thread([this]() { run(); });
+}
+
+TableRenderer::~TableRenderer() {
+    if (thread.joinable()) {
+        stopping.store(true, std::memory_order_release);
+        thread.join();
+    }
+    unmute();
+}
+
+void TableRenderer::unmute() {
+    if (!muted) return;
+    std::cout.rdbuf(screen);
+    muted = false;
+}
+
+void TableRenderer::submit(const RenderFrame& frame) {
+    if (!queue.tryPush(frame)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TableRenderer::finish(const RenderFrame& frame) {
+    RenderFrame last = frame;
+    last.last = true;
+    while (!queue.tryPush(last)) {
+        std::this_thread::yield();
+    }
+    thread.join();
+    unmute();
+}
+
+void TableRenderer::run() {
+    RenderFrame latest;
+    RenderFrame incoming;
+    bool pending = false;
+    auto nextDraw = std::chrono::steady_clock::now();
+
+    for (;;) {
+        while (queue.tryPop(incoming)) {
+            latest = incoming;
+            pending = true;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (pending && (latest.last || now >= nextDraw)) {
+            draw(layout(latest));
+            pending = false;
+            nextDraw = now + frameInterval;
+            if (latest.last) return;
+        }
+        if (!pending && stopping.load(std::memory_order_acquire)) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+std::vector<std::string> TableRenderer::layout(const RenderFrame& frame) const {
+    const GameState& state = frame.state;
+    std::vector<std::string> lines;
+    std::ostringstream line;
+    auto flush = [&]() {
+        lines.push_back(line.str());
+        line.str("");
+    };
+
+    line << (frame.last ? "Final table after " : "Table after ") << frame.turn << " turns";
+    flush();
+    for (int suit = 0; suit < 4; ++suit) {
+        line << "Suit " << suit << ": ";
+        for (int rank = 1; rank <= 13; ++rank) {
+            if (state.onTable(suit, rank)) {
+                line << rank << " ";
+            } else {
+                line << ". ";
+            }
+        }
+        flush();
+    }
+
+    for (size_t p = 0; p < state.numPlayers; ++p) {
+        line << (p < labels.size() ? labels[p] : "Player " + std::to_string(p)) << ": ";
+        const uint64_t hand = state.hands[p];
+        if (state.isFinished(p)) {
+            line << "finished with rank " << state.rank(p);
+        } else {
+            if (state.over) line << "rank " << state.rank(p) << ", ";
+            uint64_t held = 0;
+            for (uint64_t m = hand; m; m &= m - 1) ++held;
+            line << held << (held == 1 ? " card" : " cards");
+            for (int suit = 0; suit < 4; ++suit) {
+                const uint64_t suitCards = (hand >> (suit * 13)) & 0x1FFF;
+                if (!suitCards) continue;
+                line << "  " << suit << ":";
+                for (int rank = 1; rank <= 13; ++rank) {
+                    if ((suitCards >> (rank - 1)) & 1) line << " " << rank;
+                }
+            }
+        }
+        flush();
+    }
+
+    line << "Recent turns:";
+    flush();
+    for (size_t i = 0; i < frame.recentCount; ++i) {
+        const GameEvent& event = frame.recent[i];
+        line << "  Player " << event.playerID;
+        if (event.pass) {
+            line << " cannot play this turn.";
+        } else {
+            line << " plays " << event.card;
+        }
+        flush();
+    }
+    return lines;
+}
+
+void TableRenderer::draw(const std::vector<std::string>& lines) {
+    std::string out;
+    if (!ansi) {
+        for (const auto& line : lines) out += line + "\n";
+        out += "\n";
+    } else if (onScreen.empty()) {
+        // First frame: clear the screen and draw from the top
+        out = "\x1b[2J\x1b[H";
+        for (const auto& line : lines) out += line + "\x1b[K\n";
+    } else {
+        // Rewrite each changed line from its first differing column
+        const size_t rows = std::max(lines.size(), onScreen.size());
+        for (size_t row = 0; row < rows; ++row) {
+            const std::string* now = row < lines.size() ? &lines[row] : nullptr;
+            const std::string* before = row < onScreen.size() ? &onScreen[row] : nullptr;
+            if (now && before && *now == *before) continue;
+            size_t column = 0;
+            if (now && before) {
+                const size_t common = std::min(now->size(), before->size());
+                while (column < common && (*now)[column] == (*before)[column]) ++column;
+            }
+            out += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(column + 1) + "H";
+            if (now) out += now->substr(column);
+            out += "\x1b[K";
+        }
+        out += "\x1b[" + std::to_string(lines.size() + 1) + ";1H";
+    }
+    onScreen = lines;
+    std::ostream terminal(screen);
+    terminal << out << std::flush;
+}
+
+} // namespace sevens
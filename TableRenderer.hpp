@@ -0,0 +1,80 @@
+#pragma once
+
+#include "GameEventLog.hpp"
+#include "GameState.hpp"
+#include "SpscQueue.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sevens {
+
+// What the display shows after one turn
+struct RenderFrame {
+    static constexpr size_t kRecent = 6;
+
+    GameState state;
+    uint64_t turn = 0;
+    std::array<GameEvent, kRecent> recent{};   // latest turns, oldest first
+    uint8_t recentCount = 0;
+    bool last = false;
+};
+
+/**
+ * Draws a watched game on its own thread.
+ *
+ * The game loop hands over a snapshot per turn through a lock-free ring and
+ * never waits for the terminal: when the ring is full the snapshot is dropped,
+ * since the next one supersedes it. The renderer draws at most
+ * framesPerSecond frames (0 = every snapshot it gets). On a terminal it
+ * rewrites only the parts of lines that changed since the previous frame,
+ * with ANSI cursor moves. Otherwise it prints whole frames. The final
+ * snapshot is always drawn.
+ *
+ * Those cursor moves assume nothing else writes to the screen, so on a
+ * terminal std::cout is muted (as QuietStdout does for the batch modes) from
+ * construction until the final frame is drawn; the renderer writes to the
+ * terminal's buffer directly. Printed to a file, the log lines are kept.
+ */
+class TableRenderer {
+public:
+    TableRenderer(std::vector<std::string> playerLabels, double framesPerSecond);
+    ~TableRenderer();
+
+    TableRenderer(const TableRenderer&) = delete;
+    TableRenderer& operator=(const TableRenderer&) = delete;
+
+    // Game loop side: never blocks
+    void submit(const RenderFrame& frame);
+
+    // Hands over the final snapshot and waits until it is on screen
+    void finish(const RenderFrame& frame);
+
+    uint64_t droppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    std::vector<std::string> layout(const RenderFrame& frame) const;
+    void draw(const std::vector<std::string>& lines);
+    // Gives std::cout its buffer back (once)
+    void unmute();
+
+    std::vector<std::string> labels;
+    std::chrono::nanoseconds frameInterval;
+    bool ansi;
+    std::streambuf* screen;   // std::cout's buffer, muted in std::cout while drawing on a terminal
+    bool muted = false;
+
+    SpscQueue<RenderFrame, 64> queue;
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> stopping{false};
+    std::vector<std::string> onScreen;   // renderer thread only
+    std::thread thread;
+};
+
+} // namespace sevens
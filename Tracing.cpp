@@ -0,0 +1,190 @@
+#include "Tracing.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sevens {
+
+std::atomic<bool> Trace::active{false};
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    const char* argName;
+    uint64_t arg;
+    uint64_t begin;
+    uint64_t end;
+};
+
+constexpr size_t kBlockEvents = 8192;
+constexpr size_t kMaxBlocks = Trace::kMaxEventsPerThread / kBlockEvents;
+
+/**
+ * Events of one thread, in blocks allocated as it goes. Only the owner
+ * writes; count is published with release, after the event and its block,
+ * so a reader sees complete events only.
+ */
+struct ThreadBuffer {
+    uint64_t threadID = 0;
+    std::unique_ptr<TraceEvent[]> blocks[kMaxBlocks];
+    std::atomic<TraceEvent*> blockPointers[kMaxBlocks] = {};
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+
+    void append(const TraceEvent& event) {
+        const size_t n = count.load(std::memory_order_relaxed);
+        if (n >= Trace::kMaxEventsPerThread) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        const size_t block = n / kBlockEvents;
+        if (!blocks[block]) {
+            blocks[block] = std::make_unique<TraceEvent[]>(kBlockEvents);
+            blockPointers[block].store(blocks[block].get(), std::memory_order_relaxed);
+        }
+        blocks[block][n % kBlockEvents] = event;
+        count.store(n + 1, std::memory_order_release);
+    }
+};
+
+// Buffers outlive their threads, so short-lived workers still show up in the trace
+struct Registry {
+    std::mutex mutex;   // taken once per thread, and by write()
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::unordered_set<std::string> names;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = r.buffers.back().get();
+        buffer->threadID = r.buffers.size();
+    }
+    return *buffer;
+}
+
+void writeString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\' << *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            out << ' ';
+        } else {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+void Trace::start() {
+    registry();
+    active.store(true, std::memory_order_relaxed);
+}
+
+uint64_t Trace::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - registry().epoch).count());
+}
+
+void Trace::record(const char* name, const char* category, uint64_t begin, uint64_t end,
+                   const char* argName, uint64_t arg) {
+    localBuffer().append(TraceEvent{name, category, argName, arg, begin, end});
+}
+
+const char* Trace::intern(const std::string& text) {
+    // Per-thread cache in front of the shared table, so repeated names never lock
+    thread_local std::unordered_map<std::string, const char*> seen;
+    auto it = seen.find(text);
+    if (it != seen.end()) return it->second;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const char* stable = r.names.insert(text).first->c_str();
+    seen.emplace(text, stable);
+    return stable;
+}
+
+uint64_t Trace::dropped() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint64_t total = 0;
+    for (const auto& buffer : r.buffers) total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool Trace::write(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out << ",\n";
+        first = false;
+    };
+    char number[32];
+    for (const auto& buffer : r.buffers) {
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadID
+            << ",\"args\":{\"name\":\"thread " << buffer->threadID << "\"}}";
+
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->blockPointers[i / kBlockEvents].load(std::memory_order_relaxed)[i % kBlockEvents];
+            separator();
+            out << "{\"name\":";
+            writeString(out, event.name);
+            out << ",\"cat\":";
+            writeString(out, event.category);
+            // Microseconds with nanosecond precision, as the format expects
+            std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(event.begin) / 1000.0);
+            out << ",\"ph\":\"X\",\"ts\":" << number;
+            std::snprintf(number, sizeof(number), "%.3f", static_cast<double>(event.end - event.begin) / 1000.0);
+            out << ",\"dur\":" << number << ",\"pid\":1,\"tid\":" << buffer->threadID;
+            if (event.argName) {
+                out << ",\"args\":{";
+                writeString(out, event.argName);
+                out << ":" << event.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+TraceSession::TraceSession(std::string path) : path(std::move(path)) {
+    if (!this->path.empty()) Trace::start();
+}
+
+TraceSession::~TraceSession() {
+    if (path.empty()) return;
+    if (!Trace::write(path)) {
+        std::cerr << "Cannot write trace " << path << "\n";
+    } else if (const uint64_t lost = Trace::dropped()) {
+        std::cerr << "Trace " << path << ": " << lost << " events dropped (buffers full)\n";
+    }
+}
+
+} // namespace sevens
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace sevens {
+
+/**
+ * Optional timeline of a run, written in Chrome trace-event JSON (open it in
+ * Perfetto or chrome://tracing). Off unless start() is called: a span then
+ * costs one relaxed load. When on, every thread appends complete events to
+ * its own buffer, single writer and no lock; the buffers are only read when
+ * the trace is written. Each thread keeps at most kMaxEventsPerThread events,
+ * later ones are counted as dropped.
+ *
+ * Event names and argument names must outlive the trace (string literals, or
+ * intern() for names only known at runtime, such as strategy names).
+ */
+class Trace {
+public:
+    static constexpr size_t kMaxEventsPerThread = size_t{1} << 21;
+
+    static void start();
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    // Nanoseconds since start()
+    static uint64_t now();
+
+    // One complete event [begin, end) on the calling thread
+    static void record(const char* name, const char* category, uint64_t begin, uint64_t end,
+                       const char* argName = nullptr, uint64_t arg = 0);
+
+    // Stable copy of a runtime string, the same pointer for equal strings
+    static const char* intern(const std::string& text);
+
+    // Writes every event recorded so far; false if the file can't be written
+    static bool write(const std::string& path);
+
+    // Events that didn't fit in their thread's buffer
+    static uint64_t dropped();
+
+private:
+    static std::atomic<bool> active;
+};
+
+/**
+ * Scoped event: records from construction to destruction when tracing is on.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category, const char* argName = nullptr, uint64_t arg = 0)
+        : name(name), category(category), argName(argName), arg(arg), begin(Trace::enabled() ? Trace::now() : kOff) {}
+
+    ~TraceSpan() {
+        if (begin != kOff) Trace::record(name, category, begin, Trace::now(), argName, arg);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    static constexpr uint64_t kOff = ~uint64_t{0};
+
+    const char* name;
+    const char* category;
+    const char* argName;
+    uint64_t arg;
+    uint64_t begin;
+};
+
+/**
+ * Turns tracing on for its lifetime and writes the trace to path when it ends
+ * (nothing happens with an empty path).
+ */
+class TraceSession {
+public:
+    explicit TraceSession(std::string path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    std::string path;
+};
+
+} // namespace sevens
@@ -0,0 +1,437 @@
+#include "Trainer.hpp"
+#include "Deck.hpp"
+#include "GameState.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace sevens {
+
+namespace {
+
+constexpr const char* kCheckpointHeader = "sevens-policy-checkpoint 1";
+
+// High 64 bits of a * b
+uint64_t mulHigh(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    const uint64_t aLow = a & 0xFFFFFFFFULL, aHigh = a >> 32;
+    const uint64_t bLow = b & 0xFFFFFFFFULL, bHigh = b >> 32;
+    const uint64_t low = aLow * bLow;
+    const uint64_t middle = aHigh * bLow + (low >> 32);
+    const uint64_t cross = aLow * bHigh + (middle & 0xFFFFFFFFULL);
+    return aHigh * bHigh + (middle >> 32) + (cross >> 32);
+#endif
+}
+
+// Small, fast generator for dealing and sampling; one per game
+struct SplitMix64 {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, 1)
+    float uniform() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+    // Uniform in [0, n)
+    uint64_t below(uint64_t n) { return mulHigh(next(), n); }
+};
+
+SplitMix64 gameGenerator(uint64_t seed, uint64_t iteration, uint64_t game) {
+    SplitMix64 mix{seed};
+    mix.state ^= SplitMix64{iteration * 0xD1B54A32D192ED03ULL}.next();
+    mix.state ^= SplitMix64{~game}.next();
+    return mix;
+}
+
+// Candidates of the player to move, scored; cards[c] is the card index of column c
+size_t scoreMoves(const GameState& state, uint64_t moves, const FeatureWeights& weights,
+                  CandidateBatch& batch, int* cards, float* scores) {
+    const FeatureContext context = maskContext(state.hands[state.toMove], state.tableMask());
+    batch.clear();
+    for (uint64_t m = moves; m; m &= m - 1) {
+        const int card = GameState::lowestBit(m);
+        cards[batch.add(context, GameState::cardAt(card))] = card;
+    }
+    batch.score(weights, scores);
+    return batch.size();
+}
+
+/**
+ * One self-play game with every seat sampling from the policy. Adds
+ * reward(seat) x sum over the seat's decisions of (features(chosen) -
+ * expected features) to gradient: the REINFORCE estimate for the game.
+ */
+void playTrainingGame(const FeatureWeights& weights, uint64_t numPlayers, SplitMix64& rng,
+                      CandidateBatch& batch, std::array<double, kNumFeatures>& gradient) {
+    GameState state = GameState::start(numPlayers, dealHands(Deck::shuffled(rng.next()), numPlayers));
+    float seatGradient[GameState::kMaxPlayers][kNumFeatures] = {};
+    alignas(32) float scores[CandidateBatch::kMaxCandidates];
+    alignas(32) float probabilities[CandidateBatch::kMaxCandidates];
+    float expected[kNumFeatures];
+    int cards[CandidateBatch::kMaxCandidates];
+
+    while (!state.over) {
+        const uint64_t moves = state.legalMoves();
+        // A pass or a single card is forced and carries no gradient
+        if (moves == GameState::kPassBit) {
+            state.apply(GameState::kPass);
+            continue;
+        }
+        if (!(moves & (moves - 1))) {
+            state.apply(GameState::lowestBit(moves));
+            continue;
+        }
+
+        const size_t seat = state.toMove;
+        const size_t count = scoreMoves(state, moves, weights, batch, cards, scores);
+        const float top = *std::max_element(scores, scores + count);
+        float total = 0.0f;
+        for (size_t c = 0; c < count; ++c) {
+            probabilities[c] = std::exp(scores[c] - top);
+            total += probabilities[c];
+        }
+        std::fill(probabilities + count, probabilities + CandidateBatch::kMaxCandidates, 0.0f);
+
+        size_t chosen = count - 1;
+        float draw = rng.uniform() * total;
+        for (size_t c = 0; c < count; ++c) {
+            draw -= probabilities[c];
+            if (draw < 0.0f) {
+                chosen = c;
+                break;
+            }
+        }
+
+        const float scale = 1.0f / total;
+        for (size_t c = 0; c < count; ++c) probabilities[c] *= scale;
+        batch.weightedSum(probabilities, expected);
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            seatGradient[seat][f] += batch.feature(chosen, f) - expected[f];
+        }
+        state.apply(cards[chosen]);
+    }
+
+    // Ranks are a permutation of 1..numPlayers, so rewards sum to zero over the table
+    const double averageRank = static_cast<double>(numPlayers + 1) / 2.0;
+    for (size_t seat = 0; seat < numPlayers; ++seat) {
+        const double reward = averageRank - static_cast<double>(state.rank(seat));
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            gradient[f] += reward * seatGradient[seat][f];
+        }
+    }
+}
+
+// Writes next to path and renames into place, so a crash never leaves half a file
+template <typename F>
+void replaceFile(const std::string& path, F&& write) {
+    const std::string temporary = path + ".tmp";
+    write(temporary);
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        throw std::runtime_error("Cannot replace " + path + ": " + error.message());
+    }
+}
+
+} // namespace
+
+PolicyTrainer::PolicyTrainer(TrainerConfig config) : config(std::move(config)) {
+    if (this->config.numPlayers < 2 || this->config.numPlayers > GameState::kMaxPlayers) {
+        throw std::invalid_argument("Training needs 2 to " + std::to_string(GameState::kMaxPlayers) + " players");
+    }
+    if (this->config.gamesPerIteration == 0) {
+        throw std::invalid_argument("Training needs at least one game per iteration");
+    }
+}
+
+void PolicyTrainer::setInitialWeights(const FeatureWeights& initial) {
+    weights = initial;
+}
+
+void PolicyTrainer::setProgressCallback(ProgressCallback callback) {
+    onProgress = std::move(callback);
+}
+
+std::array<double, kNumFeatures> PolicyTrainer::playIteration(unsigned numThreads) {
+    std::array<double, kNumFeatures> gradient{};
+    std::atomic<uint64_t> nextGame{0};
+    std::mutex gradientMutex;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        try {
+            CandidateBatch batch;
+            std::array<double, kNumFeatures> local{};
+            for (uint64_t game = nextGame.fetch_add(1); game < config.gamesPerIteration;
+                 game = nextGame.fetch_add(1)) {
+                SplitMix64 rng = gameGenerator(config.seed, iteration, game);
+                playTrainingGame(weights, config.numPlayers, rng, batch, local);
+            }
+            std::lock_guard<std::mutex> lock(gradientMutex);
+            for (size_t f = 0; f < kNumFeatures; ++f) gradient[f] += local[f];
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            nextGame.store(config.gamesPerIteration);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return gradient;
+}
+
+FeatureWeights PolicyTrainer::run() {
+    loadCheckpoint();
+
+    unsigned numThreads = config.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config.gamesPerIteration < numThreads) {
+        numThreads = static_cast<unsigned>(config.gamesPerIteration);
+    }
+
+    constexpr double kBeta1 = 0.9;
+    constexpr double kBeta2 = 0.999;
+    constexpr double kEpsilon = 1e-8;
+
+    while (iteration < config.iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::array<double, kNumFeatures> sum = playIteration(numThreads);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Gradient ascent on the expected reward, with Adam
+        ++adam.steps;
+        double norm = 0.0;
+        const double correction1 = 1.0 - std::pow(kBeta1, static_cast<double>(adam.steps));
+        const double correction2 = 1.0 - std::pow(kBeta2, static_cast<double>(adam.steps));
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            const double g = sum[f] / static_cast<double>(config.gamesPerIteration);
+            norm += g * g;
+            adam.m[f] = kBeta1 * adam.m[f] + (1.0 - kBeta1) * g;
+            adam.v[f] = kBeta2 * adam.v[f] + (1.0 - kBeta2) * g * g;
+            const double step = config.learningRate * (adam.m[f] / correction1) /
+                                (std::sqrt(adam.v[f] / correction2) + kEpsilon);
+            weights.weights[f] += static_cast<float>(step);
+        }
+        ++iteration;
+        games += config.gamesPerIteration;
+
+        TrainerProgress progress;
+        progress.iteration = iteration;
+        progress.games = games;
+        progress.gamesPerSecond = seconds > 0.0 ? static_cast<double>(config.gamesPerIteration) / seconds : 0.0;
+        progress.gamesPerSecondPerCore = progress.gamesPerSecond / numThreads;
+        progress.gradientNorm = std::sqrt(norm);
+        if ((config.checkpointEvery && iteration % config.checkpointEvery == 0) || iteration == config.iterations) {
+            saveCheckpoint();
+            if (config.evalGames) {
+                progress.evalMeanRank = evaluate(weights, config.numPlayers, config.evalGames, config.seed ^ iteration);
+            }
+        }
+        if (onProgress) onProgress(progress);
+    }
+    return weights;
+}
+
+double PolicyTrainer::evaluate(const FeatureWeights& weights, uint64_t numPlayers, uint64_t games, uint64_t seed) {
+    CandidateBatch batch;
+    alignas(32) float scores[CandidateBatch::kMaxCandidates];
+    int cards[CandidateBatch::kMaxCandidates];
+    double rankSum = 0.0;
+    for (uint64_t game = 0; game < games; ++game) {
+        SplitMix64 rng = gameGenerator(seed, ~uint64_t{0}, game);
+        const size_t learner = game % numPlayers;
+        GameState state = GameState::start(numPlayers, dealHands(Deck::shuffled(rng.next()), numPlayers));
+        while (!state.over) {
+            const uint64_t moves = state.legalMoves();
+            if (moves == GameState::kPassBit) {
+                state.apply(GameState::kPass);
+            } else if (state.toMove != learner) {
+                uint64_t m = moves;
+                for (uint64_t skip = rng.below(GameState::popCount(moves)); skip > 0; --skip) m &= m - 1;
+                state.apply(GameState::lowestBit(m));
+            } else {
+                const size_t count = scoreMoves(state, moves, weights, batch, cards, scores);
+                state.apply(cards[std::max_element(scores, scores + count) - scores]);
+            }
+        }
+        rankSum += static_cast<double>(state.rank(learner));
+    }
+    return games ? rankSum / static_cast<double>(games) : 0.0;
+}
+
+bool PolicyTrainer::loadCheckpoint() {
+    const std::string path = config.outputPrefix + ".ckpt";
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != kCheckpointHeader) {
+        throw std::runtime_error(path + " is not a trainer checkpoint");
+    }
+    uint64_t players = config.numPlayers;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) continue;
+        if (key == "iteration") {
+            fields >> iteration;
+        } else if (key == "games") {
+            fields >> games;
+        } else if (key == "players") {
+            fields >> players;
+        } else if (key == "adam_steps") {
+            fields >> adam.steps;
+        } else if (key == "feature") {
+            std::string name;
+            float weight = 0.0f;
+            double m = 0.0;
+            double v = 0.0;
+            if (!(fields >> name >> weight >> m >> v)) {
+                throw std::runtime_error("Malformed line in " + path + ": " + line);
+            }
+            size_t f = 0;
+            while (f < kNumFeatures && name != featureName(f)) ++f;
+            if (f == kNumFeatures) {
+                throw std::runtime_error("Unknown feature " + name + " in " + path);
+            }
+            weights.weights[f] = weight;
+            adam.m[f] = m;
+            adam.v[f] = v;
+        }
+        if (fields.fail()) {
+            throw std::runtime_error("Malformed line in " + path + ": " + line);
+        }
+    }
+    if (players != config.numPlayers) {
+        throw std::runtime_error(path + " was trained with " + std::to_string(players) + " players");
+    }
+    return true;
+}
+
+void PolicyTrainer::saveCheckpoint() const {
+    replaceFile(config.outputPrefix + ".weights", [this](const std::string& path) { weights.save(path); });
+    replaceFile(config.outputPrefix + ".ckpt", [this](const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        out << kCheckpointHeader << "\n"
+            << "iteration " << iteration << "\n"
+            << "games " << games << "\n"
+            << "players " << config.numPlayers << "\n"
+            << "adam_steps " << adam.steps << "\n"
+            << std::setprecision(17);
+        for (size_t f = 0; f < kNumFeatures; ++f) {
+            out << "feature " << featureName(f) << " " << std::setprecision(9) << weights.weights[f]
+                << " " << std::setprecision(17) << adam.m[f] << " " << adam.v[f] << "\n";
+        }
+        if (!out) {
+            throw std::runtime_error("Cannot write " + path);
+        }
+    });
+}
+
+} // namespace sevens
+
+int main(int argc, char* argv[]) {
+    using namespace sevens;
+
+    TrainerConfig config;
+    std::string initPath;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        try {
+            if (arg.rfind("--games=", 0) == 0) {
+                config.gamesPerIteration = std::stoull(arg.substr(8));
+            } else if (arg.rfind("--players=", 0) == 0) {
+                config.numPlayers = std::stoull(arg.substr(10));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                config.numThreads = static_cast<unsigned>(std::stoul(arg.substr(10)));
+            } else if (arg.rfind("--lr=", 0) == 0) {
+                config.learningRate = std::stof(arg.substr(5));
+            } else if (arg.rfind("--seed=", 0) == 0) {
+                config.seed = std::stoull(arg.substr(7));
+            } else if (arg.rfind("--checkpoint-every=", 0) == 0) {
+                config.checkpointEvery = std::stoull(arg.substr(19));
+            } else if (arg.rfind("--eval-games=", 0) == 0) {
+                config.evalGames = std::stoull(arg.substr(13));
+            } else if (arg.rfind("--out=", 0) == 0) {
+                config.outputPrefix = arg.substr(6);
+            } else if (arg.rfind("--init=", 0) == 0) {
+                initPath = arg.substr(7);
+            } else {
+                positional.push_back(arg);
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (positional.size() != 1) {
+        std::cout << "Usage: ./trainer <iterations> [--games=4096] [--players=4] [--threads=0] [--lr=0.05]"
+                     " [--seed=1] [--checkpoint-every=20] [--eval-games=4000] [--out=learned] [--init=<weights file>]\n"
+                     "Writes the model to <out>.weights and the training state to <out>.ckpt;"
+                     " running again with the same --out continues from the checkpoint.\n";
+        return 1;
+    }
+
+    try {
+        config.iterations = std::stoull(positional[0]);
+    }
+    catch (const std::exception&) {
+        std::cerr << "Invalid number of iterations: " << positional[0] << "\n";
+        return 1;
+    }
+
+    try {
+        PolicyTrainer trainer(config);
+        if (!initPath.empty()) {
+            trainer.setInitialWeights(*FeatureWeights::load(initPath));
+        }
+        trainer.setProgressCallback([](const TrainerProgress& progress) {
+            std::cout << "iteration " << progress.iteration << ": " << progress.games << " games, "
+                      << std::fixed << std::setprecision(0) << progress.gamesPerSecond << " games/s ("
+                      << progress.gamesPerSecondPerCore << " per core), gradient "
+                      << std::setprecision(4) << progress.gradientNorm;
+            if (progress.evalMeanRank > 0.0) {
+                std::cout << ", greedy vs random mean rank " << std::setprecision(3) << progress.evalMeanRank;
+            }
+            std::cout << std::endl;
+        });
+        trainer.run();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Training failed: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "Model written to " << config.outputPrefix << ".weights\n";
+    return 0;
+}
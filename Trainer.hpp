@@ -0,0 +1,90 @@
+#pragma once
+
+#include "FeatureEvaluator.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace sevens {
+
+/**
+ * Settings of a self-play training run. Every iteration plays
+ * gamesPerIteration games in which all seats sample from the current policy,
+ * then takes one gradient step. Game g of iteration i is dealt from
+ * (seed, i, g), so a run is the same whatever the number of threads.
+ */
+struct TrainerConfig {
+    uint64_t iterations = 200;
+    uint64_t gamesPerIteration = 4096;
+    uint64_t numPlayers = 4;
+    uint64_t seed = 1;
+    unsigned numThreads = 0;          // 0 = one worker per hardware thread
+    float learningRate = 0.05f;       // Adam step size
+    uint64_t checkpointEvery = 20;    // iterations between checkpoints (and evaluations)
+    uint64_t evalGames = 4000;        // greedy policy against random players, per evaluation
+    std::string outputPrefix = "learned";   // <prefix>.weights (the model) and <prefix>.ckpt
+};
+
+struct TrainerProgress {
+    uint64_t iteration = 0;
+    uint64_t games = 0;               // played by the whole run, earlier sessions included
+    double gamesPerSecond = 0.0;      // this iteration, all threads
+    double gamesPerSecondPerCore = 0.0;
+    double gradientNorm = 0.0;
+    double evalMeanRank = 0.0;        // set on evaluation iterations, 0 otherwise
+};
+
+/**
+ * Policy-gradient (REINFORCE) training of a linear softmax policy over the
+ * FeatureEvaluator features of the playable cards: p(card) is proportional
+ * to exp(weights . features(card)). A game's reward for a seat is the average
+ * rank minus its own rank, which needs no learned baseline since all seats
+ * play the same policy.
+ *
+ * Games run straight on GameState bitmasks with maskContext features: no
+ * maps, no strategy objects, no console output. Features, scores and the
+ * expected features of the policy use the SIMD kernels of CandidateBatch.
+ *
+ * The model is written as a FeatureWeights file, which LearnedStrategy (and
+ * YuriaStrategy through SEVENS_YURIA_WEIGHTS) can play. The checkpoint holds
+ * the optimiser state as well; a run started with an existing checkpoint
+ * continues from it.
+ */
+class PolicyTrainer {
+public:
+    explicit PolicyTrainer(TrainerConfig config);
+
+    // Starts from these weights instead of zero (a uniformly random policy); ignored when resuming
+    void setInitialWeights(const FeatureWeights& weights);
+
+    using ProgressCallback = std::function<void(const TrainerProgress&)>;
+    void setProgressCallback(ProgressCallback callback);
+
+    // Trains up to config.iterations in total; returns the final weights
+    FeatureWeights run();
+
+    // Mean rank of the greedy policy in a random seat against random players
+    static double evaluate(const FeatureWeights& weights, uint64_t numPlayers, uint64_t games, uint64_t seed);
+
+private:
+    struct Adam {
+        std::array<double, kNumFeatures> m{};
+        std::array<double, kNumFeatures> v{};
+        uint64_t steps = 0;
+    };
+
+    bool loadCheckpoint();
+    void saveCheckpoint() const;
+    // Sum over the iteration's games of reward x gradient of log p(moves)
+    std::array<double, kNumFeatures> playIteration(unsigned numThreads);
+
+    TrainerConfig config;
+    FeatureWeights weights;
+    Adam adam;
+    uint64_t iteration = 0;
+    uint64_t games = 0;
+    ProgressCallback onProgress;
+};
+
+} // namespace sevens
@@ -0,0 +1,368 @@
+#include "TrainingData.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace sevens {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'S', 'V', 'N', 'T', 'R', 'A', 'I', 'N'};
+constexpr char kIndexMagic[8] = {'S', 'V', 'N', 'T', 'R', 'I', 'D', 'X'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kChunkMagic = 0x4B4E4843;   // "CHNK"
+constexpr size_t kNameBytes = 24;
+constexpr size_t kDescriptorBytes = 32;
+constexpr uint64_t kAlignment = 64;
+
+enum Codec : uint32_t { CodecRaw = 0, CodecShuffleRle = 1 };
+
+// Chunk header: magic, rows, codec, reserved, then per column offset/stored/raw
+constexpr size_t kChunkHeaderBytes = 16;
+constexpr size_t kColumnEntryBytes = 24;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, T value) {
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+T readAt(const uint8_t* data, size_t size, uint64_t offset) {
+    if (offset > size || size - offset < sizeof(T)) {
+        throw std::runtime_error("Training file is truncated");
+    }
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+/**
+ * Byte shuffle, then PackBits-style RLE: a control byte c < 128 is followed by
+ * c + 1 literal bytes, c >= 128 repeats the next byte c - 125 times (3..130).
+ */
+std::vector<uint8_t> encode(const std::vector<uint8_t>& raw, size_t width) {
+    const size_t values = raw.size() / width;
+    std::vector<uint8_t> shuffled(raw.size());
+    for (size_t v = 0; v < values; ++v) {
+        for (size_t b = 0; b < width; ++b) {
+            shuffled[b * values + v] = raw[v * width + b];
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(shuffled.size() / 4 + 16);
+    size_t i = 0;
+    size_t literalStart = 0;
+    auto flushLiterals = [&](size_t end) {
+        while (literalStart < end) {
+            size_t n = std::min<size_t>(128, end - literalStart);
+            out.push_back(static_cast<uint8_t>(n - 1));
+            out.insert(out.end(), shuffled.begin() + literalStart, shuffled.begin() + literalStart + n);
+            literalStart += n;
+        }
+    };
+    while (i < shuffled.size()) {
+        size_t run = 1;
+        while (i + run < shuffled.size() && run < 130 && shuffled[i + run] == shuffled[i]) ++run;
+        if (run >= 3) {
+            flushLiterals(i);
+            out.push_back(static_cast<uint8_t>(run + 125));
+            out.push_back(shuffled[i]);
+            i += run;
+            literalStart = i;
+        } else {
+            i += run;
+        }
+    }
+    flushLiterals(shuffled.size());
+    return out;
+}
+
+void decode(const uint8_t* in, size_t storedSize, size_t rawSize, size_t width, std::vector<uint8_t>& out) {
+    std::vector<uint8_t> shuffled;
+    shuffled.reserve(rawSize);
+    size_t i = 0;
+    while (i < storedSize) {
+        uint8_t control = in[i++];
+        if (control < 128) {
+            size_t n = control + 1u;
+            if (storedSize - i < n) throw std::runtime_error("Corrupt column block");
+            shuffled.insert(shuffled.end(), in + i, in + i + n);
+            i += n;
+        } else {
+            if (i >= storedSize) throw std::runtime_error("Corrupt column block");
+            shuffled.insert(shuffled.end(), control - 125u, in[i++]);
+        }
+    }
+    if (shuffled.size() != rawSize) {
+        throw std::runtime_error("Corrupt column block");
+    }
+
+    const size_t values = rawSize / width;
+    out.resize(rawSize);
+    for (size_t v = 0; v < values; ++v) {
+        for (size_t b = 0; b < width; ++b) {
+            out[v * width + b] = shuffled[b * values + v];
+        }
+    }
+}
+
+} // namespace
+
+size_t columnWidth(ColumnType type) {
+    switch (type) {
+        case ColumnType::UInt8:
+        case ColumnType::Int8: return 1;
+        case ColumnType::UInt16: return 2;
+        case ColumnType::UInt64: return 8;
+        case ColumnType::Float32: return 4;
+    }
+    throw std::invalid_argument("Unknown column type");
+}
+
+ColumnChunk::ColumnChunk(const std::vector<ColumnSpec>& schema)
+    : columns(schema.size())
+{
+    for (const auto& spec : schema) {
+        widths.push_back(columnWidth(spec.type));
+    }
+}
+
+void ColumnChunk::clear() {
+    for (auto& column : columns) column.clear();
+}
+
+TrainingDataWriter::TrainingDataWriter(const std::string& path,
+                                       std::vector<ColumnSpec> schemaIn,
+                                       const std::map<std::string, std::string>& metadata,
+                                       bool compress)
+    : schema(std::move(schemaIn)), compress(compress), out(path, std::ios::binary | std::ios::trunc)
+{
+    if (!out) {
+        throw std::runtime_error("Cannot write training file: " + path);
+    }
+
+    std::string metaText;
+    for (const auto& [key, value] : metadata) {
+        metaText += key + "=" + value + "\n";
+    }
+
+    std::vector<uint8_t> header(kFileMagic, kFileMagic + 8);
+    append<uint32_t>(header, kVersion);
+    append<uint32_t>(header, static_cast<uint32_t>(schema.size()));
+    append<uint32_t>(header, static_cast<uint32_t>(metaText.size()));
+    append<uint32_t>(header, 0);
+    for (const auto& spec : schema) {
+        if (spec.name.size() >= kNameBytes) {
+            throw std::invalid_argument("Column name too long: " + spec.name);
+        }
+        uint8_t descriptor[kDescriptorBytes] = {};
+        std::memcpy(descriptor, spec.name.data(), spec.name.size());
+        descriptor[kNameBytes] = static_cast<uint8_t>(spec.type);
+        header.insert(header.end(), descriptor, descriptor + kDescriptorBytes);
+    }
+    header.insert(header.end(), metaText.begin(), metaText.end());
+
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    offset = header.size();
+    pad();
+}
+
+TrainingDataWriter::~TrainingDataWriter() {
+    try {
+        close();
+    }
+    catch (...) {
+        // A destructor must not throw; the file simply stays without footer
+    }
+}
+
+void TrainingDataWriter::pad() {
+    static const char zeros[kAlignment] = {};
+    const uint64_t aligned = alignUp(offset);
+    out.write(zeros, static_cast<std::streamsize>(aligned - offset));
+    offset = aligned;
+}
+
+void TrainingDataWriter::write(const ColumnChunk& chunk) {
+    const uint64_t chunkRows = chunk.rows();
+    if (chunkRows == 0) return;
+    if (chunk.numColumns() != schema.size()) {
+        throw std::invalid_argument("Chunk does not match the file schema");
+    }
+
+    // Encode outside the lock so that workers compress in parallel
+    std::vector<std::vector<uint8_t>> encoded;
+    std::vector<const std::vector<uint8_t>*> blocks;
+    const Codec codec = compress ? CodecShuffleRle : CodecRaw;
+    for (size_t c = 0; c < schema.size(); ++c) {
+        if (chunk.column(c).size() != chunkRows * columnWidth(schema[c].type)) {
+            throw std::invalid_argument("Column " + schema[c].name + " has the wrong number of rows");
+        }
+        if (compress) {
+            encoded.push_back(encode(chunk.column(c), columnWidth(schema[c].type)));
+        }
+    }
+    for (size_t c = 0; c < schema.size(); ++c) {
+        blocks.push_back(compress ? &encoded[c] : &chunk.column(c));
+    }
+
+    std::vector<uint8_t> header;
+    append<uint32_t>(header, kChunkMagic);
+    append<uint32_t>(header, static_cast<uint32_t>(chunkRows));
+    append<uint32_t>(header, codec);
+    append<uint32_t>(header, 0);
+    uint64_t blockOffset = alignUp(kChunkHeaderBytes + kColumnEntryBytes * schema.size());
+    for (size_t c = 0; c < schema.size(); ++c) {
+        append<uint64_t>(header, blockOffset);
+        append<uint64_t>(header, blocks[c]->size());
+        append<uint64_t>(header, chunk.column(c).size());
+        blockOffset = alignUp(blockOffset + blocks[c]->size());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) {
+        throw std::logic_error("Training file already closed");
+    }
+    const uint64_t start = offset;
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    offset += header.size();
+    for (const auto* block : blocks) {
+        pad();
+        out.write(reinterpret_cast<const char*>(block->data()), static_cast<std::streamsize>(block->size()));
+        offset += block->size();
+    }
+    pad();
+    if (!out) {
+        throw std::runtime_error("Failed to write training chunk");
+    }
+    chunkOffsets.push_back(start);
+    rows += chunkRows;
+}
+
+void TrainingDataWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) return;
+    closed = true;
+
+    std::vector<uint8_t> footer;
+    for (uint64_t chunkOffset : chunkOffsets) {
+        append<uint64_t>(footer, chunkOffset);
+    }
+    append<uint64_t>(footer, chunkOffsets.size());
+    footer.insert(footer.end(), kIndexMagic, kIndexMagic + 8);
+    out.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+    offset += footer.size();
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to finish training file");
+    }
+}
+
+uint64_t TrainingDataWriter::rowsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return rows;
+}
+
+uint64_t TrainingDataWriter::bytesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return offset;
+}
+
+TrainingDataReader::TrainingDataReader(const std::string& path)
+    : file(path)
+{
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    if (size < 32 || std::memcmp(data, kFileMagic, 8) != 0) {
+        throw std::runtime_error(path + " is not a training data file");
+    }
+    if (readAt<uint32_t>(data, size, 8) != kVersion) {
+        throw std::runtime_error(path + " has an unsupported version");
+    }
+    const uint32_t numColumns = readAt<uint32_t>(data, size, 12);
+    const uint32_t metaBytes = readAt<uint32_t>(data, size, 16);
+
+    uint64_t at = 24;
+    for (uint32_t c = 0; c < numColumns; ++c, at += kDescriptorBytes) {
+        readAt<uint8_t>(data, size, at + kDescriptorBytes - 1);
+        const char* name = reinterpret_cast<const char*>(data + at);
+        ColumnSpec spec{std::string(name, strnlen(name, kNameBytes)), static_cast<ColumnType>(data[at + kNameBytes])};
+        columnWidth(spec.type);   // rejects unknown types
+        columns.push_back(spec);
+    }
+    if (size - at < metaBytes) {
+        throw std::runtime_error("Training file is truncated");
+    }
+    std::istringstream metaText(std::string(reinterpret_cast<const char*>(data + at), metaBytes));
+    std::string line;
+    while (std::getline(metaText, line)) {
+        size_t equals = line.find('=');
+        if (equals != std::string::npos) meta[line.substr(0, equals)] = line.substr(equals + 1);
+    }
+
+    if (std::memcmp(data + size - 8, kIndexMagic, 8) != 0) {
+        throw std::runtime_error(path + " has no chunk index (was the writer closed?)");
+    }
+    const uint64_t numChunks = readAt<uint64_t>(data, size, size - 16);
+    if (numChunks > (size - 16) / 8) {
+        throw std::runtime_error("Training file is truncated");
+    }
+    const uint64_t indexStart = size - 16 - numChunks * 8;
+    for (uint64_t i = 0; i < numChunks; ++i) {
+        uint64_t chunkOffset = readAt<uint64_t>(data, size, indexStart + i * 8);
+        if (readAt<uint32_t>(data, size, chunkOffset) != kChunkMagic) {
+            throw std::runtime_error("Corrupt chunk index in " + path);
+        }
+        readAt<uint64_t>(data, size, chunkOffset + kChunkHeaderBytes + kColumnEntryBytes * columns.size() - 8);
+        chunkOffsets.push_back(chunkOffset);
+    }
+}
+
+size_t TrainingDataReader::columnIndex(const std::string& name) const {
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (columns[c].name == name) return c;
+    }
+    throw std::out_of_range("No column named " + name);
+}
+
+uint64_t TrainingDataReader::rows(size_t chunk) const {
+    return readAt<uint32_t>(file.data(), file.size(), chunkOffsets.at(chunk) + 4);
+}
+
+uint64_t TrainingDataReader::totalRows() const {
+    uint64_t total = 0;
+    for (size_t chunk = 0; chunk < chunks(); ++chunk) total += rows(chunk);
+    return total;
+}
+
+const uint8_t* TrainingDataReader::columnData(size_t chunk, size_t column, std::vector<uint8_t>& scratch) const {
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    const uint64_t start = chunkOffsets.at(chunk);
+    const uint32_t codec = readAt<uint32_t>(data, size, start + 8);
+    const uint64_t entry = start + kChunkHeaderBytes + kColumnEntryBytes * column;
+    const uint64_t blockOffset = start + readAt<uint64_t>(data, size, entry);
+    const uint64_t stored = readAt<uint64_t>(data, size, entry + 8);
+    const uint64_t raw = readAt<uint64_t>(data, size, entry + 16);
+    const size_t width = columnWidth(columns.at(column).type);
+    if (blockOffset > size || size - blockOffset < stored || raw != rows(chunk) * width) {
+        throw std::runtime_error("Corrupt column block");
+    }
+
+    if (codec == CodecRaw) {
+        return data + blockOffset;
+    }
+    if (codec != CodecShuffleRle) {
+        throw std::runtime_error("Unknown chunk codec");
+    }
+    decode(data + blockOffset, stored, raw, width, scratch);
+    return scratch.data();
+}
+
+} // namespace sevens
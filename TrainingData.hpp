@@ -0,0 +1,140 @@
+#pragma once
+
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Columnar, chunked binary file for training rows.
+ *
+ * Layout (little endian):
+ *   header   "SVNTRAIN", version, column count, metadata length,
+ *            one 32-byte descriptor per column (name, type), metadata text
+ *   chunks   a chunk header (row count, codec, and offset/stored size/raw size
+ *            of every column), then the column blocks; chunk and block offsets
+ *            are multiples of 64
+ *   footer   file offset of every chunk, chunk count, "SVNTRIDX"
+ *
+ * Raw columns can be used straight from a memory mapping. Compressed columns
+ * are byte-shuffled (all first bytes of the values, then all second bytes...)
+ * and run-length encoded, which suits the small integers and 0/1 features
+ * most columns hold.
+ */
+enum class ColumnType : uint8_t { UInt8, Int8, UInt16, UInt64, Float32 };
+
+size_t columnWidth(ColumnType type);
+
+struct ColumnSpec {
+    std::string name;      // at most 23 characters
+    ColumnType type;
+};
+
+// Column buffers of one chunk while it is being filled
+class ColumnChunk {
+public:
+    explicit ColumnChunk(const std::vector<ColumnSpec>& schema);
+
+    // Appends value to a column; T must match the column's width
+    template <typename T>
+    void push(size_t column, T value) {
+        if (sizeof(T) != widths[column]) {
+            throw std::logic_error("Value does not match the column type");
+        }
+        auto& buffer = columns[column];
+        const size_t at = buffer.size();
+        buffer.resize(at + sizeof(T));
+        std::memcpy(buffer.data() + at, &value, sizeof(T));
+    }
+
+    // Rows are counted by the first column
+    uint64_t rows() const { return columns.empty() ? 0 : columns[0].size() / widths[0]; }
+    const std::vector<uint8_t>& column(size_t c) const { return columns[c]; }
+    size_t numColumns() const { return columns.size(); }
+    void clear();
+
+private:
+    std::vector<size_t> widths;
+    std::vector<std::vector<uint8_t>> columns;
+};
+
+/**
+ * Appends chunks to a training file. write() may be called from several
+ * threads: chunks are encoded by the calling thread and only the file append
+ * is serialized. The footer is written by close() (or the destructor).
+ */
+class TrainingDataWriter {
+public:
+    TrainingDataWriter(const std::string& path,
+                       std::vector<ColumnSpec> schema,
+                       const std::map<std::string, std::string>& metadata,
+                       bool compress);
+    ~TrainingDataWriter();
+
+    void write(const ColumnChunk& chunk);
+    void close();
+
+    uint64_t rowsWritten() const;
+    uint64_t bytesWritten() const;
+
+private:
+    void pad();
+
+    std::vector<ColumnSpec> schema;
+    bool compress;
+    mutable std::mutex mutex;
+    std::ofstream out;
+    uint64_t offset = 0;
+    uint64_t rows = 0;
+    std::vector<uint64_t> chunkOffsets;
+    bool closed = false;
+};
+
+/**
+ * Memory-mapped view of a training file. Throws std::runtime_error for files
+ * that are truncated or not in this format (for example an unclosed writer).
+ */
+class TrainingDataReader {
+public:
+    explicit TrainingDataReader(const std::string& path);
+
+    const std::vector<ColumnSpec>& schema() const { return columns; }
+    const std::map<std::string, std::string>& metadata() const { return meta; }
+
+    // Index of a column by name; throws std::out_of_range if there is none
+    size_t columnIndex(const std::string& name) const;
+
+    size_t chunks() const { return chunkOffsets.size(); }
+    uint64_t rows(size_t chunk) const;
+    uint64_t totalRows() const;
+
+    /**
+     * Values of one column in one chunk: a pointer into the mapping when the
+     * column is stored raw, otherwise decoded into scratch. Valid as long as
+     * the reader and scratch are.
+     */
+    template <typename T>
+    const T* column(size_t chunk, size_t column, std::vector<uint8_t>& scratch) const {
+        if (sizeof(T) != columnWidth(columns.at(column).type)) {
+            throw std::logic_error("Requested type does not match column " + columns[column].name);
+        }
+        return reinterpret_cast<const T*>(columnData(chunk, column, scratch));
+    }
+
+private:
+    const uint8_t* columnData(size_t chunk, size_t column, std::vector<uint8_t>& scratch) const;
+
+    MappedFile file;
+    std::vector<ColumnSpec> columns;
+    std::map<std::string, std::string> meta;
+    std::vector<uint64_t> chunkOffsets;
+};
+
+} // namespace sevens
@@ -1,334 +1,495 @@
 // YuriaStrategy.cpp
-#include "PlayerStrategy.hpp"
-#include <vector>
-#include <unordered_map>
-#include <unordered_set>
+#include "YuriaStrategy.hpp"
+#include "Deck.hpp"
 #include <algorithm>
-#include <random>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 
 namespace sevens {
 
-class YuriaStrategy : public PlayerStrategy {
-public:
-    YuriaStrategy() {
-        // initialize random number generator
-        auto seed = static_cast<unsigned long>(
-            std::chrono::system_clock::now().time_since_epoch().count()
-        );
-        rng.seed(seed);
-    }
-
-    ~YuriaStrategy() override = default;
-
-    // called once at the start of the game to initialize variables
-    void initialize(uint64_t playerID) override {
-        myID = playerID;
-        round = 0;
-        playedCards.clear();
-        passCounts.clear();
-        suitPlayability.clear();
-        isEarlyGame = true;
-        isMidGame = false;
-        isLateGame = false;
-        std::cout << "[Init] Player " << myID << " initialized.\n";
-    }
-
-    // called every turn to select the best card to play or returns -1 to pass
-    int selectCardToPlay(
-        const std::vector<Card>& hand,
-        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) override
-    {
-        round++;
-        updateGamePhase(); // update game phase (early/mid/late) based on total cards played
-        
-        std::cout << "\n[Turn " << round << "] Player " << myID << " selecting card...\n";
-        std::cout << "  Current hand: ";
-        for (const auto& c : hand) std::cout << c << " ";
-        std::cout << "\n";
-
-        std::vector<std::pair<int, int>> candidates; // {card index, score}
-        std::unordered_map<int, int> suitCount;     // count cards of each suit in hand
-        for (const auto& c : hand) suitCount[c.suit]++;
-        
-        // Update suit playability based on the current table layout
-        updateSuitPlayability(tableLayout);
-
-        for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
-            const Card& card = hand[i];
-            if (!isPlayable(card, tableLayout)) continue;
-            
-            int score = evaluateCard(card, hand, tableLayout, suitCount);
-            
-            // show how the card was evaluated
-            std::cout << "  -> Candidate " << card
-                      << " | score=" << score 
-                      << " | " << getEvaluationDetails(card, hand, tableLayout, suitCount) << "\n";
-
-            candidates.emplace_back(i, score);
-        }
+YuriaStrategy::YuriaStrategy(const YuriaStrategy* prototype) {
+    // initialize random number generator (the counter separates copies made in the same tick)
+    static std::atomic<uint64_t> instances{0};
+    auto seed = static_cast<unsigned long>(
+        std::chrono::system_clock::now().time_since_epoch().count() +
+        instances.fetch_add(1, std::memory_order_relaxed) * 0x9E3779B97F4A7C15ULL
+    );
+    rng.seed(seed);
 
-        // No playable cards -> passing instead
-        if (candidates.empty()) {
-            std::cout << "  -> No playable cards. Passing.\n";
-            return -1;
+    if (prototype) {
+        if (prototype->search) {
+            search = std::make_unique<IsmctsSearch>(prototype->search->configuration());
         }
+        weights = prototype->weights;
+        profiles = prototype->profiles;
+        tablebase = prototype->tablebase;
+        book = prototype->book;
+        return;
+    }
+    SearchConfig searchConfig = SearchConfig::fromEnvironment();
+    if (searchConfig.enabled()) {
+        search = std::make_unique<IsmctsSearch>(searchConfig);
+    }
+    weights = loadWeights();
+    profiles = loadProfiles();
+    tablebase = loadTablebase();
+    book = loadBook();
+}
 
-        // sort cards by score descending on and choose the highest scoring one
-        std::sort(candidates.begin(), candidates.end(),
-                 [](auto& a, auto& b) { return a.second > b.second; });
+PlayerStrategy* YuriaStrategy::clone() const {
+    return new YuriaStrategy(this);
+}
 
-        const Card& chosen = hand[candidates.front().first];
-        std::cout << "  -> Playing: " << chosen << " (score=" << candidates.front().second << ")\n";
-        return candidates.front().first;
+// called once at the start of the game to initialize variables
+void YuriaStrategy::initialize(uint64_t playerID) {
+    myID = playerID;
+    round = 0;
+    totalPlayed = 0;
+    std::fill(std::begin(playedInSuit), std::end(playedInSuit), 0);
+    passCounts.clear();
+    blockProbabilities.clear();
+    suitPlayability.clear();
+    isEarlyGame = true;
+    isMidGame = false;
+    isLateGame = false;
+    if (search) search->newGame(playerID);
+    tableMask = 0;
+    for (int suit = 0; suit < 4; suit++) tableMask |= IsmctsSearch::cardBit(suit, 7);
+    playedBy.fill(0);
+    notHeld.fill(0);
+    seatProfiles.assign(seatNames.size(), nullptr);
+    recordsProfiles = false;
+    if (profiles) {
+        // Every Yuria seat reads the profiles; only the first one writes, so each turn counts once
+        const auto firstYuria = std::find(seatNames.begin(), seatNames.end(), std::string(kName));
+        recordsProfiles = firstYuria != seatNames.end() &&
+                          static_cast<uint64_t>(firstYuria - seatNames.begin()) == myID;
+        for (size_t seat = 0; seat < seatNames.size(); seat++) {
+            if (seatNames[seat].empty()) continue;
+            seatProfiles[seat] = profiles->profile(seatNames[seat]);
+            if (recordsProfiles && seatProfiles[seat]) seatProfiles[seat]->games.fetch_add(1, std::memory_order_relaxed);
+        }
     }
+    std::cout << "[Init] Player " << myID << " initialized.\n";
+}
+
+// called every turn to select the best card to play or returns -1 to pass
+int YuriaStrategy::selectCardToPlay(
+    const std::vector<Card>& hand,
+    const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout)
+{
+    round++;
+    history.catchUp([this](const GameEvent& event) { applyEvent(event); });
+    updateGamePhase(); // update game phase (early/mid/late) based on total cards played
+
+    std::cout << "\n[Turn " << round << "] Player " << myID << " selecting card...\n";
+    std::cout << "  Current hand: ";
+    for (const auto& c : hand) std::cout << c << " ";
+    std::cout << "\n";
 
-    // called when another player successfully plays a card
-    void observeMove(uint64_t playerID, const Card& playedCard) override {
-        playedCards[playedCard.suit].insert(playedCard.rank);
-        passCounts[playerID] = 0;   // reset pass count for this player
-        
-        // if a player plays a 7, mark that suit as highly playable
-        if (playedCard.rank == 7) {
-            suitPlayability[playedCard.suit] = 2; 
+    if (book && isEarlyGame) {
+        const int bookIndex = bookMove(hand);
+        if (bookIndex >= 0) {
+            std::cout << "  -> Playing from the opening book: " << hand[bookIndex] << "\n";
+            observeOwnMove(&hand[bookIndex]);
+            return bookIndex;
         }
-        
-        std::cout << "[ObserveMove] Player " << playerID << " played " << playedCard << "\n";
     }
 
-    // called when another player passes
-    void observePass(uint64_t playerID) override {
-        passCounts[playerID]++;
-        
+    // Update suit playability based on the current table layout
+    updateSuitPlayability(tableLayout);
+    buildContext(hand, tableLayout);
+
+    // Features of every playable card, scored together against the weights
+    candidates.clear();
+    int handIndex[CandidateBatch::kMaxCandidates];
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+        if (!isPlayable(hand[i])) continue;
+        handIndex[candidates.add(context, hand[i])] = i;
+    }
+
+    // No playable cards -> passing instead
+    if (candidates.size() == 0) {
+        std::cout << "  -> No playable cards. Passing.\n";
+        observeOwnMove(nullptr);
+        return -1;
+    }
+
+    alignas(32) float scores[CandidateBatch::kMaxCandidates];
+    candidates.score(*weights, scores);
+
+    // choose the highest scoring card (the first one on ties)
+    size_t best = 0;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        // show how the card was evaluated
+        std::cout << "  -> Candidate " << hand[handIndex[c]]
+                  << " | score=" << scores[c]
+                  << " | " << getEvaluationDetails(c, hand[handIndex[c]]) << "\n";
+        if (scores[c] > scores[best]) best = c;
+    }
+
+    int chosenIndex = handIndex[best];
+    const bool solved = tablebase && isLateGame && candidates.size() > 1 && tablebaseMove(hand, chosenIndex);
+    if (!solved && search && candidates.size() > 1) {
+        chosenIndex = searchMove(hand, chosenIndex);
+    }
+
+    const Card& chosen = hand[chosenIndex];
+    std::cout << "  -> Playing: " << chosen << "\n";
+    observeOwnMove(&chosen);
+    return chosenIndex;
+}
+
+// called when another player successfully plays a card (engines without an event log)
+void YuriaStrategy::observeMove(uint64_t playerID, const Card& playedCard) {
+    if (history.attached()) return;
+    applyEvent(GameEvent{playerID, playedCard, false});
+    std::cout << "[ObserveMove] Player " << playerID << " played " << playedCard << "\n";
+}
+
+// called when another player passes (engines without an event log)
+void YuriaStrategy::observePass(uint64_t playerID) {
+    if (history.attached()) return;
+    applyEvent(GameEvent{playerID, Card{0, 0}, true});
+    std::cout << "[ObservePass] Player " << playerID << " passed. Total passes: " << passCounts[playerID] << "\n";
+}
+
+// fold one move or pass into the history counters
+void YuriaStrategy::applyEvent(const GameEvent& event) {
+    if (search) search->observe(event);
+    recordTurn(event);
+    const bool opponent = event.playerID != myID;   // our own turns say nothing about blocked opponents
+    const OpponentProfile* profile = opponent && event.playerID < seatProfiles.size()
+                                         ? seatProfiles[event.playerID] : nullptr;
+    const int phase = OpponentProfile::phaseOf(totalPlayed);
+    if (event.pass) {
+        if (!opponent) return;
+        passCounts[event.playerID]++;
+        if (event.playerID < notHeld.size()) notHeld[event.playerID] |= IsmctsSearch::playableCells(tableMask);
+
         // if a player passes twice, we suspect they're blocked in a suit
-        if (passCounts[playerID] >= 2) {
-            blockProbabilities[playerID]++;
-        }
-        
-        std::cout << "[ObservePass] Player " << playerID << " passed. Total passes: " << passCounts[playerID] << "\n";
-    }
-
-    std::string getName() const override {
-        return "YuriaStrategy";
-    }
-
-private:
-    uint64_t myID;
-    int round = 0;
-    std::mt19937 rng;
-    // maps suits to the set of ranks that have already been played
-    std::unordered_map<uint64_t, std::unordered_set<uint64_t>> playedCards;
-    // number of consecutive passes per player
-    std::unordered_map<uint64_t, int> passCounts;
-    // estimated probability that a player is blocked (based on passes)
-    std::unordered_map<uint64_t, int> blockProbabilities;
-    // estimated playability of each suit 0=low 1=medium 2=high
-    std::unordered_map<int, int> suitPlayability;
-    
-    // Game phase flags
-    bool isEarlyGame;
-    bool isMidGame;
-    bool isLateGame;
-
-    // determine the current game phase based on how many cards have been played
-    void updateGamePhase() {
-        int totalPlayed = 0;
-        for (const auto& [suit, ranks] : playedCards) {
-            totalPlayed += ranks.size();
-        }
-        
-        if (totalPlayed < 10) {
-            isEarlyGame = true;
-            isMidGame = false;
-            isLateGame = false;
-        } else if (totalPlayed < 30) {
-            isEarlyGame = false;
-            isMidGame = true;
-            isLateGame = false;
-        } else {
-            isEarlyGame = false;
-            isMidGame = false;
-            isLateGame = true;
+        // (unless they are known to pass most of the time anyway)
+        if (passCounts[event.playerID] >= 2 && !habitualPasser(profile, phase)) {
+            blockProbabilities[event.playerID]++;
         }
+        return;
     }
-    
-    // evaluate the playability of each suit using table layout
-    void updateSuitPlayability(const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) {
-        for (int suit = 1; suit <= 4; suit++) {
-            if (!tableLayout.count(suit)) {
-                suitPlayability[suit] = 0; // suit not yet opened
-                continue;
-            }
-            
-            const auto& layout = tableLayout.at(suit);
-            int openEnds = 0;       // number of ranks with one neighbor still unplayed
-            int coveredRanks = 0;   // how many cards in this suit are already on the table
-            
-            for (int r = 1; r <= 13; r++) {
-                if (layout.count(r) && layout.at(r)) {
-                    coveredRanks++;
-                    
-                    // check if it's an open end
-                    if ((r > 1 && (!layout.count(r-1) || !layout.at(r-1))) ||
-                        (r < 13 && (!layout.count(r+1) || !layout.at(r+1)))) {
-                        openEnds++;
-                    }
-                }
-            }
-            
-            // assign playability level based on open ends
-            if (openEnds >= 3) suitPlayability[suit] = 2; 
-            else if (openEnds >= 1) suitPlayability[suit] = 1; 
-            else suitPlayability[suit] = 0; 
-            
-            // if 10+ cards are played in a suit, consider it highly active
-            if (coveredRanks >= 10) suitPlayability[suit] = 2;
-        }
+
+    const int cardIndex = event.card.suit * 13 + event.card.rank - 1;
+    tableMask |= uint64_t{1} << cardIndex;
+    if (event.playerID < playedBy.size()) playedBy[event.playerID]++;
+
+    totalPlayed++;
+    playedInSuit[event.card.suit]++;
+    if (opponent) passCounts[event.playerID] = 0;   // reset pass count for this player
+
+    // if a player plays a 7, mark that suit as highly playable
+    if (event.card.rank == 7) {
+        suitPlayability[event.card.suit] = 2;
     }
-    
-    // Compute a score for a card based on various tactical factors
-    int evaluateCard(const Card& card, const std::vector<Card>& hand, 
-                     const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout,
-                     const std::unordered_map<int, int>& suitCount) {
-        int score = 0;
-        bool is7 = (card.rank == 7);
-        bool isEdge = (card.rank == 1 || card.rank == 13);
-        bool hasNeighbor = hasChain(card, hand);
-        bool risky = opensBothEnds(card, tableLayout);
-        int chainLength = calculateChainLength(card, hand);
-        
-        // Reward playing 7s
-        if (is7) score += 200;  
-        
-        // Adjust scoring by game phase
-        if (isEarlyGame) {
-            if (is7) score += 100;
-            score += chainLength * 30;
-            if (hasNeighbor) score += 70;
-            if (isEdge) score += 20;
-        } else if (isMidGame) {
-            score += chainLength * 50;
-            if (suitCount.at(card.suit) >= 3) score += 60;
-            if (isEdge) score += 40;
-        } else { // late game
-            score += suitCount.at(card.suit) * 50;
-            score += (13 - static_cast<int>(playedCards[card.suit].size())) * 10;
-        }
-        
-        score += suitPlayability[card.suit] * 40;
-        
-        // penalize cards that open both ends (create many new options for other players)
-        if (risky) score -= 80;
-        
-        // Bonus if opponents are likely blocked
-        int blockedPlayers = 0;
-        for (const auto& [pid, count] : blockProbabilities) {
-            if (count >= 2) blockedPlayers++;
-        }
-        if (blockedPlayers > 0) score += 30;
-        
-        // Bonus for strong edge card combos
-        if (isEdge) {
-            if (card.rank == 1 && hasCardWithRank(hand, card.suit, 2)) score += 80;
-            if (card.rank == 13 && hasCardWithRank(hand, card.suit, 12)) score += 80;
+}
+
+// a seat's turn in its strategy's profile, from the one seat that records the game
+void YuriaStrategy::recordTurn(const GameEvent& event) {
+    if (!recordsProfiles || event.playerID >= seatProfiles.size() || !seatProfiles[event.playerID]) return;
+    OpponentProfile* profile = seatProfiles[event.playerID];
+    const int phase = OpponentProfile::phaseOf(totalPlayed);
+    if (!event.pass) {
+        profile->recordPlay(phase, event.card.suit * 13 + event.card.rank - 1);
+        return;
+    }
+    const uint64_t open = IsmctsSearch::playableCells(tableMask);
+    unsigned openSuits = 0;
+    for (int suit = 0; suit < 4; suit++) {
+        if ((open >> (suit * 13)) & 0x1FFF) openSuits |= 1u << suit;
+    }
+    profile->recordPass(phase, openSuits);
+}
+
+// enough history to say this opponent passes most turns of the phase
+bool YuriaStrategy::habitualPasser(const OpponentProfile* profile, int phase) {
+    return profile && profile->count(profile->turns[phase]) >= 100 && profile->passRate(phase) > 0.75;
+}
+
+// The history counters need every move in order; the event log includes
+// our own, the observe callbacks don't
+void YuriaStrategy::observeOwnMove(const Card* card) {
+    if (history.attached()) return;
+    applyEvent(card ? GameEvent{myID, *card, false} : GameEvent{myID, Card{0, 0}, true});
+}
+
+// Hand index of the card the search picks, or the heuristic's choice if it can't decide
+int YuriaStrategy::searchMove(const std::vector<Card>& hand, int heuristicIndex) {
+    uint64_t handMask = 0;
+    uint64_t table = 0;
+    for (const auto& c : hand) handMask |= IsmctsSearch::cardBit(c.suit, c.rank);
+    for (int suit = 0; suit < 4; suit++) {
+        for (int rank = 1; rank <= 13; rank++) {
+            if (context.onTable[suit][rank]) table |= IsmctsSearch::cardBit(suit, rank);
         }
-        
-        return score;
-    }
-    
-    // build a string to explain how a card's score was computed
-    std::string getEvaluationDetails(const Card& card, const std::vector<Card>& hand, 
-                                     const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout,
-                                     const std::unordered_map<int, int>& suitCount) {
-        std::string details;
-        bool is7 = (card.rank == 7);
-        bool isEdge = (card.rank == 1 || card.rank == 13);
-        bool hasNeighbor = hasChain(card, hand);
-        bool risky = opensBothEnds(card, tableLayout);
-        int chainLength = calculateChainLength(card, hand);
-        
-        details = "Phase=" + std::string(isEarlyGame ? "Early" : (isMidGame ? "Mid" : "Late"));
-        details += " | Chain=" + std::to_string(chainLength);
-        details += " | Suit=" + std::to_string(card.suit) + "(play=" + std::to_string(suitPlayability[card.suit]) + ")";
-        if (is7) details += " | Seven";
-        if (isEdge) details += " | Edge";
-        if (hasNeighbor) details += " | HasNeighbor";
-        if (risky) details += " | Risky";
-        
-        return details;
-    }
-
-    // Check if a card can be legally played given the current table layout
-    bool isPlayable(const Card& card,
-                    const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) {
-        if (!tableLayout.count(card.suit)) {
-            return card.rank == 7;
+    }
+
+    const int move = search->chooseMove(handMask, table);
+    const auto& stats = search->lastStats();
+    std::cout << "  -> Search: " << stats.iterations << " iterations, " << stats.nodes
+              << " nodes (" << stats.reusedNodes << " reused)\n";
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+        if (hand[i].suit * 13 + hand[i].rank - 1 == move) return i;
+    }
+    return heuristicIndex;
+}
+
+// Hand index of the book move for this hand and table, or -1 if the book doesn't know the situation
+int YuriaStrategy::bookMove(const std::vector<Card>& hand) const {
+    const size_t n = seatNames.size();
+    if (n < 2 || n > GameState::kMaxPlayers || myID >= n) return -1;
+    GameState state;
+    state.numPlayers = static_cast<uint8_t>(n);
+    state.toMove = static_cast<uint8_t>(myID);
+    state.setTable(tableMask);
+    for (const auto& c : hand) state.hands[myID] |= IsmctsSearch::cardBit(c.suit, c.rank);
+    const int card = book->lookup(state);
+    for (int i = 0; card >= 0 && i < static_cast<int>(hand.size()); ++i) {
+        if (hand[i].suit * 13 + hand[i].rank - 1 == card) return i;
+    }
+    return -1;
+}
+
+// Card with the best expected place over every deal of the unseen cards the
+// history allows; false when there are too many cards left or the counts don't add up
+bool YuriaStrategy::tablebaseMove(const std::vector<Card>& hand, int& chosenIndex) {
+    const size_t n = seatNames.size();
+    if (n != tablebase->numPlayers() || myID >= n) return false;
+
+    GameState state;
+    state.numPlayers = static_cast<uint8_t>(n);
+    state.toMove = static_cast<uint8_t>(myID);
+    state.setTable(tableMask);
+    for (const auto& c : hand) state.hands[myID] |= IsmctsSearch::cardBit(c.suit, c.rank);
+    const uint64_t unseen = GameState::kAllCards & ~tableMask & ~state.hands[myID];
+
+    std::vector<int> cards;
+    for (int i = 0; i < 52; i++) {
+        if ((unseen >> i) & 1) cards.push_back(i);
+    }
+    if (cards.size() + hand.size() > tablebase->maxCards()) return false;
+
+    // Cards each opponent still holds
+    std::array<uint64_t, GameState::kMaxPlayers> left{};
+    uint64_t total = 0;
+    for (size_t p = 0; p < n; p++) {
+        const uint64_t dealt = handSize(n, p);
+        if (p == myID) continue;
+        if (playedBy[p] > dealt) return false;
+        left[p] = dealt - playedBy[p];
+        total += left[p];
+    }
+    if (total != cards.size()) return false;
+
+    std::array<double, 53> rankSum{};
+    std::array<uint8_t, 53> rankAfter{};
+    uint64_t deals = 0;
+    auto deal = [&](auto& self, size_t i) -> void {
+        if (i == cards.size()) {
+            if (!tablebase->moveValues(state, rankAfter)) return;
+            for (uint64_t moves = state.legalMoves(); moves; moves &= moves - 1) {
+                const int move = GameState::lowestBit(moves);
+                rankSum[move] += rankAfter[move];
+            }
+            deals++;
+            return;
         }
-        
-        const auto& layout = tableLayout.at(card.suit);
-        if (card.rank == 7) return !layout.count(7) || !layout.at(7);
-        
-        bool canPlayLower = card.rank > 1 && layout.count(card.rank - 1) && layout.at(card.rank - 1);
-        bool canPlayHigher = card.rank < 13 && layout.count(card.rank + 1) && layout.at(card.rank + 1);
-        
-        return (canPlayLower || canPlayHigher) && (!layout.count(card.rank) || !layout.at(card.rank));
-    }
-    
-    // Check if we have a card that can form a chain with this one
-    bool hasChain(const Card& card, const std::vector<Card>& hand) {
-        return hasCardWithRank(hand, card.suit, card.rank - 1) ||
-               hasCardWithRank(hand, card.suit, card.rank + 1);
-    }
-    
-    // Check if playing this card would create playable positions on both sides
-    bool opensBothEnds(const Card& card,
-                        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) {
-        if (!tableLayout.count(card.suit)) return false;
-        const auto& layout = tableLayout.at(card.suit);
-        
-        bool hasLower = card.rank > 1 && layout.count(card.rank - 1) && layout.at(card.rank - 1);
-        bool hasHigher = card.rank < 13 && layout.count(card.rank + 1) && layout.at(card.rank + 1);
-        
-        return hasLower && hasHigher;
-    }
-    
-    // Calculate the length of the chain of cards we could play
-    int calculateChainLength(const Card& card, const std::vector<Card>& hand) {
-        int length = 1;
-        uint64_t rank = card.rank;
-        
-        // count cards below
-        while (rank > 1 && hasCardWithRank(hand, card.suit, rank - 1)) {
-            length++;
-            rank--;
+        const uint64_t bit = uint64_t{1} << cards[i];
+        for (size_t p = 0; p < n; p++) {
+            if (!left[p] || (notHeld[p] & bit)) continue;
+            left[p]--;
+            state.hands[p] |= bit;
+            self(self, i + 1);
+            state.hands[p] &= ~bit;
+            left[p]++;
         }
-        
-        // count cards above
-        rank = card.rank;
-        while (rank < 13 && hasCardWithRank(hand, card.suit, rank + 1)) {
-            length++;
-            rank++;
+    };
+    deal(deal, 0);
+    if (deals == 0) return false;
+
+    int bestIndex = chosenIndex;
+    auto moveOf = [&](int i) { return hand[i].suit * 13 + hand[i].rank - 1; };
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+        if (isPlayable(hand[i]) && rankSum[moveOf(i)] < rankSum[moveOf(bestIndex)]) bestIndex = i;
+    }
+    std::cout << "  -> Tablebase: " << deals << " deals, expected place among players left "
+              << 1.0 + rankSum[moveOf(bestIndex)] / static_cast<double>(deals) << "\n";
+    chosenIndex = bestIndex;
+    return true;
+}
+
+// determine the current game phase based on how many cards have been played
+void YuriaStrategy::updateGamePhase() {
+    if (totalPlayed < 10) {
+        isEarlyGame = true;
+        isMidGame = false;
+        isLateGame = false;
+    } else if (totalPlayed < 30) {
+        isEarlyGame = false;
+        isMidGame = true;
+        isLateGame = false;
+    } else {
+        isEarlyGame = false;
+        isMidGame = false;
+        isLateGame = true;
+    }
+}
+
+// evaluate the playability of each suit using table layout
+void YuriaStrategy::updateSuitPlayability(const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) {
+    for (int suit = 0; suit < 4; suit++) {
+        if (!tableLayout.count(suit)) {
+            suitPlayability[suit] = 0; // suit not yet opened
+            continue;
         }
-        
-        return length;
-    }
-    
-    // Check if we have a card of the given suit and rank in our hand
-    bool hasCardWithRank(const std::vector<Card>& hand, uint64_t suit, uint64_t rank) {
-        if (rank < 1 || rank > 13) return false;
-        for (const auto& c : hand) {
-            if (static_cast<uint64_t>(c.suit) == suit && static_cast<uint64_t>(c.rank) == rank) {
-                return true;
+
+        const auto& layout = tableLayout.at(suit);
+        int openEnds = 0;       // number of ranks with one neighbor still unplayed
+        int coveredRanks = 0;   // how many cards in this suit are already on the table
+
+        for (int r = 1; r <= 13; r++) {
+            if (layout.count(r) && layout.at(r)) {
+                coveredRanks++;
+
+                // check if it's an open end
+                if ((r > 1 && (!layout.count(r-1) || !layout.at(r-1))) ||
+                    (r < 13 && (!layout.count(r+1) || !layout.at(r+1)))) {
+                    openEnds++;
+                }
             }
         }
-        return false;
+
+        // assign playability level based on open ends
+        if (openEnds >= 3) suitPlayability[suit] = 2;
+        else if (openEnds >= 1) suitPlayability[suit] = 1;
+        else suitPlayability[suit] = 0;
+
+        // if 10+ cards are played in a suit, consider it highly active
+        if (coveredRanks >= 10) suitPlayability[suit] = 2;
     }
-};
+}
+
+// Flatten hand, table and observations into the evaluator's input
+void YuriaStrategy::buildContext(const std::vector<Card>& hand,
+                                 const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) {
+    context = FeatureContext{};
+    context.phase = isEarlyGame ? 0 : (isMidGame ? 1 : 2);
+    for (const auto& c : hand) {
+        context.inHand[c.suit][c.rank] = true;
+        context.suitCount[c.suit]++;
+    }
+    for (const auto& [suit, ranks] : tableLayout) {
+        if (suit > 3) continue;
+        for (const auto& [rank, present] : ranks) {
+            if (present && rank >= 1 && rank <= 13) context.onTable[suit][rank] = true;
+        }
+    }
+    for (int suit = 0; suit < 4; suit++) {
+        context.playedInSuit[suit] = playedInSuit[suit];
+        auto itPlayability = suitPlayability.find(suit);
+        context.suitPlayability[suit] = itPlayability == suitPlayability.end() ? 0 : itPlayability->second;
+    }
+    for (const auto& [pid, count] : blockProbabilities) {
+        if (count >= 2) context.opponentsBlocked = true;
+    }
+}
+
+// build a string to explain how a candidate's score was computed
+std::string YuriaStrategy::getEvaluationDetails(size_t candidate, const Card& card) const {
+    const int suit = card.suit;
+    const int rank = card.rank;
+    bool hasNeighbor = (rank > 1 && context.inHand[suit][rank - 1]) ||
+                       (rank < 13 && context.inHand[suit][rank + 1]);
+
+    std::string details = "Phase=" + std::string(isEarlyGame ? "Early" : (isMidGame ? "Mid" : "Late"));
+    details += " | Chain=" + std::to_string(chainLength(context, suit, rank));
+    details += " | Suit=" + std::to_string(suit) + "(play=" + std::to_string(context.suitPlayability[suit]) + ")";
+    if (rank == 7) details += " | Seven";
+    if (rank == 1 || rank == 13) details += " | Edge";
+    if (hasNeighbor) details += " | HasNeighbor";
+    if (candidates.feature(candidate, FeatOpensBothEnds) > 0) details += " | Risky";
+    return details;
+}
+
+// Check if a card can be legally played given the current table layout
+bool YuriaStrategy::isPlayable(const Card& card) const {
+    const auto& onTable = context.onTable[card.suit];
+    if (card.rank == 7) return !onTable[7];
+
+    bool canPlayLower = card.rank > 1 && onTable[card.rank - 1];
+    bool canPlayHigher = card.rank < 13 && onTable[card.rank + 1];
+    return (canPlayLower || canPlayHigher) && !onTable[card.rank];
+}
+
+// Profile store named by SEVENS_YURIA_PROFILES, shared by every instance in the process
+std::shared_ptr<OpponentProfileStore> YuriaStrategy::loadProfiles() {
+    const char* path = std::getenv("SEVENS_YURIA_PROFILES");
+    if (!path || !*path) return nullptr;
+    try {
+        return OpponentProfileStore::shared(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Init] " << e.what() << ", not using opponent profiles\n";
+        return nullptr;
+    }
+}
+
+// Tablebase named by SEVENS_YURIA_TABLEBASE, mapped once per process
+std::shared_ptr<const EndgameTablebase> YuriaStrategy::loadTablebase() {
+    const char* path = std::getenv("SEVENS_YURIA_TABLEBASE");
+    if (!path || !*path) return nullptr;
+    try {
+        return EndgameTablebase::shared(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Init] " << e.what() << ", not using the endgame tablebase\n";
+        return nullptr;
+    }
+}
+
+// Opening book named by SEVENS_YURIA_BOOK, mapped once per process
+std::shared_ptr<const OpeningBook> YuriaStrategy::loadBook() {
+    const char* path = std::getenv("SEVENS_YURIA_BOOK");
+    if (!path || !*path) return nullptr;
+    try {
+        return OpeningBook::shared(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Init] " << e.what() << ", not using the opening book\n";
+        return nullptr;
+    }
+}
+
+// Weight file from SEVENS_YURIA_WEIGHTS if set, the hand-tuned defaults otherwise
+std::shared_ptr<const FeatureWeights> YuriaStrategy::loadWeights() {
+    static const auto defaults = std::make_shared<const FeatureWeights>(FeatureWeights::defaults());
+    const char* path = std::getenv("SEVENS_YURIA_WEIGHTS");
+    if (!path || !*path) return defaults;
+    try {
+        return FeatureWeights::load(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Init] " << e.what() << ", using default weights\n";
+        return defaults;
+    }
+}
 
 // Factory function to create a new strategy instance
 extern "C" PlayerStrategy* createStrategy() {
     return new YuriaStrategy();
 }
 
+// Copies a prototype made by createStrategy (see CloneableStrategy)
+extern "C" PlayerStrategy* cloneStrategy(const PlayerStrategy* prototype) {
+    const auto* cloneable = dynamic_cast<const CloneableStrategy*>(prototype);
+    return cloneable ? cloneable->clone() : nullptr;
+}
+
 } // namespace sevens
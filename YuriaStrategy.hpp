@@ -0,0 +1,177 @@
+#pragma once
+
+#include "PlayerStrategy.hpp"
+#include "FeatureEvaluator.hpp"
+#include "GameEventLog.hpp"
+#include "Ismcts.hpp"
+#include "OpponentProfiles.hpp"
+#include "EndgameTablebase.hpp"
+#include "OpeningBook.hpp"
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sevens {
+
+/**
+ * Heuristic strategy: describes every playable card by a feature vector (game
+ * phase, chains, suit playability, opponent passes, ...) and plays the card
+ * with the best linear score. The weights are the hand-tuned defaults unless
+ * SEVENS_YURIA_WEIGHTS names a weight file.
+ * Game history comes from the engine's shared event log when the engine
+ * provides one, otherwise from the observe callbacks.
+ * With a search budget (SEVENS_YURIA_SEARCH_MS or _ITERATIONS) the move is
+ * chosen by an information-set MCTS instead whenever there is a real choice.
+ * With SEVENS_YURIA_PROFILES naming a profile file, what opponents do is
+ * remembered across games by strategy name, and passes of opponents known to
+ * pass most of the time no longer count as signs of a blocked suit.
+ * With SEVENS_YURIA_TABLEBASE naming an endgame tablebase, late moves with few
+ * cards left are read from it, averaged over every split of the unseen cards.
+ * With SEVENS_YURIA_BOOK naming an opening book, early moves in situations the
+ * book knows are played from it before anything else is computed.
+ * Implemented in YuriaStrategy.cpp; the hooks that only store what the engine
+ * hands over are inline so that GameEngine can fold them into its loop.
+ */
+class YuriaStrategy final : public PlayerStrategy, public EventLogReader, public SeatNamesReader,
+                            public CloneableStrategy {
+public:
+    static constexpr const char* kName = "YuriaStrategy";
+
+    YuriaStrategy() : YuriaStrategy(nullptr) {}
+
+    ~YuriaStrategy() override = default;
+
+    // Shares the weights, profiles, tablebase and book; the copy gets its own search pools and RNG seed
+    PlayerStrategy* clone() const override;
+
+    // called once at the start of the game to initialize variables
+    void initialize(uint64_t playerID) override;
+
+    // called every turn to select the best card to play or returns -1 to pass
+    int selectCardToPlay(
+        const std::vector<Card>& hand,
+        const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout) override;
+
+    // engines with a shared event log call this instead of the observe callbacks
+    void attachEventLog(const GameEventLog* log) override {
+        history.attach(log);
+    }
+
+    // strategy names of all seats, for the opponent profiles
+    void setSeatNames(const std::vector<std::string>& names) override {
+        seatNames = names;
+    }
+
+    // called when another player successfully plays a card (engines without an event log)
+    void observeMove(uint64_t playerID, const Card& playedCard) override;
+
+    // called when another player passes (engines without an event log)
+    void observePass(uint64_t playerID) override;
+
+    std::string getName() const override {
+        return kName;
+    }
+
+private:
+    // Reads the configuration and loads the shared data, or takes both from a prototype
+    explicit YuriaStrategy(const YuriaStrategy* prototype);
+
+    uint64_t myID;
+    int round = 0;
+    std::mt19937 rng;
+    // read position in the engine's event log (unattached without one)
+    EventCursor history;
+    // cards played so far, in total and per suit
+    int totalPlayed = 0;
+    int playedInSuit[4] = {};
+    // number of consecutive passes per player
+    std::unordered_map<uint64_t, int> passCounts;
+    // estimated probability that a player is blocked (based on passes)
+    std::unordered_map<uint64_t, int> blockProbabilities;
+    // estimated playability of each suit 0=low 1=medium 2=high
+    std::unordered_map<int, int> suitPlayability;
+
+    // Game phase flags
+    bool isEarlyGame;
+    bool isMidGame;
+    bool isLateGame;
+
+    // optional tree search, created when a search budget is configured
+    std::unique_ptr<IsmctsSearch> search;
+
+    // optional cross-game memory: the shared store and the profile of each seat's strategy
+    std::shared_ptr<OpponentProfileStore> profiles;
+    std::vector<std::string> seatNames;
+    std::vector<OpponentProfile*> seatProfiles;
+    bool recordsProfiles = false;   // this seat writes the game's turns to the profiles
+    uint64_t tableMask = 0;
+
+    // optional endgame tablebase, with what it needs to know about the unseen cards
+    std::shared_ptr<const EndgameTablebase> tablebase;
+    std::array<uint64_t, GameState::kMaxPlayers> playedBy{};   // cards played per seat
+    std::array<uint64_t, GameState::kMaxPlayers> notHeld{};    // cards a seat passed on while playable
+
+    // optional opening book for the early game
+    std::shared_ptr<const OpeningBook> book;
+
+    // evaluator state: shared read-only weights, inputs and candidates of the current decision
+    std::shared_ptr<const FeatureWeights> weights;
+    FeatureContext context;
+    CandidateBatch candidates;
+
+    // fold one move or pass into the history counters
+    void applyEvent(const GameEvent& event);
+
+    // a seat's turn in its strategy's profile, from the one seat that records the game
+    void recordTurn(const GameEvent& event);
+
+    // enough history to say this opponent passes most turns of the phase
+    static bool habitualPasser(const OpponentProfile* profile, int phase);
+
+    // The history counters need every move in order; the event log includes
+    // our own, the observe callbacks don't
+    void observeOwnMove(const Card* card);
+
+    // Hand index of the card the search picks, or the heuristic's choice if it can't decide
+    int searchMove(const std::vector<Card>& hand, int heuristicIndex);
+
+    // Hand index of the book move for this hand and table, or -1 if the book doesn't know the situation
+    int bookMove(const std::vector<Card>& hand) const;
+
+    // Card with the best expected place over every deal of the unseen cards the
+    // history allows; false when there are too many cards left or the counts don't add up
+    bool tablebaseMove(const std::vector<Card>& hand, int& chosenIndex);
+
+    // determine the current game phase based on how many cards have been played
+    void updateGamePhase();
+
+    // evaluate the playability of each suit using table layout
+    void updateSuitPlayability(const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout);
+
+    // Flatten hand, table and observations into the evaluator's input
+    void buildContext(const std::vector<Card>& hand,
+                      const std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>& tableLayout);
+
+    // build a string to explain how a candidate's score was computed
+    std::string getEvaluationDetails(size_t candidate, const Card& card) const;
+
+    // Check if a card can be legally played given the current table layout
+    bool isPlayable(const Card& card) const;
+
+    // Profile store named by SEVENS_YURIA_PROFILES, shared by every instance in the process
+    static std::shared_ptr<OpponentProfileStore> loadProfiles();
+
+    // Tablebase named by SEVENS_YURIA_TABLEBASE, mapped once per process
+    static std::shared_ptr<const EndgameTablebase> loadTablebase();
+
+    // Opening book named by SEVENS_YURIA_BOOK, mapped once per process
+    static std::shared_ptr<const OpeningBook> loadBook();
+
+    // Weight file from SEVENS_YURIA_WEIGHTS if set, the hand-tuned defaults otherwise
+    static std::shared_ptr<const FeatureWeights> loadWeights();
+};
+
+} // namespace sevens
@@ -1,23 +1,254 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <filesystem>
 #include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <numeric>
 #include <string>
+#include <thread>
 
 // Include your framework files here...
 #include "MyGameMapper.hpp"
 #include "RandomStrategy.hpp"
 #include "GreedyStrategy.hpp"
 #include "StrategyLoader.hpp"
+#include "BatchRunner.hpp"
+#include "Sprt.hpp"
+#include "League.hpp"
+#include "Metrics.hpp"
+#include "GameEngine.hpp"
+#include "StrategyRegistry.hpp"
+#include "SelfPlay.hpp"
+#include "DealEnumerator.hpp"
+#include "ResultStats.hpp"
+#include "OpponentProfiles.hpp"
+#include "EndgameTablebase.hpp"
+#include "OpeningBook.hpp"
+#include "DistributedRunner.hpp"
+#include "LibraryReloader.hpp"
+#include "Tracing.hpp"
+#include "DealStrata.hpp"
 using namespace sevens;
 
+// Silences std::cout (engine and strategy chatter) while a batch of games runs
+struct QuietStdout {
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    ~QuietStdout() { std::cout.rdbuf(saved); }
+};
+
+// Builds one factory per library path; each call makes a fresh strategy instance
+// (a copy of one prototype when the library can clone, a new load otherwise).
+// "builtin:<name>" selects a strategy compiled into the executable instead.
+// With reloadMs > 0 every library is watched and reloaded between games when it changes.
+static bool loadFactories(char* paths[], int count,
+                          std::vector<StrategyFactory>& factories,
+                          std::vector<std::string>& names,
+                          long long reloadMs = 0)
+{
+    for (int i = 0; i < count; ++i) {
+        std::string path = paths[i];
+        if (path.rfind("builtin:", 0) == 0) {
+            std::string name = path.substr(8);
+            if (!makeBuiltinStrategy(name)) {
+                std::cerr << "Unknown built-in strategy: " << name << "\n";
+                return false;
+            }
+            names.push_back(name);
+            factories.push_back([name]() { return makeBuiltinStrategy(name); });
+            continue;
+        }
+        try {
+            if (!StrategyLoader::isValidLibrary(path)) {
+                std::cerr << "Invalid strategy library: " << path << "\n";
+                return false;
+            }
+            if (reloadMs > 0) {
+                names.push_back(StrategyLoader::loadFromLibrary(path)->getName());
+                auto reloader = std::make_shared<LibraryReloader>(path);
+                reloader->setReloadCallback([path](uint64_t version, const std::string& error) {
+                    if (error.empty()) {
+                        std::cerr << "[reload] " << path << ": version " << version << " loaded\n";
+                    } else {
+                        std::cerr << "[reload] " << path << ": kept version " << version << ", " << error << "\n";
+                    }
+                });
+                reloader->watch(std::chrono::milliseconds(reloadMs));
+                factories.push_back(LibraryReloader::factory(reloader));
+                continue;
+            }
+            StrategyFactory factory = StrategyLoader::prototypeFactory(path);
+            names.push_back(factory()->getName());
+            factories.push_back(std::move(factory));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error loading strategy from " << path << ":\n" << e.what() << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rank distribution, pass and deadlock rates and game lengths of a finished batch
+static void printGameStatistics(const ResultTotals& totals, const std::vector<std::string>& names) {
+    if (totals.games == 0) return;
+    const size_t seats = names.size();
+    std::cout << "\nGame statistics over " << totals.games << " games:\n"
+              << "pass rate " << totals.passRate() << ", deadlock rate " << totals.deadlockRate()
+              << ", game length p50/p90/p99 " << totals.lengthQuantile(0.5) << "/"
+              << totals.lengthQuantile(0.9) << "/" << totals.lengthQuantile(0.99) << " turns\n";
+    for (size_t s = 0; s < names.size(); ++s) {
+        const Welford& rank = totals.rank[s];
+        std::cout << names[s] << " (Player " << s << ") rank " << rank.mean
+                  << " sd " << std::sqrt(rank.variance()) << ", ranks";
+        for (uint64_t r = 1; r <= seats; ++r) {
+            uint64_t count = 0;
+            for (size_t seat = 0; seat < seats; ++seat) count += totals.rankCount(s, seat, r);
+            std::cout << " " << r << ":" << count;
+        }
+        std::cout << ", by seat";
+        for (size_t seat = 0; seat < seats; ++seat) {
+            std::cout << " " << totals.seatRank(s, seat).mean;
+        }
+        // Games per library version, once a reloaded library played more than one
+        if (totals.versionCount(s, 1) < totals.rank[s].count && totals.versionCount(s, 0) == 0) {
+            std::cout << ", games by version";
+            for (uint64_t v = 1; v < ResultTotals::kMaxVersions; ++v) {
+                if (totals.versionCount(s, v)) std::cout << " v" << v << ":" << totals.versionCount(s, v);
+            }
+        }
+        std::cout << "\n";
+    }
+}
+
+// Prints a one-line snapshot of a running batch to stderr every interval
+class LiveStatsPrinter {
+public:
+    LiveStatsPrinter(const ResultStats& stats, std::vector<std::string> names, std::chrono::milliseconds interval)
+        : stats(stats), names(std::move(names))
+    {
+        if (interval.count() <= 0) return;
+        thread = std::thread([this, interval]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!wakeUp.wait_for(lock, interval, [this]() { return stopping; })) {
+                const ResultTotals totals = this->stats.snapshot();
+                std::cerr << "[live] " << totals.games << " games";
+                for (size_t s = 0; s < this->names.size(); ++s) {
+                    std::cerr << ", " << this->names[s] << " " << totals.relativeScore[s].mean;
+                }
+                std::cerr << ", deadlocks " << totals.deadlockRate() << "\n";
+            }
+        });
+    }
+
+    ~LiveStatsPrinter() {
+        if (!thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        thread.join();
+    }
+
+private:
+    const ResultStats& stats;
+    std::vector<std::string> names;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread thread;
+};
+
 
 int main(int argc, char* argv[]) {
     // This is a minimal skeleton for demonstration purposes.
     // Students should integrate their classes or call the relevant
     // game logic from MyGameMapper (or other classes) as needed.
     
+    // Options of the form --name=value may appear anywhere, the rest is positional
+    std::string metricsPrefix;
+    long long metricsIntervalMs = 5000;
+    double displayRate = 30.0;
+    long long liveIntervalMs = 0;
+    long long reloadMs = 0;
+    SelfPlayConfig selfPlayConfig;
+    EnumerationConfig enumerationConfig;
+    ClusterConfig clusterConfig;
+    std::string journalPath;
+    uint64_t chunkDeals = 0;   // 0 = the mode's default
+    std::string tracePath;
+    size_t gamesInFlight = 1;
+    size_t strata = 0;
+    uint64_t timingSample = 0;   // 0 = BatchConfig's default
+    std::vector<char*> positional;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg.rfind("--metrics=", 0) == 0) {
+                metricsPrefix = arg.substr(10);
+            } else if (arg.rfind("--metrics-interval-ms=", 0) == 0) {
+                metricsIntervalMs = std::stoll(arg.substr(22));
+            } else if (arg.rfind("--live-ms=", 0) == 0) {
+                liveIntervalMs = std::stoll(arg.substr(10));
+            } else if (arg.rfind("--reload-ms=", 0) == 0) {
+                reloadMs = std::stoll(arg.substr(12));
+            } else if (arg.rfind("--fps=", 0) == 0) {
+                displayRate = std::stod(arg.substr(6));
+            } else if (arg.rfind("--players=", 0) == 0) {
+                selfPlayConfig.numPlayers = std::stoull(arg.substr(10));
+            } else if (arg.rfind("--chunk-rows=", 0) == 0) {
+                selfPlayConfig.chunkRows = std::stoull(arg.substr(13));
+            } else if (arg == "--compress") {
+                selfPlayConfig.compress = true;
+            } else if (arg.rfind("--chunk-deals=", 0) == 0) {
+                chunkDeals = std::stoull(arg.substr(14));
+            } else if (arg.rfind("--progress=", 0) == 0) {
+                enumerationConfig.progressPath = arg.substr(11);
+            } else if (arg.rfind("--games-in-flight=", 0) == 0) {
+                gamesInFlight = std::stoull(arg.substr(18));
+            } else if (arg.rfind("--timing-sample=", 0) == 0) {
+                timingSample = std::stoull(arg.substr(16));
+            } else if (arg.rfind("--strata=", 0) == 0) {
+                strata = std::stoull(arg.substr(9));
+            } else if (arg.rfind("--trace=", 0) == 0) {
+                tracePath = arg.substr(8);
+            } else if (arg.rfind("--journal=", 0) == 0) {
+                journalPath = arg.substr(10);
+            } else if (arg.rfind("--shard-deals=", 0) == 0) {
+                clusterConfig.shardDeals = std::stoull(arg.substr(14));
+            } else if (arg.rfind("--shard-timeout-s=", 0) == 0) {
+                clusterConfig.shardTimeoutSeconds = std::stod(arg.substr(18));
+            } else {
+                positional.push_back(argv[i]);
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid option: " << arg << "\n";
+            return 1;
+        }
+    }
+    argc = static_cast<int>(positional.size());
+    argv = positional.data();
+
     if (argc < 2) {
-        std::cout << "Usage: ./sevens_game [mode] [optional libs...]\n";
+        std::cout << "Usage: ./sevens_game [mode] [optional libs...]"
+                     " [--metrics=<file prefix>] [--metrics-interval-ms=5000] [--fps=30] [--live-ms=0] [--reload-ms=0]"
+                     " [--trace=<file.json>]\n";
         return 1;
     }
+
+    // Timeline of the whole mode, written when it returns
+    TraceSession trace(tracePath);
+
+    // Writes <prefix>.prom and <prefix>.json while the mode runs, and once at exit
+    std::unique_ptr<MetricsExporter> metricsExporter;
+    if (!metricsPrefix.empty()) {
+        metricsExporter = std::make_unique<MetricsExporter>(
+            metricsPrefix, std::chrono::milliseconds(std::max(100LL, metricsIntervalMs)));
+    }
     
     std::string mode = argv[1];
     
@@ -28,6 +259,7 @@ int main(int argc, char* argv[]) {
         //std::cout << "[main] Internal mode is not fully implemented.\n";
         
         MyGameMapper game;
+        game.set_display_rate(displayRate);
         game.read_cards("");  // Default card generation
         game.read_game("");    // Initialize table with 7s
 
@@ -52,6 +284,7 @@ int main(int argc, char* argv[]) {
         std::vector<std::string> playerNames = {"Alice", "Bob", "Charlie", "Dana"};
 
         MyGameMapper game;
+        game.set_display_rate(displayRate);
         game.read_cards("");
         game.read_game("");
 
@@ -76,6 +309,7 @@ int main(int argc, char* argv[]) {
         }
 
         MyGameMapper game;
+        game.set_display_rate(displayRate);
         game.read_cards("");
         game.read_game("");
 
@@ -113,6 +347,595 @@ int main(int argc, char* argv[]) {
                       << result.second << "\n";
         }
     }
+    // --------------------------
+    // Mode 4: duplicate
+    // --------------------------
+    else if (mode == "duplicate") {
+        if (argc < 5) {
+            std::cout << "Usage: ./sevens_game duplicate <deals> <strategy1.dll> <strategy2.dll> ... [--journal=<file>] [--chunk-deals=1000] [--reload-ms=0]"
+                         " [--games-in-flight=1] [--strata=0]\n"
+                         "With a journal, finished chunks of deals are recorded and skipped when the same run is restarted.\n"
+                         "With several games in flight, each worker plays that many deals at once and batches their decisions.\n"
+                         "With strata, deals are sampled by hand-strength spread and the result is the stratified estimate.\n";
+            return 1;
+        }
+
+        BatchConfig config;
+        config.journalPath = journalPath;
+        if (chunkDeals) config.chunkDeals = chunkDeals;
+        config.gamesInFlight = gamesInFlight;
+        try {
+            config.numDeals = std::stoull(argv[2]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid number of deals: " << argv[2] << "\n";
+            return 1;
+        }
+        if (strata > 0 && (!journalPath.empty() || gamesInFlight > 1)) {
+            std::cerr << "--strata cannot be combined with --journal or --games-in-flight\n";
+            return 1;
+        }
+
+        std::vector<StrategyFactory> factories;
+        std::vector<std::string> names;
+        if (!loadFactories(argv + 3, argc - 3, factories, names, reloadMs)) {
+            return 1;
+        }
+
+        BatchSummary summary;
+        StratifiedSummary stratified;
+        ResultStats stats(names.size());
+        config.stats = &stats;
+        try {
+            LiveStatsPrinter live(stats, names, std::chrono::milliseconds(liveIntervalMs));
+            QuietStdout quiet;
+            if (strata > 0) {
+                StratifiedConfig strataConfig;
+                strataConfig.strata = strata;
+                StratifiedBatch batch(factories, names, config, strataConfig);
+                stratified = batch.run();
+                summary = stratified.summary;
+            } else {
+                BatchRunner runner(factories, names, config);
+                summary = runner.run();
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Duplicate match failed: " << e.what() << "\n";
+            return 1;
+        }
+
+        std::cout << std::fixed << std::setprecision(3);
+        if (strata > 0) {
+            std::cout << "\nStrata (" << stratified.dealsClassified << " deals classified):\n";
+            for (size_t h = 0; h < stratified.strata.size(); ++h) {
+                const StratumSummary& stratum = stratified.strata[h];
+                std::cout << "Stratum " << h << ": spread " << stratum.lowSpread << ".." << stratum.highSpread
+                          << ", share " << stratum.weight << ", " << stratum.deals << " deals";
+                for (size_t s = 0; s < summary.names.size(); ++s) {
+                    std::cout << (s == 0 ? ", relative " : " / ") << stratum.meanRelativeScore[s]
+                              << " (sd " << stratum.stdDeviation[s] << ")";
+                }
+                std::cout << "\n";
+            }
+            std::cout << "\nStratified duplicate results over " << summary.deals << " deals ("
+                      << summary.games << " games):\n";
+        } else {
+            std::cout << "\nDuplicate results over " << summary.deals << " deals ("
+                      << summary.games << " games):\n";
+        }
+        for (size_t s = 0; s < summary.names.size(); ++s) {
+            std::cout << summary.names[s] << " (Player " << s << ")"
+                      << " mean rank " << summary.meanRank[s]
+                      << ", relative " << summary.meanRelativeScore[s]
+                      << " +/- " << summary.stdError[s] << "\n";
+        }
+        printGameStatistics(stats.snapshot(), summary.names);
+    }
+    // --------------------------
+    // Mode 5: sprt
+    // --------------------------
+    else if (mode == "sprt") {
+        if (argc < 4) {
+            std::cout << "Usage: ./sevens_game sprt <candidate.dll> <baseline.dll>"
+                         " [elo0=0] [elo1=20] [alpha=0.05] [beta=0.05] [maxDeals=100000] [minDeals=100]\n"
+                         "The test only stops once minDeals deals have been played.\n";
+            return 1;
+        }
+
+        double elo0 = 0.0, elo1 = 20.0, alpha = 0.05, beta = 0.05;
+        uint64_t minDeals = Sprt::kDefaultMinSamples;
+        BatchConfig config;
+        config.numDeals = 100000;
+        try {
+            if (argc > 4) elo0 = std::stod(argv[4]);
+            if (argc > 5) elo1 = std::stod(argv[5]);
+            if (argc > 6) alpha = std::stod(argv[6]);
+            if (argc > 7) beta = std::stod(argv[7]);
+            if (argc > 8) config.numDeals = std::stoull(argv[8]);
+            if (argc > 9) minDeals = std::stoull(argv[9]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid SPRT parameter\n";
+            return 1;
+        }
+
+        std::vector<StrategyFactory> factories;
+        std::vector<std::string> names;
+        if (!loadFactories(argv + 2, 2, factories, names, reloadMs)) {
+            return 1;
+        }
+
+        try {
+            // Each deal is played in duplicate: the candidate's head-to-head score
+            // over both seatings is one SPRT sample
+            Sprt sprt(elo0, elo1, alpha, beta, minDeals);
+            BatchRunner runner(factories, names, config);
+            runner.setDealCallback([&sprt](const DealResult& result) {
+                sprt.addSample(result.headToHead);
+                return sprt.decision() == Sprt::Decision::Continue;
+            });
+
+            BatchSummary summary;
+            {
+                QuietStdout quiet;
+                summary = runner.run();
+            }
+
+            std::cout << std::fixed << std::setprecision(3);
+            std::cout << "\nSPRT " << names[0] << " vs " << names[1]
+                      << " (elo0=" << elo0 << ", elo1=" << elo1
+                      << ", alpha=" << alpha << ", beta=" << beta << ")\n";
+            std::cout << "Deals: " << sprt.samples() << " (" << summary.games << " games)\n";
+            std::cout << "LLR: " << sprt.llr() << " [" << sprt.lowerBound() << ", " << sprt.upperBound() << "]\n";
+            std::cout << "Score: " << sprt.meanScore() << " (Elo " << sprt.eloEstimate() << ")\n";
+            switch (sprt.decision()) {
+                case Sprt::Decision::AcceptH1: std::cout << "Result: H1 accepted (" << names[0] << " is stronger)\n"; break;
+                case Sprt::Decision::AcceptH0: std::cout << "Result: H0 accepted (no improvement)\n"; break;
+                default: std::cout << "Result: inconclusive after the deal limit\n"; break;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "SPRT failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 6: league
+    // --------------------------
+    else if (mode == "league") {
+        if (argc < 3) {
+            std::cout << "Usage: ./sevens_game league <strategy directory> [tables=1000] [tableSize=4]\n";
+            return 1;
+        }
+
+        LeagueConfig config;
+        try {
+            if (argc > 3) config.numTables = std::stoull(argv[3]);
+            if (argc > 4) config.tableSize = std::stoull(argv[4]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid league parameter\n";
+            return 1;
+        }
+
+        // Every valid strategy library in the directory joins the pool
+        std::vector<std::string> paths;
+        try {
+            for (const auto& entry : std::filesystem::directory_iterator(argv[2])) {
+                if (!entry.is_regular_file()) continue;
+                std::string extension = entry.path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                if (extension == ".dll" && StrategyLoader::isValidLibrary(entry.path().string())) {
+                    paths.push_back(entry.path().string());
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cannot read strategy directory " << argv[2] << ": " << e.what() << "\n";
+            return 1;
+        }
+        std::sort(paths.begin(), paths.end());
+
+        std::vector<char*> pathArgs;
+        for (auto& path : paths) pathArgs.push_back(&path[0]);
+        std::vector<StrategyFactory> factories;
+        std::vector<std::string> names;
+        if (!loadFactories(pathArgs.data(), static_cast<int>(pathArgs.size()), factories, names, reloadMs)) {
+            return 1;
+        }
+        // Several builds of the same strategy share a name: tell them apart by file
+        for (size_t i = 0; i < names.size(); ++i) {
+            names[i] = std::filesystem::path(paths[i]).filename().string() + " (" + names[i] + ")";
+        }
+
+        try {
+            League league(factories, names, config);
+            std::vector<LeagueStanding> standings;
+            {
+                QuietStdout quiet;
+                standings = league.run();
+            }
+
+            std::cout << "\nLeague standings (" << config.numTables << " tables, 95% interval):\n";
+            std::cout << std::fixed << std::setprecision(2);
+            for (size_t i = 0; i < standings.size(); ++i) {
+                const Rating& r = standings[i].rating;
+                std::cout << i + 1 << ". " << standings[i].name
+                          << "  mu " << r.mu
+                          << "  [" << r.mu - 1.96 * r.sigma << ", " << r.mu + 1.96 * r.sigma << "]"
+                          << "  tables " << standings[i].tables << "\n";
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "League failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 7: builtin
+    // --------------------------
+    else if (mode == "builtin") {
+        if (argc < 4) {
+            std::cout << "Usage: ./sevens_game builtin <deals> <strategy name> <strategy name> ... [--timing-sample=64]\n"
+                         "Built-in strategies: RandomStrategy, GreedyStrategy, YuriaStrategy\n"
+                         "Strategy time is measured on one decision in timing-sample (1 = every decision).\n";
+            return 1;
+        }
+
+        BatchConfig config;
+        if (timingSample) config.timingSample = timingSample;
+        try {
+            config.numDeals = std::stoull(argv[2]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid number of deals: " << argv[2] << "\n";
+            return 1;
+        }
+        std::vector<std::string> names(argv + 3, argv + argc);
+
+        BatchSummary summary;
+        ResultStats stats(names.size());
+        config.stats = &stats;
+        try {
+            LiveStatsPrinter live(stats, names, std::chrono::milliseconds(liveIntervalMs));
+            QuietStdout quiet;
+            summary = runBuiltinBatch(names, config);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Built-in match failed: " << e.what() << "\n";
+            return 1;
+        }
+
+        std::cout << "\nBuilt-in duplicate results over " << summary.deals << " deals ("
+                  << summary.games << " games):\n";
+        std::cout << std::fixed << std::setprecision(3);
+        for (size_t s = 0; s < summary.names.size(); ++s) {
+            std::cout << summary.names[s] << " (Player " << s << ")"
+                      << " mean rank " << summary.meanRank[s]
+                      << ", relative " << summary.meanRelativeScore[s]
+                      << " +/- " << summary.stdError[s] << "\n";
+        }
+        printGameStatistics(stats.snapshot(), summary.names);
+    }
+    // --------------------------
+    // Mode 8: selfplay
+    // --------------------------
+    else if (mode == "selfplay") {
+        if (argc < 5) {
+            std::cout << "Usage: ./sevens_game selfplay <games> <output file> <strategy1.dll> ..."
+                         " [--players=4] [--chunk-rows=65536] [--compress]\n";
+            return 1;
+        }
+
+        try {
+            selfPlayConfig.numGames = std::stoull(argv[2]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid number of games: " << argv[2] << "\n";
+            return 1;
+        }
+
+        std::vector<StrategyFactory> factories;
+        std::vector<std::string> names;
+        if (!loadFactories(argv + 4, argc - 4, factories, names)) {
+            return 1;
+        }
+
+        try {
+            SelfPlay selfPlay(factories, names, selfPlayConfig);
+            auto start = std::chrono::steady_clock::now();
+            SelfPlayStats stats;
+            {
+                QuietStdout quiet;
+                stats = selfPlay.run(argv[3]);
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            // Read the file back through the mapping as a check, and report per strategy
+            TrainingDataReader reader(argv[3]);
+            const size_t strategyColumn = reader.columnIndex("strategy");
+            const size_t rankColumn = reader.columnIndex("rank");
+            std::vector<uint64_t> decisions(names.size(), 0);
+            std::vector<double> rankSum(names.size(), 0.0);
+            std::vector<uint8_t> strategyScratch, rankScratch;
+            for (size_t chunk = 0; chunk < reader.chunks(); ++chunk) {
+                const uint8_t* strategy = reader.column<uint8_t>(chunk, strategyColumn, strategyScratch);
+                const uint8_t* rank = reader.column<uint8_t>(chunk, rankColumn, rankScratch);
+                for (uint64_t row = 0; row < reader.rows(chunk); ++row) {
+                    decisions[strategy[row]]++;
+                    rankSum[strategy[row]] += rank[row];
+                }
+            }
+
+            std::cout << "\nSelf-play wrote " << stats.rows << " decisions from " << stats.games
+                      << " games to " << argv[3] << " (" << reader.chunks() << " chunks, "
+                      << stats.bytes << " bytes";
+            std::cout << std::fixed << std::setprecision(2);
+            std::cout << ", " << static_cast<double>(stats.bytes) / std::max<uint64_t>(1, stats.rows)
+                      << " bytes/row) in " << elapsed << " s\n";
+            for (size_t s = 0; s < names.size(); ++s) {
+                std::cout << names[s] << ": " << decisions[s] << " decisions, mean rank of the mover "
+                          << (decisions[s] ? rankSum[s] / static_cast<double>(decisions[s]) : 0.0) << "\n";
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Self-play failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 9: enumerate
+    // --------------------------
+    else if (mode == "enumerate") {
+        if (argc < 6) {
+            std::cout << "Usage: ./sevens_game enumerate <suits> <ranks each side of 7> <strategy1.dll> <strategy2.dll> ..."
+                         " [--chunk-deals=100000] [--progress=<file>]\n"
+                         "One strategy per player (2 to 4).\n";
+            return 1;
+        }
+
+        try {
+            enumerationConfig.variant.numSuits = std::stoull(argv[2]);
+            enumerationConfig.variant.ranksPerSide = std::stoull(argv[3]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid variant\n";
+            return 1;
+        }
+        enumerationConfig.variant.numPlayers = static_cast<uint64_t>(argc - 4);
+        if (chunkDeals) enumerationConfig.chunkSize = chunkDeals;
+
+        std::vector<StrategyFactory> factories;
+        std::vector<std::string> names;
+        if (!loadFactories(argv + 4, argc - 4, factories, names)) {
+            return 1;
+        }
+
+        try {
+            DealEnumerator enumerator(factories, names, enumerationConfig);
+            EnumerationResult result;
+            {
+                QuietStdout quiet;
+                result = enumerator.run();
+            }
+
+            std::cout << "\nEnumerated " << result.coveredDeals << " of " << result.totalDeals << " deals ("
+                      << result.playedDeals << " up to suit symmetry, " << result.games << " games";
+            if (result.chunksResumed > 0) std::cout << ", " << result.chunksResumed << " chunks resumed";
+            std::cout << ")\n";
+            std::cout << std::fixed << std::setprecision(6);
+            for (size_t s = 0; s < result.names.size(); ++s) {
+                std::cout << result.names[s] << " (Player " << s << ") expected rank "
+                          << result.expectedRank[s] << "\n";
+            }
+            if (!result.complete) {
+                std::cout << "Incomplete: run again with the same --progress file to finish.\n";
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Enumeration failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 10: profiles
+    // --------------------------
+    else if (mode == "profiles") {
+        if (argc < 3) {
+            std::cout << "Usage: ./sevens_game profiles <profile file>\n"
+                         "Shows the opponent profiles YuriaStrategy keeps in SEVENS_YURIA_PROFILES\n";
+            return 1;
+        }
+        if (!std::filesystem::exists(argv[2])) {
+            std::cerr << "No profile store at " << argv[2] << "\n";
+            return 1;
+        }
+        try {
+            OpponentProfileStore store(argv[2]);
+            std::cout << std::fixed << std::setprecision(3);
+            for (const OpponentProfile* profile : store.profiles()) {
+                std::cout << profile->name << ": " << profile->count(profile->games) << " games, pass rate";
+                for (int phase = 0; phase < 3; ++phase) {
+                    std::cout << " " << profile->passRate(phase);
+                }
+                std::cout << " (early/mid/late), passes with suit open";
+                for (int suit = 0; suit < 4; ++suit) {
+                    std::cout << " " << profile->count(profile->passesWithSuitOpen[suit]);
+                }
+
+                // Cards most often played in the early phase
+                std::vector<int> cards(52);
+                std::iota(cards.begin(), cards.end(), 0);
+                std::stable_sort(cards.begin(), cards.end(), [profile](int a, int b) {
+                    return profile->count(profile->earlyPlays[a]) > profile->count(profile->earlyPlays[b]);
+                });
+                std::cout << ", early favourites";
+                for (int i = 0; i < 3 && profile->count(profile->earlyPlays[cards[i]]) > 0; ++i) {
+                    std::cout << " " << Card{cards[i] / 13, cards[i] % 13 + 1};
+                }
+                std::cout << "\n";
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cannot read profiles: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 11: tablebase
+    // --------------------------
+    else if (mode == "tablebase") {
+        if (argc < 3) {
+            std::cout << "Usage: ./sevens_game tablebase <output file> [players=4] [cards left=5]\n"
+                         "Solves every endgame with at most that many cards in all hands, for SEVENS_YURIA_TABLEBASE\n";
+            return 1;
+        }
+        TablebaseConfig tablebaseConfig;
+        try {
+            if (argc > 3) tablebaseConfig.numPlayers = std::stoull(argv[3]);
+            if (argc > 4) tablebaseConfig.maxCards = std::stoull(argv[4]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid player or card count\n";
+            return 1;
+        }
+
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            const TablebaseStats stats = EndgameTablebase::generate(argv[2], tablebaseConfig);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "Solved " << stats.entries << " positions over " << stats.configurations
+                      << " table layouts in " << std::fixed << std::setprecision(2) << seconds << " s; "
+                      << argv[2] << " is " << stats.bytes << " bytes\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Tablebase generation failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 12: book
+    // --------------------------
+    else if (mode == "book") {
+        if (argc < 3) {
+            std::cout << "Usage: ./sevens_game book <output file> [games=20000] [players=4] [playouts per move=8]\n"
+                         "Builds the opening book YuriaStrategy reads from SEVENS_YURIA_BOOK\n";
+            return 1;
+        }
+        BookConfig bookConfig;
+        try {
+            if (argc > 3) bookConfig.games = std::stoull(argv[3]);
+            if (argc > 4) bookConfig.numPlayers = std::stoull(argv[4]);
+            if (argc > 5) bookConfig.rollouts = std::stoull(argv[5]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid game, player or playout count\n";
+            return 1;
+        }
+
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            const BookStats stats = OpeningBook::build(argv[2], bookConfig);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "Sampled " << stats.situations << " early-game situations with " << stats.playouts
+                      << " playouts in " << std::fixed << std::setprecision(2) << seconds << " s; "
+                      << stats.entries << " kept in " << argv[2] << " (" << stats.bytes << " bytes)\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Opening book build failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // --------------------------
+    // Mode 13: coordinator / worker
+    // --------------------------
+    else if (mode == "coordinator") {
+        if (argc < 6) {
+            std::cout << "Usage: ./sevens_game coordinator <tcp:host:port | unix:path> <deals> <strategy1.dll> <strategy2.dll> ..."
+                         " [--shard-deals=1000] [--shard-timeout-s=60] [--journal=<file>]\n"
+                         "Serves a duplicate match to workers started with: ./sevens_game worker <address> [threads]\n";
+            return 1;
+        }
+        clusterConfig.address = argv[2];
+        clusterConfig.journalPath = journalPath;
+        try {
+            clusterConfig.numDeals = std::stoull(argv[3]);
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid number of deals: " << argv[3] << "\n";
+            return 1;
+        }
+
+        // Checked here so a bad path fails before any worker connects
+        std::vector<StrategyFactory> factories;
+        std::vector<std::string> names;
+        if (!loadFactories(argv + 4, argc - 4, factories, names)) {
+            return 1;
+        }
+
+        BatchSummary summary;
+        try {
+            TournamentCoordinator coordinator(std::vector<std::string>(argv + 4, argv + argc), names, clusterConfig);
+            coordinator.setProgressCallback([](uint64_t done, uint64_t total) {
+                std::cerr << "[coordinator] " << done << "/" << total << " deals\n";
+            });
+            summary = coordinator.run();
+            const ClusterStats& stats = coordinator.stats();
+            std::cout << "\n" << stats.workers << " workers, " << stats.lostWorkers << " lost, "
+                      << stats.reassigned << " shards reassigned\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Coordinator failed: " << e.what() << "\n";
+            return 1;
+        }
+
+        std::cout << "Distributed duplicate results over " << summary.deals << " deals ("
+                  << summary.games << " games):\n";
+        std::cout << std::fixed << std::setprecision(3);
+        for (size_t s = 0; s < summary.names.size(); ++s) {
+            std::cout << summary.names[s] << " (Player " << s << ")"
+                      << " mean rank " << summary.meanRank[s]
+                      << ", relative " << summary.meanRelativeScore[s]
+                      << " +/- " << summary.stdError[s] << "\n";
+        }
+    }
+    else if (mode == "worker") {
+        if (argc < 3) {
+            std::cout << "Usage: ./sevens_game worker <tcp:host:port | unix:path> [threads=all]\n";
+            return 1;
+        }
+        unsigned threads = 0;
+        try {
+            if (argc > 3) threads = static_cast<unsigned>(std::stoul(argv[3]));
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid thread count: " << argv[3] << "\n";
+            return 1;
+        }
+
+        auto loader = [](const std::vector<std::string>& specs, std::vector<StrategyFactory>& factories,
+                         std::vector<std::string>& names) {
+            std::vector<std::string> copies(specs);
+            std::vector<char*> paths;
+            for (auto& spec : copies) paths.push_back(&spec[0]);
+            return loadFactories(paths.data(), static_cast<int>(paths.size()), factories, names);
+        };
+        try {
+            TournamentWorker worker(argv[2], loader, threads);
+            uint64_t played = 0;
+            {
+                QuietStdout quiet;
+                played = worker.run();
+            }
+            std::cout << "Worker played " << played << " deals\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Worker failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
     // ---------------------
     // Unknown mode
     // ---------------------
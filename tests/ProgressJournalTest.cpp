@@ -0,0 +1,129 @@
+// Checks that journals written before library versions were counted still resume
+#include "ProgressJournal.hpp"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+using namespace sevens;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+uint32_t crc32(const std::string& bytes) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char b : bytes) {
+        crc ^= b;
+        for (int k = 0; k < 8; ++k) crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+void putWelford(std::string& out, uint64_t count, double mean) {
+    uint64_t bits = 0;
+    putU64(out, count);
+    std::memcpy(&bits, &mean, sizeof(bits));
+    putU64(out, bits);
+    putU64(out, 0);   // m2 of 0.0
+}
+
+std::string frame(const std::string& payload) {
+    std::string record;
+    putU32(record, static_cast<uint32_t>(payload.size()));
+    putU32(record, crc32(payload));
+    return record + payload;
+}
+
+// One range record in the layout used before library versions were counted
+std::string oldRange(uint64_t first, uint64_t end, size_t numStrategies) {
+    std::string payload(1, '\2');
+    putU64(payload, first);
+    putU64(payload, end);
+    putU64(payload, end - first);        // deals
+    putU64(payload, 2 * (end - first));  // games
+    for (size_t s = 0; s < numStrategies; ++s) {
+        putWelford(payload, end - first, 1.5);
+        putWelford(payload, end - first, 0.0);
+    }
+    putU64(payload, 2 * (end - first));  // games
+    putU64(payload, 100);                // turns
+    putU64(payload, 10);                 // passes
+    putU64(payload, 0);                  // deadlocked
+    putU64(payload, 1);                  // rank counts: one non-zero entry
+    putU64(payload, 0);
+    putU64(payload, end - first);
+    putU64(payload, 1);                  // length counts: one non-zero entry
+    putU64(payload, 50);
+    putU64(payload, 2 * (end - first));
+    for (size_t s = 0; s < numStrategies; ++s) {
+        putWelford(payload, 2 * (end - first), 1.5);
+        putWelford(payload, end - first, 0.0);
+    }
+    return frame(payload);
+}
+
+} // namespace
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "ProgressJournalTest.journal").string();
+    const std::string identity = ProgressJournal::batchIdentity({"A", "B"}, 7, 100, 10, false);
+    std::filesystem::remove(path);
+
+    // A journal in the old format, written byte by byte
+    {
+        std::string bytes = "SVNJRNL1";
+        bytes += frame(std::string(1, '\1') + identity);
+        bytes += oldRange(0, 10, 2);
+        bytes += oldRange(10, 20, 2);
+        std::FILE* out = std::fopen(path.c_str(), "wb");
+        std::fwrite(bytes.data(), 1, bytes.size(), out);
+        std::fclose(out);
+    }
+    {
+        ProgressJournal journal(path, identity, 2);
+        check(journal.discardedBytes() == 0, "an old journal is not cut");
+        check(journal.completedRanges().size() == 2, "both old ranges are read");
+        check(journal.completedDeals().deals == 20, "old deal totals are merged");
+        check(journal.completedStatistics().turns == 200, "old game statistics are merged");
+        check(journal.completedStatistics().lengthCounts[50] == 40, "old length counts are read");
+        check(journal.completedStatistics().versionCount(0, 0) == 0, "old ranges have no version counts");
+
+        // New ranges follow the old ones in the same file
+        DealTotals deals(2);
+        deals.deals = 10;
+        ResultTotals statistics(2);
+        statistics.turns = 30;
+        statistics.versionCounts[1 * ResultTotals::kMaxVersions + 3] = 20;
+        journal.append(20, 30, deals, statistics);
+    }
+    {
+        ProgressJournal journal(path, identity, 2);
+        check(journal.discardedBytes() == 0, "a journal mixing both formats is not cut");
+        check(journal.completedRanges().size() == 3, "old and new ranges are read");
+        check(journal.completedDeals().deals == 30, "deal totals of both formats are merged");
+        check(journal.completedStatistics().turns == 230, "statistics of both formats are merged");
+        check(journal.completedStatistics().versionCount(1, 3) == 20, "version counts survive a reopen");
+    }
+    std::filesystem::remove(path);
+
+    if (failures == 0) std::cout << "ProgressJournalTest passed\n";
+    return failures == 0 ? 0 : 1;
+}
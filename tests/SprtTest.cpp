@@ -0,0 +1,52 @@
+// Checks that a run of identical early results does not end an SPRT
+#include "Sprt.hpp"
+#include <iostream>
+
+using namespace sevens;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    // Two equal scores used to give an LLR in the tens of thousands
+    for (double score : {0.0, 0.5, 1.0}) {
+        Sprt sprt(0.0, 20.0, 0.05, 0.05);
+        sprt.addSample(score);
+        sprt.addSample(score);
+        check(sprt.llr() > sprt.lowerBound() && sprt.llr() < sprt.upperBound(),
+              "two equal scores keep the LLR inside the bounds");
+        check(sprt.decision() == Sprt::Decision::Continue, "two equal scores do not decide");
+    }
+
+    // No decision before the minimum, whatever the results
+    for (double score : {0.0, 1.0}) {
+        Sprt sprt(0.0, 20.0, 0.05, 0.05, 50);
+        for (int i = 0; i < 49; ++i) sprt.addSample(score);
+        check(sprt.decision() == Sprt::Decision::Continue, "identical results before the minimum do not decide");
+    }
+
+    // A clear result still decides once the minimum is reached
+    {
+        Sprt sprt(0.0, 20.0, 0.05, 0.05, 50);
+        for (int i = 0; i < 50; ++i) sprt.addSample(1.0);
+        check(sprt.decision() == Sprt::Decision::AcceptH1, "a candidate that always wins accepts H1");
+    }
+    {
+        Sprt sprt(0.0, 20.0, 0.05, 0.05, 50);
+        for (int i = 0; i < 50; ++i) sprt.addSample(0.0);
+        check(sprt.decision() == Sprt::Decision::AcceptH0, "a candidate that always loses accepts H0");
+    }
+
+    if (failures == 0) std::cout << "SprtTest passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Checks that YuriaStrategy ends a game in the same state whether it reads the
+// engine's event log or gets the observe callbacks
+#include "YuriaStrategy.hpp"
+#include "Deck.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sevens;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+using TableLayout = std::unordered_map<uint64_t, std::unordered_map<uint64_t, bool>>;
+
+constexpr size_t kPlayers = 4;
+constexpr uint64_t kYuriaSeat = 1;
+
+bool playable(const TableLayout& table, const Card& card) {
+    const auto& ranks = table.at(card.suit);
+    if (ranks.at(card.rank)) return false;
+    return (card.rank > 1 && ranks.at(card.rank - 1)) || (card.rank < 13 && ranks.at(card.rank + 1));
+}
+
+// What the strategy prints while deciding: the phase, the suit features and
+// the score of every candidate, all of which come from the history counters
+std::string decide(YuriaStrategy& strategy, const std::vector<Card>& hand, const TableLayout& table, int& choice) {
+    std::ostringstream captured;
+    std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+    choice = strategy.selectCardToPlay(hand, table);
+    std::cout.rdbuf(previous);
+    return captured.str();
+}
+
+// Plays one deal with Yuria on one seat and the others playing their first
+// playable card; returns the longest run of consecutive Yuria passes
+int playDeal(uint64_t seed) {
+    YuriaStrategy logged;
+    YuriaStrategy called;
+    GameEventLog log;
+    logged.attachEventLog(&log);
+    std::ostringstream ignored;
+    std::streambuf* previous = std::cout.rdbuf(ignored.rdbuf());
+    logged.initialize(kYuriaSeat);
+    called.initialize(kYuriaSeat);
+    std::cout.rdbuf(previous);
+
+    std::vector<Card> hands[kPlayers];
+    dealCards(Deck::shuffled(seed), kPlayers, hands);
+    TableLayout table;
+    for (int suit = 0; suit < 4; ++suit) {
+        for (int rank = 1; rank <= 13; ++rank) table[suit][rank] = rank == 7;
+    }
+
+    int passRun = 0;
+    int longestPassRun = 0;
+    size_t passesInARow = 0;
+    for (uint64_t seat = 0; passesInARow < kPlayers; seat = (seat + 1) % kPlayers) {
+        int choice = -1;
+        if (seat == kYuriaSeat) {
+            int calledChoice = -1;
+            const std::string loggedTrace = decide(logged, hands[seat], table, choice);
+            const std::string calledTrace = decide(called, hands[seat], table, calledChoice);
+            check(loggedTrace == calledTrace, "both paths see the same history before each decision");
+            check(choice == calledChoice, "both paths choose the same card");
+        } else {
+            for (size_t i = 0; i < hands[seat].size() && choice < 0; ++i) {
+                if (playable(table, hands[seat][i])) choice = static_cast<int>(i);
+            }
+        }
+
+        const GameEvent event = choice < 0 ? GameEvent{seat, Card{0, 0}, true}
+                                           : GameEvent{seat, hands[seat][choice], false};
+        log.append(event);
+        if (seat != kYuriaSeat) {
+            std::cout.rdbuf(ignored.rdbuf());
+            if (event.pass) called.observePass(seat);
+            else called.observeMove(seat, event.card);
+            std::cout.rdbuf(previous);
+        }
+
+        if (event.pass) {
+            ++passesInARow;
+            if (seat == kYuriaSeat && ++passRun > longestPassRun) longestPassRun = passRun;
+            continue;
+        }
+        if (seat == kYuriaSeat) passRun = 0;
+        passesInARow = 0;
+        table[event.card.suit][event.card.rank] = true;
+        hands[seat].erase(hands[seat].begin() + choice);
+        if (hands[seat].empty()) break;
+    }
+
+    // One more decision over every card still out, after the whole game
+    std::vector<Card> remaining;
+    for (const auto& hand : hands) remaining.insert(remaining.end(), hand.begin(), hand.end());
+    int loggedChoice = -1;
+    int calledChoice = -1;
+    check(decide(logged, remaining, table, loggedChoice) == decide(called, remaining, table, calledChoice),
+          "both paths end the game in the same state");
+    return longestPassRun;
+}
+
+} // namespace
+
+int main() {
+    int longestPassRun = 0;
+    for (uint64_t seed = 1; seed <= 20; ++seed) {
+        const int run = playDeal(seed);
+        if (run > longestPassRun) longestPassRun = run;
+    }
+    // Three passes in a row is what used to make Yuria think an opponent was blocked
+    check(longestPassRun >= 3, "some deal has Yuria pass three times in a row");
+
+    if (failures == 0) std::cout << "YuriaEventPathsTest passed\n";
+    return failures == 0 ? 0 : 1;
+}